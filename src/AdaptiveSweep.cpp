@@ -0,0 +1,255 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "AdaptiveSweep.hpp"
+
+#include <QString>
+
+#include <algorithm>
+#include <cmath>
+
+namespace contamutils {
+
+// Zones with less than this fraction of the largest zone's flow are judged
+// against that fraction instead, so that sheltered zones with next to no
+// infiltration don't drive the refinement
+static const double SCALE_FLOOR = 1.0e-3;
+
+// Sort a row's cases by direction
+struct DirectionOrder
+{
+  explicit DirectionOrder(const std::vector<SweepCase> &cases) : cases(cases)
+  {}
+  bool operator()(unsigned a, unsigned b) const
+  {
+    return cases[a].direction < cases[b].direction;
+  }
+  const std::vector<SweepCase> &cases;
+};
+
+// What counts as a big difference for each zone of a row
+static std::vector<double> zoneScales(const std::vector<double> &average)
+{
+  double largest = 0.0;
+  for(unsigned z=0;z<average.size();z++)
+  {
+    largest = std::max(largest,std::fabs(average[z]));
+  }
+  std::vector<double> scale(average.size());
+  for(unsigned z=0;z<average.size();z++)
+  {
+    scale[z] = std::max(std::fabs(average[z]),SCALE_FLOOR*largest);
+  }
+  return scale;
+}
+
+static bool similar(const std::vector<double> &a, const std::vector<double> &b, const std::vector<double> &scale,
+  double tolerance)
+{
+  for(unsigned z=0;z<scale.size();z++)
+  {
+    if(std::fabs(a[z]-b[z]) > tolerance*scale[z])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+AdaptiveSweep::AdaptiveSweep(WindSweep &sweep) : m_sweep(sweep), m_initial(4), m_tolerance(0.02),
+  m_scratch(openstudio::toPath("sweep")), m_nzones(0), m_simulated(0)
+{
+}
+
+void AdaptiveSweep::setInitialDirections(int count)
+{
+  m_initial = count;
+}
+
+void AdaptiveSweep::setTolerance(double tolerance)
+{
+  m_tolerance = tolerance;
+}
+
+void AdaptiveSweep::setScratchDirectory(const openstudio::path &dir)
+{
+  m_scratch = dir;
+}
+
+unsigned AdaptiveSweep::simulatedCases() const
+{
+  return m_simulated;
+}
+
+std::string AdaptiveSweep::errorMessage() const
+{
+  return m_error;
+}
+
+std::vector<double> AdaptiveSweep::estimate(const std::vector<unsigned> &row) const
+{
+  std::vector<double> average(m_nzones,0.0);
+  std::vector<unsigned> sampled;
+  for(unsigned i=0;i<row.size();i++)
+  {
+    if(m_sampled[row[i]])
+    {
+      sampled.push_back(i);
+    }
+  }
+  if(sampled.empty())
+  {
+    return average;
+  }
+  // Walk around the circle, interpolating each case from the sampled ones on either side
+  unsigned next = 0;
+  for(unsigned i=0;i<row.size();i++)
+  {
+    while(next < sampled.size() && sampled[next] < i)
+    {
+      next++;
+    }
+    const SweepCase &sweepCase = m_cases[row[i]];
+    if(next < sampled.size() && sampled[next] == i)
+    {
+      for(unsigned z=0;z<m_nzones;z++)
+      {
+        average[z] += sweepCase.weight*m_values[row[i]][z];
+      }
+      continue;
+    }
+    unsigned before = row[sampled[(next+sampled.size()-1) % sampled.size()]];
+    unsigned after = row[sampled[next % sampled.size()]];
+    double span = std::fmod(m_cases[after].direction - m_cases[before].direction + 360.0,360.0);
+    double t = span > 0.0 ? std::fmod(sweepCase.direction - m_cases[before].direction + 360.0,360.0)/span : 0.0;
+    for(unsigned z=0;z<m_nzones;z++)
+    {
+      average[z] += sweepCase.weight*((1.0-t)*m_values[before][z] + t*m_values[after][z]);
+    }
+  }
+  return average;
+}
+
+bool AdaptiveSweep::run(const std::vector<SweepCase> &cases, unsigned nzones, std::vector<std::vector<double> > &results)
+{
+  m_cases = cases;
+  m_values = std::vector<std::vector<double> >(cases.size());
+  m_sampled = std::vector<bool>(cases.size(),false);
+  m_nzones = nzones;
+  m_simulated = 0;
+  m_error.clear();
+
+  // The cases of each row in order around the circle
+  std::vector<std::vector<unsigned> > rows;
+  for(unsigned i=0;i<cases.size();i++)
+  {
+    if(cases[i].row >= (int)rows.size())
+    {
+      rows.resize(cases[i].row+1);
+    }
+    rows[cases[i].row].push_back(i);
+  }
+  std::vector<unsigned> pending;
+  for(unsigned r=0;r<rows.size();r++)
+  {
+    std::sort(rows[r].begin(),rows[r].end(),DirectionOrder(m_cases));
+    unsigned n = rows[r].size();
+    unsigned count = std::min(n,(unsigned)std::max(m_initial,1));
+    for(unsigned k=0;k<count;k++)
+    {
+      pending.push_back(rows[r][k*n/count]);
+    }
+  }
+
+  std::vector<std::vector<double> > averages(rows.size());
+  std::vector<bool> done(rows.size(),false);
+  for(int pass=0;!pending.empty();pass++)
+  {
+    // Run the pass with one results row per case
+    std::vector<SweepCase> batch;
+    for(unsigned i=0;i<pending.size();i++)
+    {
+      SweepCase sweepCase = m_cases[pending[i]];
+      sweepCase.row = i;
+      sweepCase.weight = 1.0;
+      batch.push_back(sweepCase);
+    }
+    m_sweep.setScratchDirectory(m_scratch / openstudio::toPath(QString("pass-%1").arg(pass).toStdString()));
+    std::vector<std::vector<double> > values;
+    if(!m_sweep.run(batch,nzones,values))
+    {
+      m_error = m_sweep.errorMessage();
+      return false;
+    }
+    for(unsigned i=0;i<pending.size();i++)
+    {
+      m_values[pending[i]] = values[i];
+      m_sampled[pending[i]] = true;
+    }
+    m_simulated += pending.size();
+    pending.clear();
+
+    // Check each row and refine the ones that need it
+    for(unsigned r=0;r<rows.size();r++)
+    {
+      if(done[r])
+      {
+        continue;
+      }
+      std::vector<double> average = estimate(rows[r]);
+      std::vector<double> scale = zoneScales(average);
+      bool converged = !averages[r].empty() && similar(average,averages[r],scale,m_tolerance);
+      averages[r] = average;
+      if(converged)
+      {
+        done[r] = true;
+        continue;
+      }
+      const std::vector<unsigned> &row = rows[r];
+      std::vector<unsigned> sampled;
+      for(unsigned i=0;i<row.size();i++)
+      {
+        if(m_sampled[row[i]])
+        {
+          sampled.push_back(i);
+        }
+      }
+      unsigned before = pending.size();
+      for(unsigned k=0;k<sampled.size();k++)
+      {
+        unsigned a = sampled[k];
+        unsigned b = k+1 < sampled.size() ? sampled[k+1] : sampled[0] + row.size();
+        if(b - a > 1 && !similar(m_values[row[a]],m_values[row[b % row.size()]],scale,m_tolerance))
+        {
+          pending.push_back(row[((a+b)/2) % row.size()]);
+        }
+      }
+      done[r] = pending.size() == before;
+    }
+  }
+
+  results = averages;
+  for(unsigned r=0;r<results.size();r++)
+  {
+    results[r].resize(nzones,0.0);
+  }
+  return true;
+}
+
+} // contamutils
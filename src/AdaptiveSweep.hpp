@@ -0,0 +1,78 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_ADAPTIVESWEEP_HPP
+#define CONTAMUTILITIES_ADAPTIVESWEEP_HPP
+
+#include "WindSweep.hpp"
+
+#include <utilities/core/Path.hpp>
+
+#include <string>
+#include <vector>
+
+namespace contamutils {
+
+// Run only as many of a sweep's directions as it takes to get the direction
+// average. Each row starts with a few evenly spaced directions, and the
+// directions that haven't been run are interpolated (linearly in angle) from
+// their nearest neighbors that have. A direction halfway between two
+// neighbors is added whenever their zone results differ by more than the
+// tolerance, and a row is finished when its weighted average stops changing
+// by more than the tolerance or there is nothing left to refine. Each pass
+// is one WindSweep run, so the cases of a pass still run concurrently.
+class AdaptiveSweep
+{
+public:
+  explicit AdaptiveSweep(WindSweep &sweep);
+
+  // Directions to start each row with (default: 4)
+  void setInitialDirections(int count);
+  // Relative to the size of each zone's direction average (default: 0.02)
+  void setTolerance(double tolerance);
+  // Each pass gets its own subdirectory of this
+  void setScratchDirectory(const openstudio::path &dir);
+
+  // Same as WindSweep::run, but the results are estimated from a subset of the cases
+  bool run(const std::vector<SweepCase> &cases, unsigned nzones, std::vector<std::vector<double> > &results);
+
+  // Number of cases the last run actually simulated
+  unsigned simulatedCases() const;
+  std::string errorMessage() const;
+
+private:
+  std::vector<double> estimate(const std::vector<unsigned> &row) const;
+
+  WindSweep &m_sweep;
+  int m_initial;
+  double m_tolerance;
+  openstudio::path m_scratch;
+
+  // Per-run state
+  std::vector<SweepCase> m_cases;
+  std::vector<std::vector<double> > m_values;
+  std::vector<bool> m_sampled;
+  unsigned m_nzones;
+  unsigned m_simulated;
+  std::string m_error;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_ADAPTIVESWEEP_HPP
@@ -0,0 +1,597 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "AirflowNetwork.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace contamutils {
+
+static const double GRAVITY = 9.80665;     // m/s^2
+static const double GAS_CONSTANT = 287.055; // J/kg K
+static const double VISCOSITY = 1.81625e-5; // kg/m s
+static const double PI = 3.14159265358979323846;
+
+// Sort profile points by angle
+struct AngleOrder
+{
+  bool operator()(const std::pair<double,double> &a, const std::pair<double,double> &b) const
+  {
+    return a.first < b.first;
+  }
+};
+
+AirflowNetwork::AirflowNetwork() : m_Tamb(293.15), m_Pbar(101325.0), m_windSpeed(0.0), m_windDirection(0.0),
+  m_rhoAmb(101325.0/(GAS_CONSTANT*293.15)), m_tolerance(1.0e-10), m_maxIterations(100), m_iterations(0),
+  m_residual(0.0), m_patternBuilt(false)
+{
+  // Typical low-rise wall values
+  m_cp[0] = 0.6;
+  m_cp[1] = -0.3;
+  m_cp[2] = -0.65;
+  m_cp[3] = -0.65;
+}
+
+int AirflowNetwork::addNode(double temperature, double elevation)
+{
+  Node node;
+  node.T = temperature;
+  node.z = elevation;
+  node.rho = m_Pbar/(GAS_CONSTANT*temperature);
+  m_nodes.push_back(node);
+  m_P.push_back(0.0);
+  m_patternBuilt = false;
+  return (int)m_nodes.size()-1;
+}
+
+int AirflowNetwork::addWindProfile(const std::vector<double> &angles, const std::vector<double> &coefficients,
+  ProfileType type)
+{
+  // Keep the points in order on [0,360), dropping repeats like a point at 360 as well as one at 0
+  std::vector<std::pair<double,double> > points;
+  for(unsigned i=0;i<angles.size() && i<coefficients.size();i++)
+  {
+    double angle = std::fmod(angles[i],360.0);
+    if(angle < 0.0)
+    {
+      angle += 360.0;
+    }
+    points.push_back(std::make_pair(angle,coefficients[i]));
+  }
+  std::stable_sort(points.begin(),points.end(),AngleOrder());
+  WindProfile profile;
+  profile.type = type;
+  for(unsigned i=0;i<points.size();i++)
+  {
+    if(profile.angles.empty() || points[i].first > profile.angles.back())
+    {
+      profile.angles.push_back(points[i].first);
+      profile.coefficients.push_back(points[i].second);
+    }
+  }
+  m_profiles.push_back(profile);
+  return (int)m_profiles.size()-1;
+}
+
+int AirflowNetwork::addLink(int from, int to, double elevation, double lam, double turb, double expt, double mult,
+  double windModifier, double azimuth, int profile)
+{
+  Link link;
+  link.from = from;
+  link.to = to;
+  link.z = elevation;
+  link.lam = lam;
+  link.turb = turb;
+  link.expt = expt;
+  link.mult = mult;
+  link.wPmod = windModifier;
+  link.azimuth = azimuth;
+  link.profile = profile;
+  link.dPconst = 0.0;
+  link.rho = m_rhoAmb;
+  m_links.push_back(link);
+  m_patternBuilt = false;
+  return (int)m_links.size()-1;
+}
+
+void AirflowNetwork::setAmbient(double temperature, double pressure, double windSpeed, double windDirection)
+{
+  m_Tamb = temperature;
+  m_Pbar = pressure;
+  m_windSpeed = windSpeed;
+  m_windDirection = windDirection;
+}
+
+void AirflowNetwork::setWindPressureCoefficients(double windward, double leeward, double side90, double side270)
+{
+  m_cp[0] = windward;
+  m_cp[1] = leeward;
+  m_cp[2] = side90;
+  m_cp[3] = side270;
+}
+
+void AirflowNetwork::setTolerance(double tolerance)
+{
+  m_tolerance = tolerance;
+}
+
+void AirflowNetwork::setMaximumIterations(int maximum)
+{
+  m_maxIterations = maximum;
+}
+
+unsigned AirflowNetwork::nodeCount() const
+{
+  return m_nodes.size();
+}
+
+unsigned AirflowNetwork::linkCount() const
+{
+  return m_links.size();
+}
+
+int AirflowNetwork::iterations() const
+{
+  return m_iterations;
+}
+
+double AirflowNetwork::residual() const
+{
+  return m_residual;
+}
+
+const std::vector<double> &AirflowNetwork::pressures() const
+{
+  return m_P;
+}
+
+double AirflowNetwork::windPressureCoefficient(double angle, int profile) const
+{
+  if(profile < 0 || profile >= (int)m_profiles.size())
+  {
+    // Walton's profile:
+    // Cp = 1/2[(C1+C2)(cos^2)^1/4 + (C1-C2)(cos)^3/4 + (C3+C4)(sin^2)^2 + (C3-C4)sin]
+    double theta = angle*PI/180.0;
+    double c = std::cos(theta);
+    double s = std::sin(theta);
+    double sign = c < 0.0 ? -1.0 : 1.0;
+    return 0.5*((m_cp[0]+m_cp[1])*std::pow(c*c,0.25) + (m_cp[0]-m_cp[1])*sign*std::pow(std::fabs(c),0.75)
+      + (m_cp[2]+m_cp[3])*s*s*s*s + (m_cp[2]-m_cp[3])*s);
+  }
+  const WindProfile &wp = m_profiles[profile];
+  unsigned n = wp.angles.size();
+  if(n == 0)
+  {
+    return 0.0;
+  }
+  if(n == 1)
+  {
+    return wp.coefficients[0];
+  }
+  double a = std::fmod(angle,360.0);
+  if(a < 0.0)
+  {
+    a += 360.0;
+  }
+  // The segment from point i-1 to point i, either end may wrap around. The
+  // points on either side of it are needed for the spline slopes.
+  unsigned i = std::upper_bound(wp.angles.begin(),wp.angles.end(),a) - wp.angles.begin();
+  int k0 = (int)i-1;
+  double x[4];
+  double p[4];
+  for(int j=0;j<4;j++)
+  {
+    int k = k0-1+j;
+    int wraps = k < 0 ? -((-k+(int)n-1)/(int)n) : k/(int)n;
+    int m = k - wraps*(int)n;
+    x[j] = wp.angles[m] + 360.0*wraps;
+    p[j] = wp.coefficients[m];
+  }
+  double h = x[2]-x[1];
+  double t = h > 0.0 ? (a-x[1])/h : 0.0;
+  switch(wp.type)
+  {
+  case CubicSpline:
+    {
+      // Cubic Hermite with Catmull-Rom slopes
+      double m1 = (p[2]-p[0])/(x[2]-x[0]);
+      double m2 = (p[3]-p[1])/(x[3]-x[1]);
+      double t2 = t*t;
+      double t3 = t2*t;
+      return (2.0*t3-3.0*t2+1.0)*p[1] + (t3-2.0*t2+t)*h*m1 + (-2.0*t3+3.0*t2)*p[2] + (t3-t2)*h*m2;
+    }
+  case Trigonometric:
+    t = 0.5*(1.0-std::cos(PI*t));
+    return p[1] + t*(p[2]-p[1]);
+  case Linear:
+  default:
+    return p[1] + t*(p[2]-p[1]);
+  }
+}
+
+void AirflowNetwork::prepare()
+{
+  m_rhoAmb = m_Pbar/(GAS_CONSTANT*m_Tamb);
+  for(unsigned i=0;i<m_nodes.size();i++)
+  {
+    m_nodes[i].rho = m_Pbar/(GAS_CONSTANT*m_nodes[i].T);
+  }
+  double windPressure = 0.5*m_rhoAmb*m_windSpeed*m_windSpeed;
+  for(unsigned i=0;i<m_links.size();i++)
+  {
+    Link &link = m_links[i];
+    // Hydrostatic pressure on each side at the link elevation
+    double from;
+    double to;
+    if(link.from == AMBIENT)
+    {
+      from = -m_rhoAmb*GRAVITY*link.z;
+      from += link.wPmod*link.wPmod*windPressure*windPressureCoefficient(m_windDirection-link.azimuth,link.profile);
+    }
+    else
+    {
+      const Node &node = m_nodes[link.from];
+      from = -node.rho*GRAVITY*(link.z - node.z);
+    }
+    if(link.to == AMBIENT)
+    {
+      to = -m_rhoAmb*GRAVITY*link.z;
+      to += link.wPmod*link.wPmod*windPressure*windPressureCoefficient(m_windDirection-link.azimuth,link.profile);
+    }
+    else
+    {
+      const Node &node = m_nodes[link.to];
+      to = -node.rho*GRAVITY*(link.z - node.z);
+    }
+    link.dPconst = from - to;
+    link.rho = m_rhoAmb;
+    if(link.lam <= 0.0)
+    {
+      // No laminar coefficient, make one up that transitions at 0.1 Pa so that
+      // the flow derivative stays bounded near zero pressure difference
+      link.lam = link.turb*std::pow(0.1,link.expt-1.0)*VISCOSITY/std::sqrt(m_rhoAmb);
+    }
+  }
+}
+
+void AirflowNetwork::buildPattern()
+{
+  unsigned n = m_nodes.size();
+  std::vector<std::vector<int> > columns(n);
+  for(unsigned i=0;i<n;i++)
+  {
+    columns[i].push_back(i);
+  }
+  for(unsigned i=0;i<m_links.size();i++)
+  {
+    const Link &link = m_links[i];
+    if(link.from != AMBIENT && link.to != AMBIENT && link.from != link.to)
+    {
+      columns[link.from].push_back(link.to);
+      columns[link.to].push_back(link.from);
+    }
+  }
+  m_rowStart.assign(n+1,0);
+  m_column.clear();
+  m_diag.assign(n,0);
+  for(unsigned i=0;i<n;i++)
+  {
+    std::sort(columns[i].begin(),columns[i].end());
+    columns[i].erase(std::unique(columns[i].begin(),columns[i].end()),columns[i].end());
+    m_rowStart[i] = m_column.size();
+    for(unsigned j=0;j<columns[i].size();j++)
+    {
+      if(columns[i][j] == (int)i)
+      {
+        m_diag[i] = m_column.size();
+      }
+      m_column.push_back(columns[i][j]);
+    }
+  }
+  m_rowStart[n] = m_column.size();
+  m_values.assign(m_column.size(),0.0);
+
+  m_linkFromTo.assign(m_links.size(),-1);
+  m_linkToFrom.assign(m_links.size(),-1);
+  for(unsigned i=0;i<m_links.size();i++)
+  {
+    const Link &link = m_links[i];
+    if(link.from != AMBIENT && link.to != AMBIENT && link.from != link.to)
+    {
+      for(int k=m_rowStart[link.from];k<m_rowStart[link.from+1];k++)
+      {
+        if(m_column[k] == link.to)
+        {
+          m_linkFromTo[i] = k;
+          break;
+        }
+      }
+      for(int k=m_rowStart[link.to];k<m_rowStart[link.to+1];k++)
+      {
+        if(m_column[k] == link.from)
+        {
+          m_linkToFrom[i] = k;
+          break;
+        }
+      }
+    }
+  }
+  m_patternBuilt = true;
+}
+
+double AirflowNetwork::linkDeltaP(const Link &link, const std::vector<double> &P) const
+{
+  double dP = link.dPconst;
+  if(link.from != AMBIENT)
+  {
+    dP += P[link.from];
+  }
+  if(link.to != AMBIENT)
+  {
+    dP -= P[link.to];
+  }
+  return dP;
+}
+
+double AirflowNetwork::flow(const Link &link, double dP, double *derivative) const
+{
+  // Upwind density
+  double rho = link.rho;
+  if(dP >= 0.0)
+  {
+    if(link.from != AMBIENT)
+    {
+      rho = m_nodes[link.from].rho;
+    }
+  }
+  else if(link.to != AMBIENT)
+  {
+    rho = m_nodes[link.to].rho;
+  }
+  double magnitude = std::fabs(dP);
+  double laminarCoefficient = link.mult*link.lam*rho/VISCOSITY;
+  double FL = laminarCoefficient*magnitude;
+  double FT = link.mult*link.turb*std::sqrt(rho)*std::pow(magnitude,link.expt);
+  double F;
+  double dF;
+  if(FL <= FT || magnitude == 0.0)
+  {
+    F = FL;
+    dF = laminarCoefficient;
+  }
+  else
+  {
+    F = FT;
+    dF = link.expt*FT/magnitude;
+  }
+  if(derivative)
+  {
+    *derivative = dF;
+  }
+  return dP < 0.0 ? -F : F;
+}
+
+double AirflowNetwork::computeResidual(const std::vector<double> &P, std::vector<double> &r, bool jacobian)
+{
+  r.assign(m_nodes.size(),0.0);
+  if(jacobian)
+  {
+    std::fill(m_values.begin(),m_values.end(),0.0);
+  }
+  for(unsigned i=0;i<m_links.size();i++)
+  {
+    const Link &link = m_links[i];
+    double dF;
+    double F = flow(link,linkDeltaP(link,P),&dF);
+    if(link.from != AMBIENT)
+    {
+      r[link.from] += F;
+    }
+    if(link.to != AMBIENT)
+    {
+      r[link.to] -= F;
+    }
+    if(jacobian)
+    {
+      if(link.from != AMBIENT)
+      {
+        m_values[m_diag[link.from]] += dF;
+      }
+      if(link.to != AMBIENT)
+      {
+        m_values[m_diag[link.to]] += dF;
+      }
+      if(m_linkFromTo[i] >= 0)
+      {
+        m_values[m_linkFromTo[i]] -= dF;
+        m_values[m_linkToFrom[i]] -= dF;
+      }
+    }
+  }
+  double maximum = 0.0;
+  for(unsigned i=0;i<r.size();i++)
+  {
+    maximum = std::max(maximum,std::fabs(r[i]));
+  }
+  return maximum;
+}
+
+bool AirflowNetwork::solveLinear(const std::vector<double> &b, std::vector<double> &x) const
+{
+  unsigned n = b.size();
+  x.assign(n,0.0);
+  std::vector<double> inverseDiagonal(n);
+  for(unsigned i=0;i<n;i++)
+  {
+    double d = m_values[m_diag[i]];
+    // Guard against nodes that aren't connected to anything
+    inverseDiagonal[i] = d > 0.0 ? 1.0/d : 1.0;
+  }
+  std::vector<double> r(b);
+  std::vector<double> z(n);
+  std::vector<double> p(n);
+  std::vector<double> q(n);
+  double bnorm = 0.0;
+  for(unsigned i=0;i<n;i++)
+  {
+    bnorm += b[i]*b[i];
+    z[i] = inverseDiagonal[i]*r[i];
+    p[i] = z[i];
+  }
+  if(bnorm == 0.0)
+  {
+    return true;
+  }
+  double rz = 0.0;
+  for(unsigned i=0;i<n;i++)
+  {
+    rz += r[i]*z[i];
+  }
+  unsigned maxIterations = 2*n + 50;
+  for(unsigned iter=0;iter<maxIterations;iter++)
+  {
+    double pq = 0.0;
+    for(unsigned i=0;i<n;i++)
+    {
+      double sum = 0.0;
+      for(int k=m_rowStart[i];k<m_rowStart[i+1];k++)
+      {
+        sum += m_values[k]*p[m_column[k]];
+      }
+      q[i] = sum;
+      pq += p[i]*sum;
+    }
+    if(pq <= 0.0)
+    {
+      return false;
+    }
+    double alpha = rz/pq;
+    double rnorm = 0.0;
+    for(unsigned i=0;i<n;i++)
+    {
+      x[i] += alpha*p[i];
+      r[i] -= alpha*q[i];
+      rnorm += r[i]*r[i];
+    }
+    if(rnorm <= 1.0e-24*bnorm)
+    {
+      return true;
+    }
+    double rzNew = 0.0;
+    for(unsigned i=0;i<n;i++)
+    {
+      z[i] = inverseDiagonal[i]*r[i];
+      rzNew += r[i]*z[i];
+    }
+    double beta = rzNew/rz;
+    rz = rzNew;
+    for(unsigned i=0;i<n;i++)
+    {
+      p[i] = z[i] + beta*p[i];
+    }
+  }
+  return true;
+}
+
+bool AirflowNetwork::solve()
+{
+  prepare();
+  if(!m_patternBuilt)
+  {
+    buildPattern();
+  }
+  m_iterations = 0;
+  std::vector<double> r;
+  std::vector<double> dP;
+  std::vector<double> trial;
+  std::vector<double> rTrial;
+  m_residual = computeResidual(m_P,r,true);
+  while(m_residual > m_tolerance && m_iterations < m_maxIterations)
+  {
+    m_iterations++;
+    for(unsigned i=0;i<r.size();i++)
+    {
+      r[i] = -r[i];
+    }
+    if(!solveLinear(r,dP))
+    {
+      return false;
+    }
+    // Back off the step until the residual goes down
+    double lambda = 1.0;
+    double trialResidual = m_residual;
+    for(int k=0;k<20;k++)
+    {
+      trial = m_P;
+      for(unsigned i=0;i<trial.size();i++)
+      {
+        trial[i] += lambda*dP[i];
+      }
+      trialResidual = computeResidual(trial,rTrial,false);
+      if(trialResidual < m_residual)
+      {
+        break;
+      }
+      lambda *= 0.5;
+    }
+    m_P.swap(trial);
+    m_residual = computeResidual(m_P,r,true);
+  }
+  return m_residual <= m_tolerance;
+}
+
+std::vector<double> AirflowNetwork::linkFlows() const
+{
+  std::vector<double> flows(m_links.size());
+  for(unsigned i=0;i<m_links.size();i++)
+  {
+    flows[i] = flow(m_links[i],linkDeltaP(m_links[i],m_P),0);
+  }
+  return flows;
+}
+
+std::vector<double> AirflowNetwork::nodeInfiltration() const
+{
+  std::vector<double> infiltration(m_nodes.size(),0.0);
+  for(unsigned i=0;i<m_links.size();i++)
+  {
+    const Link &link = m_links[i];
+    if(link.from == AMBIENT && link.to != AMBIENT)
+    {
+      double F = flow(link,linkDeltaP(link,m_P),0);
+      if(F > 0.0)
+      {
+        infiltration[link.to] += F;
+      }
+    }
+    else if(link.to == AMBIENT && link.from != AMBIENT)
+    {
+      double F = flow(link,linkDeltaP(link,m_P),0);
+      if(F < 0.0)
+      {
+        infiltration[link.from] -= F;
+      }
+    }
+  }
+  return infiltration;
+}
+
+} // contamutils
@@ -0,0 +1,153 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_AIRFLOWNETWORK_HPP
+#define CONTAMUTILITIES_AIRFLOWNETWORK_HPP
+
+#include <vector>
+
+namespace contamutils {
+
+// A steady-state multizone airflow network with power-law links. The node
+// pressures are solved for with Newton's method, the Jacobian is stored in
+// compressed row form and the linear systems are solved with a Jacobi
+// preconditioned conjugate gradient (the Jacobian of a power-law network is
+// symmetric and positive definite as long as every node can reach ambient).
+//
+// The flow relations follow CONTAM: the turbulent flow is
+//
+//   F = mult * turb * sqrt(rho) * dP^expt
+//
+// and the laminar flow is F = mult * lam * rho / mu * dP, with the laminar
+// relation used whenever it gives the smaller flow. Pressures are relative to
+// the ambient pressure at ground level, flows are in kg/s.
+class AirflowNetwork
+{
+public:
+  // Ambient is always node -1
+  static const int AMBIENT = -1;
+  // Links that use the Walton trig profile rather than one of the added profiles
+  static const int WALTON_PROFILE = -1;
+  // How a wind pressure profile is interpolated between its points, numbered as in the PRJ file
+  enum ProfileType {Linear=1, CubicSpline=2, Trigonometric=3};
+
+  AirflowNetwork();
+
+  // Add a node at the given temperature [K] and reference elevation [m], returns the index
+  int addNode(double temperature, double elevation);
+  // Add a wind pressure profile, the pressure coefficient at each of a set of angles [deg] to the wind.
+  // The profile is periodic, so a point at 360 is the same as one at 0. Returns the profile index.
+  int addWindProfile(const std::vector<double> &angles, const std::vector<double> &coefficients, ProfileType type);
+  // Add a link, wind is only applied to links with ambient on one side and a nonzero modifier
+  int addLink(int from, int to, double elevation, double lam, double turb, double expt, double mult,
+    double windModifier=0.0, double azimuth=0.0, int profile=WALTON_PROFILE);
+
+  // Set the outdoor conditions: temperature [K], barometric pressure [Pa], wind speed [m/s] and direction [deg]
+  void setAmbient(double temperature, double pressure, double windSpeed, double windDirection);
+  // Set the four coefficients of the Walton trig wind pressure profile
+  void setWindPressureCoefficients(double windward, double leeward, double side90, double side270);
+  void setTolerance(double tolerance);
+  void setMaximumIterations(int maximum);
+
+  bool solve();
+
+  unsigned nodeCount() const;
+  unsigned linkCount() const;
+  int iterations() const;
+  double residual() const;
+  const std::vector<double> &pressures() const;
+  // The flow in each link, positive in the from -> to direction
+  std::vector<double> linkFlows() const;
+  // The flow into each node from ambient
+  std::vector<double> nodeInfiltration() const;
+
+  // The wind pressure coefficient for a wall at the given angle to the wind [deg]
+  double windPressureCoefficient(double angle, int profile=WALTON_PROFILE) const;
+
+private:
+  struct WindProfile
+  {
+    std::vector<double> angles;
+    std::vector<double> coefficients;
+    ProfileType type;
+  };
+
+  struct Node
+  {
+    double T;
+    double z;
+    double rho;
+  };
+
+  struct Link
+  {
+    int from;
+    int to;
+    double z;
+    double lam;
+    double turb;
+    double expt;
+    double mult;
+    double wPmod;
+    double azimuth;
+    int profile;
+    // Everything but the node pressures, precomputed for the current ambient conditions
+    double dPconst;
+    double rho;
+  };
+
+  void prepare();
+  void buildPattern();
+  double flow(const Link &link, double dP, double *derivative) const;
+  double linkDeltaP(const Link &link, const std::vector<double> &P) const;
+  double computeResidual(const std::vector<double> &P, std::vector<double> &r, bool jacobian);
+  bool solveLinear(const std::vector<double> &b, std::vector<double> &x) const;
+
+  std::vector<Node> m_nodes;
+  std::vector<Link> m_links;
+  std::vector<WindProfile> m_profiles;
+
+  double m_Tamb;
+  double m_Pbar;
+  double m_windSpeed;
+  double m_windDirection;
+  double m_rhoAmb;
+  double m_cp[4];
+
+  double m_tolerance;
+  int m_maxIterations;
+  int m_iterations;
+  double m_residual;
+
+  std::vector<double> m_P;
+
+  // Compressed row storage for the Jacobian, m_diag is the position of each diagonal entry
+  std::vector<int> m_rowStart;
+  std::vector<int> m_column;
+  std::vector<int> m_diag;
+  std::vector<double> m_values;
+  // Positions in m_values of the (from,to) and (to,from) entries for each link
+  std::vector<int> m_linkFromTo;
+  std::vector<int> m_linkToFrom;
+  bool m_patternBuilt;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_AIRFLOWNETWORK_HPP
@@ -0,0 +1,266 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "AirflowView.hpp"
+
+#include <utilities/idd/IddEnums.hxx>
+#include <utilities/idd/IddObject.hpp>
+#include <utilities/idf/IdfFile.hpp>
+#include <utilities/idf/IdfObject.hpp>
+#include <utilities/idf/WorkspaceObject.hpp>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/foreach.hpp>
+
+#include <fstream>
+#include <sstream>
+
+namespace contamutils {
+
+// Classes (or, ending in anything, families of classes) that have nothing to
+// do with the airflow network. Schedules and HVAC stay, the translator needs
+// the thermostats and the air loops.
+static const char *SKIPPED_CLASSES[] = {
+  "OS:ComponentCost",
+  "OS:ComponentData",
+  "OS:Construction",
+  "OS:CurrencyType",
+  "OS:Daylighting:",
+  "OS:DefaultConstructionSet",
+  "OS:DefaultScheduleSet",
+  "OS:DefaultSubSurfaceConstructions",
+  "OS:DefaultSurfaceConstructions",
+  "OS:ElectricEquipment",
+  "OS:EnergyManagementSystem:",
+  "OS:GasEquipment",
+  "OS:Glare:",
+  "OS:HotWaterEquipment",
+  "OS:IlluminanceMap",
+  "OS:InteriorPartitionSurface",
+  "OS:InternalMass",
+  "OS:LifeCycleCost",
+  "OS:Lights",
+  "OS:Luminaire",
+  "OS:Material",
+  "OS:Meter",
+  "OS:OtherEquipment",
+  "OS:Output:Meter",
+  "OS:Output:Variable",
+  "OS:People",
+  "OS:Rendering:Color",
+  "OS:ShadingSurface",
+  "OS:StandardsInformation:",
+  "OS:SteamEquipment",
+  "OS:UtilityBill",
+  "OS:UtilityCost:",
+  "OS:WindowMaterial:",
+  "OS:WindowProperty:",
+  0
+};
+
+// One field of the object at range, comments stripped and trimmed
+static std::string objectField(const std::string &text, const std::pair<std::size_t,std::size_t> &range,
+  unsigned index)
+{
+  unsigned field = 0;
+  std::string value;
+  for(std::size_t i=range.first;i<range.second;i++)
+  {
+    char c = text[i];
+    if(c == '!')
+    {
+      i = text.find('\n',i);
+      if(i == std::string::npos)
+      {
+        break;
+      }
+    }
+    else if(c == ',' || c == ';')
+    {
+      if(field == index)
+      {
+        break;
+      }
+      field++;
+    }
+    else if(field == index)
+    {
+      value += c;
+    }
+  }
+  return boost::trim_copy(value);
+}
+
+AirflowView::AirflowView() : m_skipped(0)
+{
+}
+
+bool AirflowView::skipped(const std::string &className)
+{
+  for(const char **prefix=SKIPPED_CLASSES;*prefix;prefix++)
+  {
+    if(boost::istarts_with(className,*prefix))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool AirflowView::fail(const std::string &message)
+{
+  m_error = message;
+  return false;
+}
+
+openstudio::model::Model AirflowView::model() const
+{
+  return m_model.get();
+}
+
+bool AirflowView::partial() const
+{
+  return !m_ranges.empty();
+}
+
+std::size_t AirflowView::skippedCount() const
+{
+  return m_skipped;
+}
+
+std::string AirflowView::errorMessage() const
+{
+  return m_error;
+}
+
+bool AirflowView::load(const openstudio::path &path, bool full)
+{
+  m_model.reset();
+  m_text.clear();
+  m_ranges.clear();
+  m_handles.clear();
+  m_loaded.clear();
+  m_skipped = 0;
+  m_error.clear();
+
+  // Only a current file can be split up, anything else has to be translated as a whole
+  boost::optional<std::string> version = osmVersion(path);
+  if(!full && version && *version == currentOsmVersion())
+  {
+    std::ifstream file(openstudio::toString(path).c_str(),std::ios::in|std::ios::binary);
+    if(!file.good())
+    {
+      return fail("Failed to open '" + openstudio::toString(path) + "'");
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    m_text = buffer.str();
+    m_ranges = osmObjectRanges(m_text);
+    std::string kept;
+    kept.reserve(m_text.size());
+    for(unsigned i=0;i<m_ranges.size();i++)
+    {
+      if(skipped(objectField(m_text,m_ranges[i],0)))
+      {
+        m_handles.push_back(openstudio::Handle());
+        m_skipped++;
+        continue;
+      }
+      m_handles.push_back(openstudio::toUUID(objectField(m_text,m_ranges[i],1)));
+      kept.append(m_text,m_ranges[i].first,m_ranges[i].second-m_ranges[i].first);
+      kept += "\n\n";
+    }
+    try
+    {
+      std::istringstream stream(kept);
+      boost::optional<openstudio::IdfFile> idfFile = openstudio::IdfFile::load(stream,openstudio::IddFileType::OpenStudio);
+      if(idfFile)
+      {
+        m_model = openstudio::model::Model(*idfFile);
+      }
+    }
+    catch(...)
+    {
+    }
+    if(m_model)
+    {
+      // Only these can be removed, the model makes some objects (the version) afresh
+      BOOST_FOREACH(const openstudio::WorkspaceObject &object, m_model->objects())
+      {
+        m_loaded.insert(object.handle());
+      }
+      return true;
+    }
+    // Something in there needs more than the view has, so have all of it
+    m_text.clear();
+    m_ranges.clear();
+    m_handles.clear();
+    m_skipped = 0;
+  }
+  m_model = loadModel(path);
+  if(!m_model)
+  {
+    return fail("Unable to load '" + openstudio::toString(path) + "' as an OpenStudio model");
+  }
+  return true;
+}
+
+bool AirflowView::save(const openstudio::path &path)
+{
+  if(!m_model)
+  {
+    return fail("No model to save");
+  }
+  if(!partial())
+  {
+    if(!m_model->save(path,true))
+    {
+      return fail("Failed to write '" + openstudio::toString(path) + "'");
+    }
+    return true;
+  }
+  std::ofstream out(openstudio::toString(path).c_str(),std::ios::out|std::ios::binary);
+  // Everything up to the next object goes with an object, so that an unchanged
+  // file is written back byte for byte, trailing comments and all
+  out.write(m_text.data(),m_ranges[0].first);
+  for(unsigned i=0;i<m_ranges.size();i++)
+  {
+    std::size_t end = i+1 < m_ranges.size() ? m_ranges[i+1].first : m_text.size();
+    if(m_loaded.count(m_handles[i]) && !m_model->getObject(m_handles[i]))
+    {
+      continue;
+    }
+    out.write(m_text.data()+m_ranges[i].first,end-m_ranges[i].first);
+  }
+  BOOST_FOREACH(const openstudio::WorkspaceObject &object, m_model->objects())
+  {
+    if(m_loaded.count(object.handle()) || object.iddObject().type() == openstudio::IddObjectType::OS_Version)
+    {
+      continue;
+    }
+    out << object.idfObject() << std::endl;
+  }
+  if(!out.good())
+  {
+    return fail("Failed to write '" + openstudio::toString(path) + "'");
+  }
+  return true;
+}
+
+} // contamutils
@@ -0,0 +1,81 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_AIRFLOWVIEW_HPP
+#define CONTAMUTILITIES_AIRFLOWVIEW_HPP
+
+#include "ModelLoader.hpp"
+
+#include <model/Model.hpp>
+#include <utilities/core/Path.hpp>
+#include <utilities/core/UUID.hpp>
+
+#include <boost/optional.hpp>
+
+#include <cstddef>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace contamutils {
+
+// A model with only the objects that the CONTAM translation and the
+// infiltration write-back need. Output requests, rendering colors,
+// constructions and materials, internal loads, shading, daylighting, costs
+// and the like stay in the file as text and aren't parsed at all. Saving
+// writes the file back as it was loaded, less the objects that were removed
+// from the model and plus the ones that were added. Changes to objects that
+// were already in the file are not saved; the tools only ever remove and add
+// infiltration objects and their schedules. Files from other versions of
+// OpenStudio have to be translated, so they are loaded (and saved) in full.
+class AirflowView
+{
+public:
+  AirflowView();
+
+  // Load an OSM, in full if full is true
+  bool load(const openstudio::path &path, bool full=false);
+  bool save(const openstudio::path &path);
+
+  // The loaded model, which shares its objects with the view
+  openstudio::model::Model model() const;
+  // Whether some of the file was left as text
+  bool partial() const;
+  std::size_t skippedCount() const;
+  std::string errorMessage() const;
+
+  // Whether objects of this class are left as text
+  static bool skipped(const std::string &className);
+
+private:
+  bool fail(const std::string &message);
+
+  boost::optional<openstudio::model::Model> m_model;
+  std::string m_text;
+  OsmObjectRanges m_ranges;
+  // The handle of each object in the model, null for those left as text
+  std::vector<openstudio::Handle> m_handles;
+  std::set<openstudio::Handle> m_loaded;
+  std::size_t m_skipped;
+  std::string m_error;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_AIRFLOWVIEW_HPP
@@ -0,0 +1,273 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "ContamNetwork.hpp"
+
+#include <airflow/contam/PrjAirflowElements.hpp>
+#include <airflow/contam/PrjObjects.hpp>
+
+#include <boost/shared_ptr.hpp>
+
+#include <cstdlib>
+#include <map>
+#include <sstream>
+
+namespace contamutils {
+
+struct PowerLaw
+{
+  double lam;
+  double turb;
+  double expt;
+};
+
+template <class T> bool getPowerLaw(boost::shared_ptr<openstudio::contam::AirflowElement> afe, PowerLaw &powerLaw)
+{
+  boost::shared_ptr<T> element = boost::dynamic_pointer_cast<T>(afe);
+  if(!element)
+  {
+    return false;
+  }
+  powerLaw.lam = element->lam();
+  powerLaw.turb = element->turb();
+  powerLaw.expt = element->expt();
+  return true;
+}
+
+static bool getPowerLaw(boost::shared_ptr<openstudio::contam::AirflowElement> afe, PowerLaw &powerLaw)
+{
+  return getPowerLaw<openstudio::contam::PlrLeak2>(afe,powerLaw)
+    || getPowerLaw<openstudio::contam::PlrLeak1>(afe,powerLaw)
+    || getPowerLaw<openstudio::contam::PlrLeak3>(afe,powerLaw)
+    || getPowerLaw<openstudio::contam::PlrTest1>(afe,powerLaw)
+    || getPowerLaw<openstudio::contam::PlrTest2>(afe,powerLaw)
+    || getPowerLaw<openstudio::contam::PlrOrf>(afe,powerLaw);
+}
+
+// The next line of a PRJ section, skipping comments and blank lines
+static bool nextPrjLine(std::istream &in, std::string &line)
+{
+  while(std::getline(in,line))
+  {
+    std::string::size_type start = line.find_first_not_of(" \t\r");
+    if(start != std::string::npos && line[start] != '!')
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The IndexModel doesn't give access to the wind pressure profiles, so they
+// are read from its PRJ text. Each profile is written as
+//
+//   nr npts type name
+//   description
+//   azimuth Cp   (npts lines)
+//
+// after the line that gives the number of profiles.
+static bool readWindProfiles(const std::string &prj, AirflowNetwork &network, std::map<int,int> &profileIndex)
+{
+  // The section also has a comment line with the same text, the count line is the one that starts with a number
+  std::string::size_type header = 0;
+  int count = -1;
+  while(count < 0)
+  {
+    header = prj.find("! wind pressure profiles",header);
+    if(header == std::string::npos)
+    {
+      return true;
+    }
+    std::string::size_type lineStart = prj.rfind('\n',header);
+    lineStart = lineStart == std::string::npos ? 0 : lineStart+1;
+    char *end;
+    long value = std::strtol(prj.c_str()+lineStart,&end,10);
+    if(end != prj.c_str()+lineStart && end <= prj.c_str()+header)
+    {
+      count = (int)value;
+    }
+    header++;
+  }
+  std::string::size_type lineEnd = prj.find('\n',header);
+  std::istringstream in(lineEnd == std::string::npos ? std::string() : prj.substr(lineEnd+1));
+  std::string line;
+  for(int i=0;i<count;i++)
+  {
+    int nr, npts, type;
+    if(!nextPrjLine(in,line) || !(std::istringstream(line) >> nr >> npts >> type) || npts < 1)
+    {
+      return false;
+    }
+    // The description
+    if(!std::getline(in,line))
+    {
+      return false;
+    }
+    std::vector<double> angles;
+    std::vector<double> coefficients;
+    for(int j=0;j<npts;j++)
+    {
+      double angle, coefficient;
+      if(!nextPrjLine(in,line) || !(std::istringstream(line) >> angle >> coefficient))
+      {
+        return false;
+      }
+      angles.push_back(angle);
+      coefficients.push_back(coefficient);
+    }
+    AirflowNetwork::ProfileType profileType = AirflowNetwork::Linear;
+    if(type == AirflowNetwork::CubicSpline || type == AirflowNetwork::Trigonometric)
+    {
+      profileType = (AirflowNetwork::ProfileType)type;
+    }
+    profileIndex[nr] = network.addWindProfile(angles,coefficients,profileType);
+  }
+  return true;
+}
+
+// Look up the network node of a zone that a path connects to
+static bool findNode(const std::map<int,int> &nodeIndex, const openstudio::contam::AirflowPath &path, int zoneNr,
+  int &node, std::string &error)
+{
+  std::map<int,int>::const_iterator iter = nodeIndex.find(zoneNr);
+  if(iter == nodeIndex.end())
+  {
+    std::stringstream message;
+    message << "Path " << path.nr() << " connects to zone " << zoneNr << ", which can't be found";
+    error = message.str();
+    return false;
+  }
+  node = iter->second;
+  return true;
+}
+
+ContamNetwork::ContamNetwork(const openstudio::contam::IndexModel &model) : m_valid(false)
+{
+  // Level elevations by number
+  std::map<int,double> elevation;
+  std::vector<openstudio::contam::Level> levels = model.levels();
+  for(unsigned i=0;i<levels.size();i++)
+  {
+    elevation[levels[i].nr()] = levels[i].refht();
+  }
+
+  // Zones are added in order, so node index = zone number - 1
+  std::map<int,int> nodeIndex;
+  std::vector<openstudio::contam::Zone> zones = model.zones();
+  for(unsigned i=0;i<zones.size();i++)
+  {
+    nodeIndex[zones[i].nr()] = m_network.addNode(zones[i].T0(),elevation[zones[i].pl()]);
+  }
+
+  // Wind pressure profiles by number
+  std::map<int,int> profileIndex;
+  if(!readWindProfiles(model.toString(),m_network,profileIndex))
+  {
+    m_error = "Failed to read the wind pressure profiles";
+    return;
+  }
+
+  std::map<int,PowerLaw> elements;
+  std::vector<boost::shared_ptr<openstudio::contam::AirflowElement> > afes = model.airflowElements();
+  for(unsigned i=0;i<afes.size();i++)
+  {
+    PowerLaw powerLaw;
+    if(getPowerLaw(afes[i],powerLaw))
+    {
+      elements[afes[i]->nr()] = powerLaw;
+    }
+  }
+
+  std::vector<openstudio::contam::AirflowPath> paths = model.airflowPaths();
+  for(unsigned i=0;i<paths.size();i++)
+  {
+    const openstudio::contam::AirflowPath &path = paths[i];
+    std::map<int,PowerLaw>::const_iterator element = elements.find(path.pe());
+    if(element == elements.end())
+    {
+      std::stringstream message;
+      message << "Path " << path.nr() << " uses an airflow element that is not a power-law element";
+      m_error = message.str();
+      return;
+    }
+    int from = AirflowNetwork::AMBIENT;
+    int to = AirflowNetwork::AMBIENT;
+    if(path.pzn() > 0 && !findNode(nodeIndex,path,path.pzn(),from,m_error))
+    {
+      return;
+    }
+    if(path.pzm() > 0 && !findNode(nodeIndex,path,path.pzm(),to,m_error))
+    {
+      return;
+    }
+    double windModifier = 0.0;
+    int profile = AirflowNetwork::WALTON_PROFILE;
+    if(from == AirflowNetwork::AMBIENT || to == AirflowNetwork::AMBIENT)
+    {
+      windModifier = path.wPmod();
+      // Paths without a profile of their own get the generic wall profile
+      if(path.pw() > 0)
+      {
+        std::map<int,int>::const_iterator iter = profileIndex.find(path.pw());
+        if(iter == profileIndex.end())
+        {
+          std::stringstream message;
+          message << "Path " << path.nr() << " uses wind pressure profile " << path.pw() << ", which can't be found";
+          m_error = message.str();
+          return;
+        }
+        profile = iter->second;
+      }
+    }
+    m_network.addLink(from,to,elevation[path.pld()]+path.relHt(),element->second.lam,element->second.turb,
+      element->second.expt,path.mult(),windModifier,path.wazm(),profile);
+  }
+  m_valid = true;
+}
+
+bool ContamNetwork::valid() const
+{
+  return m_valid;
+}
+
+std::string ContamNetwork::errorMessage() const
+{
+  return m_error;
+}
+
+unsigned ContamNetwork::zoneCount() const
+{
+  return m_network.nodeCount();
+}
+
+bool ContamNetwork::zoneInfiltration(double windSpeed, double windDirection, double Tambt, double barpres,
+  std::vector<double> &infiltration) const
+{
+  // Work on a copy so that this can be called from more than one thread
+  AirflowNetwork network(m_network);
+  network.setAmbient(Tambt,barpres,windSpeed,windDirection);
+  if(!network.solve())
+  {
+    return false;
+  }
+  infiltration = network.nodeInfiltration();
+  return true;
+}
+
+} // contamutils
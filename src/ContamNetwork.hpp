@@ -0,0 +1,58 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_CONTAMNETWORK_HPP
+#define CONTAMUTILITIES_CONTAMNETWORK_HPP
+
+#include "AirflowNetwork.hpp"
+
+#include <airflow/contam/ForwardTranslator.hpp>
+
+#include <string>
+#include <vector>
+
+namespace contamutils {
+
+// The airflow network of a translated CONTAM model, ready to be solved in
+// process for steady-state conditions. Only power-law elements are supported,
+// which covers everything the forward translator generates for envelope and
+// interzone leakage.
+class ContamNetwork
+{
+public:
+  explicit ContamNetwork(const openstudio::contam::IndexModel &model);
+
+  bool valid() const;
+  std::string errorMessage() const;
+  unsigned zoneCount() const;
+
+  // Solve for the given conditions and return the infiltration into each zone
+  // (in zone order, kg/s), the same quantity as IndexModel::zoneInfiltration
+  bool zoneInfiltration(double windSpeed, double windDirection, double Tambt, double barpres,
+    std::vector<double> &infiltration) const;
+
+private:
+  AirflowNetwork m_network;
+  bool m_valid;
+  std::string m_error;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_CONTAMNETWORK_HPP
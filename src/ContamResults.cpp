@@ -0,0 +1,72 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "ContamResults.hpp"
+#include "FlowConversion.hpp"
+
+#include <airflow/contam/PrjObjects.hpp>
+
+#include <map>
+
+namespace contamutils {
+
+bool readPathInfiltration(const openstudio::contam::IndexModel &model, const openstudio::path &lfrPath,
+  const std::vector<int> &pathNrs, PathFlowMatrix &flows)
+{
+  std::map<int,PathFlowMatrix::Flow> direction;
+  std::vector<openstudio::contam::AirflowPath> paths = model.airflowPaths();
+  for(unsigned i=0;i<paths.size();i++)
+  {
+    PathFlowMatrix::Flow flow = PathFlowMatrix::Net;
+    if(paths[i].pzn() <= 0)
+    {
+      flow = PathFlowMatrix::InwardPositive;
+    }
+    else if(paths[i].pzm() <= 0)
+    {
+      flow = PathFlowMatrix::InwardNegative;
+    }
+    direction[paths[i].nr()] = flow;
+  }
+  std::vector<PathFlowMatrix::Path> selected;
+  for(unsigned i=0;i<pathNrs.size();i++)
+  {
+    selected.push_back(PathFlowMatrix::Path(pathNrs[i],direction[pathNrs[i]]));
+  }
+  return flows.readLfr(openstudio::toString(lfrPath),selected);
+}
+
+void accumulateOntoGrid(const PathFlowMatrix &flows, const int *target, std::size_t targets,
+  const openstudio::DateTime &start, double step, std::size_t steps, double *out)
+{
+  if(!steps || !flows.timeCount())
+  {
+    return;
+  }
+  // The matrix times are days into the year, so the grid starts this far in
+  double offset = -(start.date().dayOfYear() - 1 + start.time().totalDays());
+  std::vector<double> row(steps);
+  for(std::size_t i=0;i<flows.pathCount();i++)
+  {
+    sampleOntoGrid(&flows.days()[0],flows.row(i),flows.timeCount(),offset,step,steps,&row[0]);
+    accumulateRows(&row[0],1,steps,&target[i],targets,out);
+  }
+}
+
+} // contamutils
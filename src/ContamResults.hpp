@@ -0,0 +1,48 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_CONTAMRESULTS_HPP
+#define CONTAMUTILITIES_CONTAMRESULTS_HPP
+
+#include "PathFlowMatrix.hpp"
+
+#include <airflow/contam/ForwardTranslator.hpp>
+
+#include <utilities/core/Path.hpp>
+#include <utilities/time/DateTime.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace contamutils {
+
+// Read the infiltration [kg/s] through the given paths from the link flow
+// results of a simulation of the model. Flow from ambient counts for exterior
+// paths, interior paths get their net flow.
+bool readPathInfiltration(const openstudio::contam::IndexModel &model, const openstudio::path &lfrPath,
+  const std::vector<int> &pathNrs, PathFlowMatrix &flows);
+
+// Sample every row onto the schedule grid (see FlowConversion.hpp) and add it
+// into row target[i] of out, which holds targets rows of steps values
+void accumulateOntoGrid(const PathFlowMatrix &flows, const int *target, std::size_t targets,
+  const openstudio::DateTime &start, double step, std::size_t steps, double *out);
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_CONTAMRESULTS_HPP
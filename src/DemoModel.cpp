@@ -0,0 +1,493 @@
+/**********************************************************************
+ *  Copyright (c) 2008-2010, Alliance for Sustainable Energy.
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "DemoModel.hpp"
+#include "ModelLoader.hpp"
+
+#include <model/Building.hpp>
+#include <model/Building_Impl.hpp>
+#include <model/ThermalZone.hpp>
+#include <model/ThermalZone_Impl.hpp>
+#include <model/Space.hpp>
+#include <model/SpaceType.hpp>
+#include <model/SizingZone.hpp>
+#include <model/DesignSpecificationOutdoorAir.hpp>
+#include <model/BuildingStory.hpp>
+#include <model/ThermostatSetpointDualSetpoint.hpp>
+#include <model/ThermostatSetpointDualSetpoint_Impl.hpp>
+#include <model/HVACTemplates.hpp>
+#include <model/AirLoopHVAC.hpp>
+#include <model/AirLoopHVAC_Impl.hpp>
+#include <model/SetpointManagerSingleZoneReheat.hpp>
+#include <model/SetpointManagerSingleZoneReheat_Impl.hpp>
+#include <osversion/VersionTranslator.hpp>
+#include <utilities/geometry/Point3d.hpp>
+
+#include <boost/foreach.hpp>
+
+#include <QFile>
+#include <QString>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace contamutils {
+
+bool parseFloorPlate(const std::string &name, FloorPlate &floorPlate)
+{
+  if(name == "bar")
+  {
+    floorPlate = Bar;
+  }
+  else if(name == "grid")
+  {
+    floorPlate = Grid;
+  }
+  else if(name == "corridor")
+  {
+    floorPlate = Corridor;
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+DemoModelSettings::DemoModelSettings() : stories(1), zonesPerStory(4), floorPlate(Grid), zoneWidth(5.0),
+  zoneDepth(6.0), corridorWidth(2.0), floorHeight(3.0), hvac(true)
+{
+}
+
+DemoModelSettings scaledDemoModel(int zones, FloorPlate floorPlate)
+{
+  DemoModelSettings settings;
+  settings.floorPlate = floorPlate;
+  settings.stories = std::max(1,(int)(0.5*std::sqrt((double)zones)));
+  settings.zonesPerStory = std::max(floorPlate == Corridor ? 2 : 1,(zones+settings.stories-1)/settings.stories);
+  return settings;
+}
+
+boost::optional<openstudio::model::Model> loadDemoTemplate(const openstudio::path &path)
+{
+  boost::optional<openstudio::model::Model> model;
+  if(!path.empty())
+  {
+    model = loadModel(path);
+    if(model)
+    {
+      return model;
+    }
+    std::cout << "Failed to open input template model '" << openstudio::toString(path) << "'." << std::endl;
+    std::cout << "Using default template." << std::endl;
+  }
+  QFile fp(":/templates/CONTAMTemplate.osm");
+  if(!fp.open(QFile::ReadOnly))
+  {
+    std::cout << "Failed to open default template model." << std::endl;
+    return boost::none;
+  }
+  QTextStream stream(&fp);
+  std::istringstream osm(stream.readAll().toStdString());
+  fp.close();
+  openstudio::osversion::VersionTranslator vt;
+  model = vt.loadModel(osm);
+  if(!model)
+  {
+    std::cout << "Failed to read default template model." << std::endl;
+  }
+  return model;
+}
+
+// Set the outdoor air specifications of the template's building space type
+static bool setOutdoorAir(openstudio::model::Model &model)
+{
+  openstudio::model::Building building = model.getUniqueModelObject<openstudio::model::Building>();
+  boost::optional<openstudio::model::SpaceType> spaceType = building.spaceType();
+  if(!spaceType)
+  {
+    return false;
+  }
+  boost::optional<openstudio::model::DesignSpecificationOutdoorAir> oa = spaceType->designSpecificationOutdoorAir();
+  if(!oa)
+  {
+    return false;
+  }
+  return oa->setOutdoorAirMethod("Sum")
+    && oa->setOutdoorAirFlowperPerson(0.0)
+    && oa->setOutdoorAirFlowperFloorArea(0.00508) // 1 cfm/ft^2 = 0.00508 m/s
+    && oa->setOutdoorAirFlowRate(0.0)
+    && oa->setOutdoorAirFlowAirChangesperHour(0.0);
+}
+
+static boost::optional<openstudio::model::ThermostatSetpointDualSetpoint> findThermostat(openstudio::model::Model &model)
+{
+  BOOST_FOREACH(openstudio::model::ThermostatSetpointDualSetpoint t,
+    model.getModelObjects<openstudio::model::ThermostatSetpointDualSetpoint>())
+  {
+    return boost::optional<openstudio::model::ThermostatSetpointDualSetpoint>(t);
+  }
+  return boost::none;
+}
+
+boost::optional<openstudio::model::Model> buildDemoModel(openstudio::model::Model model)
+{
+  if(!setOutdoorAir(model))
+  {
+    return boost::optional<openstudio::model::Model>();
+  }
+
+  double floorHeight = 3.0;
+
+  openstudio::model::BuildingStory story1(model);
+  story1.setName("Story 1");
+  story1.setNominalZCoordinate(0.0);
+  story1.setNominalFloortoFloorHeight(floorHeight);
+
+  std::vector<openstudio::Point3d> points;
+  points.push_back(openstudio::Point3d(0,0,0));
+  points.push_back(openstudio::Point3d(0,17,0));
+  points.push_back(openstudio::Point3d(8,17,0));
+  points.push_back(openstudio::Point3d(8,10,0));
+  points.push_back(openstudio::Point3d(8,0,0));
+
+  boost::optional<openstudio::model::Space> library = openstudio::model::Space::fromFloorPrint(points, floorHeight, model);
+  if(!library)
+  {
+    return boost::optional<openstudio::model::Model>();
+  }
+  library->setName("Library");
+
+  points.clear();
+  points.push_back(openstudio::Point3d(8,10,0));
+  points.push_back(openstudio::Point3d(8,17,0));
+  points.push_back(openstudio::Point3d(18,17,0));
+  points.push_back(openstudio::Point3d(18,10,0));
+  points.push_back(openstudio::Point3d(11,10,0));
+
+  boost::optional<openstudio::model::Space> office2 = openstudio::model::Space::fromFloorPrint(points, floorHeight, model);
+  if(!office2)
+  {
+    return boost::optional<openstudio::model::Model>();
+  }
+  office2->setName("Office 2");
+
+  points.clear();
+  points.push_back(openstudio::Point3d(8,0,0));
+  points.push_back(openstudio::Point3d(8,10,0));
+  points.push_back(openstudio::Point3d(11,10,0));
+  points.push_back(openstudio::Point3d(11,0,0));
+
+  boost::optional<openstudio::model::Space> hallway = openstudio::model::Space::fromFloorPrint(points, floorHeight, model);
+  if(!hallway)
+  {
+    return boost::optional<openstudio::model::Model>();
+  }
+  hallway->setName("Hallway");
+
+  points.clear();
+  points.push_back(openstudio::Point3d(11,0,0));
+  points.push_back(openstudio::Point3d(11,10,0));
+  points.push_back(openstudio::Point3d(18,10,0));
+  points.push_back(openstudio::Point3d(18,0,0));
+
+  boost::optional<openstudio::model::Space> office1 = openstudio::model::Space::fromFloorPrint(points, floorHeight, model);
+  if(!office1)
+  {
+    return boost::optional<openstudio::model::Model>();
+  }
+  office1->setName("Office 1");
+
+  library->matchSurfaces(*office2);
+  library->matchSurfaces(*hallway);
+  hallway->matchSurfaces(*office1);
+  hallway->matchSurfaces(*office2);
+  office1->matchSurfaces(*office2);
+
+  // find thermostat
+  boost::optional<openstudio::model::ThermostatSetpointDualSetpoint> thermostat = findThermostat(model);
+  if(!thermostat)
+  {
+    return boost::optional<openstudio::model::Model>();
+  }
+  
+  // create  thermal zones
+  openstudio::model::ThermalZone libraryZone(model);
+  openstudio::model::SizingZone librarySizing(model, libraryZone);
+  libraryZone.setName("Library Zone");
+  libraryZone.setThermostatSetpointDualSetpoint(*thermostat);
+  library->setThermalZone(libraryZone);
+  library->setBuildingStory(story1);
+
+  openstudio::model::ThermalZone hallwayZone(model);
+  //model::SizingZone hallwaySizing(model, hallwayZone);
+  hallwayZone.setName("Hallway Zone");
+  //hallwayZone.setThermostatSetpointDualSetpoint(*thermostat);
+  hallway->setThermalZone(hallwayZone);
+  hallway->setBuildingStory(story1);
+
+  openstudio::model::ThermalZone office1Zone(model);
+  openstudio::model::SizingZone office1Sizing(model, office1Zone);
+  office1Zone.setName("Office 1 Zone");
+  office1Zone.setThermostatSetpointDualSetpoint(*thermostat);
+  office1->setThermalZone(office1Zone);
+  office1->setBuildingStory(story1);
+
+  openstudio::model::ThermalZone office2Zone(model);
+  openstudio::model::SizingZone office2Sizing(model, office2Zone);
+  office2Zone.setName("Office 2 Zone");
+  office2Zone.setThermostatSetpointDualSetpoint(*thermostat);
+  office2->setThermalZone(office2Zone);
+  office2->setBuildingStory(story1);
+
+  // add the air system
+  openstudio::model::Loop loop = openstudio::model::addSystemType3(model);
+  openstudio::model::AirLoopHVAC airLoop = loop.cast<openstudio::model::AirLoopHVAC>();
+  airLoop.addBranchForZone(libraryZone);
+  airLoop.addBranchForZone(office1Zone);
+  airLoop.addBranchForZone(office2Zone);
+
+  boost::optional<openstudio::model::SetpointManagerSingleZoneReheat> setpointManager;
+  BOOST_FOREACH(openstudio::model::SetpointManagerSingleZoneReheat t, 
+    model.getModelObjects<openstudio::model::SetpointManagerSingleZoneReheat>())
+  {
+    setpointManager = t;
+    break;
+  }
+  if(!setpointManager)
+  {
+    return boost::optional<openstudio::model::Model>();
+  }
+  setpointManager->setControlZone(libraryZone);
+
+  return boost::optional<openstudio::model::Model>(model);
+}
+
+// One story's floor prints at height z, in the same clockwise order as the
+// demo model, and which pairs of them share a wall
+struct FloorPlan
+{
+  std::vector<std::vector<openstudio::Point3d> > prints;
+  std::vector<std::pair<int,int> > neighbours;
+  int corridor; // Index of the corridor, -1 if there isn't one
+};
+
+static std::vector<openstudio::Point3d> rectangle(double x, double y, double width, double depth, double z)
+{
+  std::vector<openstudio::Point3d> points;
+  points.push_back(openstudio::Point3d(x,y,z));
+  points.push_back(openstudio::Point3d(x,y+depth,z));
+  points.push_back(openstudio::Point3d(x+width,y+depth,z));
+  points.push_back(openstudio::Point3d(x+width,y,z));
+  return points;
+}
+
+static FloorPlan floorPlan(const DemoModelSettings &settings, double z)
+{
+  FloorPlan plan;
+  plan.corridor = -1;
+  int n = settings.zonesPerStory;
+  double w = settings.zoneWidth;
+  double d = settings.zoneDepth;
+  if(settings.floorPlate == Bar)
+  {
+    for(int i=0;i<n;i++)
+    {
+      plan.prints.push_back(rectangle(i*w,0,w,d,z));
+      if(i > 0)
+      {
+        plan.neighbours.push_back(std::make_pair(i-1,i));
+      }
+    }
+  }
+  else if(settings.floorPlate == Grid)
+  {
+    int columns = (int)std::ceil(std::sqrt((double)n));
+    for(int i=0;i<n;i++)
+    {
+      int row = i/columns;
+      int column = i%columns;
+      plan.prints.push_back(rectangle(column*w,row*d,w,d,z));
+      if(column > 0)
+      {
+        plan.neighbours.push_back(std::make_pair(i-1,i));
+      }
+      if(row > 0)
+      {
+        plan.neighbours.push_back(std::make_pair(i-columns,i));
+      }
+    }
+  }
+  else
+  {
+    // The corridor comes first, then the offices on the south side (y up to
+    // d) and then the ones on the north side
+    double c = settings.corridorWidth;
+    int offices = n-1;
+    int north = (offices+1)/2;
+    int south = offices/2;
+    double length = north*w;
+    // The corridor walls get a vertex at every office corner, so that each
+    // office wall has a matching corridor wall
+    std::vector<openstudio::Point3d> points;
+    points.push_back(openstudio::Point3d(0,d,z));
+    for(int i=0;i<=north;i++)
+    {
+      points.push_back(openstudio::Point3d(i*w,d+c,z));
+    }
+    points.push_back(openstudio::Point3d(length,d,z));
+    for(int i=south;i>0;i--)
+    {
+      if(i*w < length)
+      {
+        points.push_back(openstudio::Point3d(i*w,d,z));
+      }
+    }
+    plan.prints.push_back(points);
+    plan.corridor = 0;
+    for(int i=0;i<south;i++)
+    {
+      plan.prints.push_back(rectangle(i*w,0,w,d,z));
+      plan.neighbours.push_back(std::make_pair(0,1+i));
+      if(i > 0)
+      {
+        plan.neighbours.push_back(std::make_pair(i,1+i));
+      }
+    }
+    for(int i=0;i<north;i++)
+    {
+      plan.prints.push_back(rectangle(i*w,d+c,w,d,z));
+      plan.neighbours.push_back(std::make_pair(0,1+south+i));
+      if(i > 0)
+      {
+        plan.neighbours.push_back(std::make_pair(south+i,1+south+i));
+      }
+    }
+  }
+  return plan;
+}
+
+boost::optional<openstudio::model::Model> buildScalableModel(openstudio::model::Model model,
+  const DemoModelSettings &settings)
+{
+  if(settings.stories < 1 || settings.zonesPerStory < (settings.floorPlate == Corridor ? 2 : 1))
+  {
+    return boost::optional<openstudio::model::Model>();
+  }
+  if(!setOutdoorAir(model))
+  {
+    return boost::optional<openstudio::model::Model>();
+  }
+  boost::optional<openstudio::model::ThermostatSetpointDualSetpoint> thermostat = findThermostat(model);
+  if(!thermostat)
+  {
+    return boost::optional<openstudio::model::Model>();
+  }
+
+  std::vector<openstudio::model::Space> below;
+  for(int k=0;k<settings.stories;k++)
+  {
+    double z = k*settings.floorHeight;
+    openstudio::model::BuildingStory story(model);
+    story.setName(QString("Story %1").arg(k+1).toStdString());
+    story.setNominalZCoordinate(z);
+    story.setNominalFloortoFloorHeight(settings.floorHeight);
+
+    FloorPlan plan = floorPlan(settings,z);
+    std::vector<openstudio::model::Space> spaces;
+    std::vector<openstudio::model::ThermalZone> conditioned;
+    for(unsigned i=0;i<plan.prints.size();i++)
+    {
+      boost::optional<openstudio::model::Space> space = openstudio::model::Space::fromFloorPrint(plan.prints[i],
+        settings.floorHeight,model);
+      if(!space)
+      {
+        return boost::optional<openstudio::model::Model>();
+      }
+      if((int)i == plan.corridor)
+      {
+        space->setName(QString("Story %1 Corridor").arg(k+1).toStdString());
+      }
+      else
+      {
+        space->setName(QString("Story %1 Office %2").arg(k+1).arg(plan.corridor < 0 ? i+1 : i).toStdString());
+      }
+      space->setBuildingStory(story);
+      openstudio::model::ThermalZone zone(model);
+      zone.setName(space->name().get() + " Zone");
+      // Like the demo model's hallway, the corridor is unconditioned
+      if((int)i != plan.corridor)
+      {
+        openstudio::model::SizingZone sizing(model,zone);
+        zone.setThermostatSetpointDualSetpoint(*thermostat);
+        conditioned.push_back(zone);
+      }
+      space->setThermalZone(zone);
+      spaces.push_back(*space);
+    }
+
+    // Only neighbours can share a wall, so only they need matching
+    for(unsigned i=0;i<plan.neighbours.size();i++)
+    {
+      spaces[plan.neighbours[i].first].matchSurfaces(spaces[plan.neighbours[i].second]);
+    }
+    // Every story has the same plan, so space i sits right on top of space i below
+    for(unsigned i=0;i<below.size();i++)
+    {
+      below[i].matchSurfaces(spaces[i]);
+    }
+    below = spaces;
+
+    if(settings.hvac && !conditioned.empty())
+    {
+      openstudio::model::Loop loop = openstudio::model::addSystemType3(model);
+      openstudio::model::AirLoopHVAC airLoop = loop.cast<openstudio::model::AirLoopHVAC>();
+      BOOST_FOREACH(openstudio::model::ThermalZone zone, conditioned)
+      {
+        airLoop.addBranchForZone(zone);
+      }
+      // The new system's setpoint manager is the one without a control zone
+      bool controlled = false;
+      BOOST_FOREACH(openstudio::model::SetpointManagerSingleZoneReheat t,
+        model.getModelObjects<openstudio::model::SetpointManagerSingleZoneReheat>())
+      {
+        if(!t.controlZone())
+        {
+          t.setControlZone(conditioned[0]);
+          controlled = true;
+          break;
+        }
+      }
+      if(!controlled)
+      {
+        return boost::optional<openstudio::model::Model>();
+      }
+    }
+  }
+
+  return boost::optional<openstudio::model::Model>(model);
+}
+
+} // contamutils
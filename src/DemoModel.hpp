@@ -0,0 +1,76 @@
+/**********************************************************************
+ *  Copyright (c) 2008-2010, Alliance for Sustainable Energy.
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_DEMOMODEL_HPP
+#define CONTAMUTILITIES_DEMOMODEL_HPP
+
+#include <model/Model.hpp>
+#include <utilities/core/Path.hpp>
+
+#include <boost/optional.hpp>
+
+#include <string>
+
+namespace contamutils {
+
+// How the zones on each story are laid out. Bar is a single row of zones,
+// Grid is rows and columns as near to square as they go, and Corridor is a
+// row of zones on each side of a corridor zone that runs the full length.
+enum FloorPlate {Bar, Grid, Corridor};
+
+// Parse "bar", "grid" or "corridor", false for anything else
+bool parseFloorPlate(const std::string &name, FloorPlate &floorPlate);
+
+struct DemoModelSettings
+{
+  DemoModelSettings();
+
+  int stories;
+  int zonesPerStory;      // Including the corridor, so at least 2 for Corridor
+  FloorPlate floorPlate;
+  double zoneWidth;       // Along the length of the building [m]
+  double zoneDepth;       // [m]
+  double corridorWidth;   // [m]
+  double floorHeight;     // [m]
+  bool hvac;              // One packaged single zone system per story
+};
+
+// The settings for a building of about zones zones, stories growing with the
+// square root of the zone count so that big models are tall as well as wide.
+// The zone count is rounded up to fill every story.
+DemoModelSettings scaledDemoModel(int zones, FloorPlate floorPlate);
+
+// Load the template the demo models are built on, from the given OSM or, if
+// that is empty or can't be loaded, from the copy built into the program
+boost::optional<openstudio::model::Model> loadDemoTemplate(const openstudio::path &path=openstudio::path());
+
+// The 4 space, 1 story demo model used in the OpenStudio tests
+boost::optional<openstudio::model::Model> buildDemoModel(openstudio::model::Model model);
+
+// A model of stories x zonesPerStory spaces with one thermal zone each. Each
+// space's surfaces are matched to its neighbours on the same story and to the
+// spaces above and below, so the translated model has the interior paths of a
+// real building and not just a pile of boxes.
+boost::optional<openstudio::model::Model> buildScalableModel(openstudio::model::Model model,
+  const DemoModelSettings &settings);
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_DEMOMODEL_HPP
@@ -0,0 +1,435 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "EpwToWth.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace contamutils {
+
+// Field positions in an EPW data record
+enum EpwField
+{
+  MONTH = 1,
+  DAY = 2,
+  HOUR = 3,
+  MINUTE = 4,
+  DRY_BULB = 6,
+  DEW_POINT = 7,
+  RELATIVE_HUMIDITY = 8,
+  PRESSURE = 9,
+  HORIZONTAL_IR = 12,
+  GLOBAL_HORIZONTAL = 13,
+  DIRECT_NORMAL = 14,
+  WIND_DIRECTION = 20,
+  WIND_SPEED = 21,
+  SNOW_DEPTH = 30,
+  LIQUID_PRECIPITATION = 33,
+  MAX_FIELDS = 35
+};
+
+static const int DAYS_IN_MONTH[] = {31,28,31,30,31,30,31,31,30,31,30,31};
+
+static std::string trim(const std::string &string)
+{
+  std::string::size_type start = string.find_first_not_of(" \t\r\n");
+  if(start == std::string::npos)
+  {
+    return std::string();
+  }
+  std::string::size_type end = string.find_last_not_of(" \t\r\n");
+  return string.substr(start,end-start+1);
+}
+
+static std::vector<std::string> splitHeader(const std::string &line)
+{
+  std::vector<std::string> fields;
+  std::stringstream stream(line);
+  std::string field;
+  while(std::getline(stream,field,','))
+  {
+    fields.push_back(trim(field));
+  }
+  return fields;
+}
+
+static bool startsWith(const std::string &string, const char *prefix)
+{
+  std::string::size_type n = std::strlen(prefix);
+  if(string.size() < n)
+  {
+    return false;
+  }
+  for(std::string::size_type i=0;i<n;i++)
+  {
+    if(std::toupper((unsigned char)string[i]) != prefix[i])
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool parseMonthDay(const std::string &string, int &month, int &day)
+{
+  // Dates look like "1/1", " 1/ 1" or "1/1/2015"
+  const char *ptr = string.c_str();
+  char *end;
+  month = std::strtol(ptr,&end,10);
+  if(end == ptr || *end != '/')
+  {
+    return false;
+  }
+  ptr = end+1;
+  day = std::strtol(ptr,&end,10);
+  if(end == ptr)
+  {
+    return false;
+  }
+  return month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
+static int dayOfWeek(const std::string &string)
+{
+  static const char *names[] = {"SUNDAY","MONDAY","TUESDAY","WEDNESDAY","THURSDAY","FRIDAY","SATURDAY"};
+  for(int i=0;i<7;i++)
+  {
+    if(startsWith(string,names[i]))
+    {
+      return i+1;
+    }
+  }
+  return 0;
+}
+
+// Saturation pressure of water vapor [Pa] from the Hyland-Wexler correlations
+static double saturationPressure(double T)
+{
+  if(T < 273.15)
+  {
+    return std::exp(-5.6745359e3/T + 6.3925247 - 9.677843e-3*T + 6.2215701e-7*T*T + 2.0747825e-9*T*T*T
+      - 9.484024e-13*T*T*T*T + 4.1635019*std::log(T));
+  }
+  return std::exp(-5.8002206e3/T + 1.3914993 - 4.8640239e-2*T + 4.1764768e-5*T*T - 1.4452093e-8*T*T*T
+    + 6.5459673*std::log(T));
+}
+
+EpwToWthConverter::EpwToWthConverter() : m_recordsPerHour(1), m_startDayOfWeek(1), m_startMonth(1), m_startDay(1),
+  m_endMonth(12), m_endDay(31), m_leapYear(false), m_records(0), m_lineNumber(0)
+{
+}
+
+const char *EpwToWthConverter::version()
+{
+  return "epw2wth-stream-1";
+}
+
+unsigned long EpwToWthConverter::records() const
+{
+  return m_records;
+}
+
+std::string EpwToWthConverter::errorMessage() const
+{
+  return m_error;
+}
+
+bool EpwToWthConverter::fail(const std::string &message)
+{
+  std::stringstream stream;
+  stream << message;
+  if(m_lineNumber > 0)
+  {
+    stream << " (line " << m_lineNumber << ")";
+  }
+  m_error = stream.str();
+  return false;
+}
+
+bool EpwToWthConverter::convert(const std::string &epwPath, const std::string &wthPath)
+{
+  std::ifstream epw(epwPath.c_str(),std::ios::in|std::ios::binary);
+  if(!epw.good())
+  {
+    m_lineNumber = 0;
+    return fail("Failed to open EPW file '" + epwPath + "'");
+  }
+  std::ofstream wth(wthPath.c_str(),std::ios::out|std::ios::binary);
+  if(!wth.good())
+  {
+    m_lineNumber = 0;
+    return fail("Failed to open WTH file '" + wthPath + "'");
+  }
+  return convert(epw,wth,"Translated from " + epwPath);
+}
+
+bool EpwToWthConverter::convert(std::istream &epw, std::ostream &wth, const std::string &description)
+{
+  m_records = 0;
+  m_lineNumber = 0;
+  m_error.clear();
+  if(!readHeader(epw))
+  {
+    return false;
+  }
+  if(!writeDays(wth,description))
+  {
+    return false;
+  }
+  wth << "!Date\tTime\tTa [K]\tPb [Pa]\tWs [m/s]\tWd [deg]\tHr [g/kg]\tIth [kJ/m^2]\tIdn [kJ/m^2]\tTs [K]\tRn [-]\tSn [-]\n";
+  // The line buffer is reused, so memory stays flat no matter how many records there are
+  std::string line;
+  while(std::getline(epw,line))
+  {
+    m_lineNumber++;
+    if(trim(line).empty())
+    {
+      continue;
+    }
+    if(!convertRecord(line.c_str(),wth))
+    {
+      return false;
+    }
+    m_records++;
+  }
+  if(m_records == 0)
+  {
+    return fail("No weather records found");
+  }
+  wth.flush();
+  if(!wth.good())
+  {
+    return fail("Failed to write WTH output");
+  }
+  return true;
+}
+
+bool EpwToWthConverter::readHeader(std::istream &epw)
+{
+  // There are always eight header lines, but the only ones that matter here
+  // are the holiday line (for the leap year flag) and the data periods
+  bool foundPeriods = false;
+  std::string line;
+  for(int i=0;i<8;i++)
+  {
+    if(!std::getline(epw,line))
+    {
+      return fail("Incomplete EPW header");
+    }
+    m_lineNumber++;
+    if(startsWith(line,"HOLIDAYS/DAYLIGHT SAVINGS"))
+    {
+      std::vector<std::string> fields = splitHeader(line);
+      m_leapYear = fields.size() > 1 && startsWith(fields[1],"Y");
+    }
+    else if(startsWith(line,"DATA PERIODS"))
+    {
+      std::vector<std::string> fields = splitHeader(line);
+      if(fields.size() < 7)
+      {
+        return fail("Malformed DATA PERIODS header");
+      }
+      if(std::atoi(fields[1].c_str()) != 1)
+      {
+        return fail("Only EPW files with a single data period are supported");
+      }
+      m_recordsPerHour = std::atoi(fields[2].c_str());
+      if(m_recordsPerHour < 1 || 60 % m_recordsPerHour != 0)
+      {
+        return fail("Bad number of records per hour '" + fields[2] + "'");
+      }
+      m_startDayOfWeek = dayOfWeek(fields[4]);
+      if(m_startDayOfWeek == 0)
+      {
+        return fail("Bad start day of week '" + fields[4] + "'");
+      }
+      if(!parseMonthDay(fields[5],m_startMonth,m_startDay) || !parseMonthDay(fields[6],m_endMonth,m_endDay))
+      {
+        return fail("Bad data period dates");
+      }
+      foundPeriods = true;
+    }
+  }
+  if(!foundPeriods)
+  {
+    return fail("No DATA PERIODS header found");
+  }
+  return true;
+}
+
+bool EpwToWthConverter::writeDays(std::ostream &wth, const std::string &description)
+{
+  char buffer[128];
+  wth << "WeatherFile ContamW 2.0\n";
+  wth << description << "\n";
+  std::sprintf(buffer,"%d/%d\t!start date\n",m_startMonth,m_startDay);
+  wth << buffer;
+  std::sprintf(buffer,"%d/%d\t!end date\n",m_endMonth,m_endDay);
+  wth << buffer;
+  wth << "!Date\tDofW\tDtype\tDST\tTgrnd [K]\n";
+  int month = m_startMonth;
+  int day = m_startDay;
+  int dow = m_startDayOfWeek;
+  // Guard against bad end dates by never going around more than once
+  for(int n=0;n<367;n++)
+  {
+    std::sprintf(buffer,"%d/%d\t%d\t%d\t0\t283.15\n",month,day,dow,dow);
+    wth << buffer;
+    if(month == m_endMonth && day == m_endDay)
+    {
+      return true;
+    }
+    dow = dow % 7 + 1;
+    int ndays = DAYS_IN_MONTH[month-1];
+    if(month == 2 && m_leapYear)
+    {
+      ndays = 29;
+    }
+    day++;
+    if(day > ndays)
+    {
+      day = 1;
+      month = month % 12 + 1;
+    }
+  }
+  return fail("Data period end date was never reached");
+}
+
+bool EpwToWthConverter::convertRecord(const char *line, std::ostream &wth)
+{
+  // Find the start of each field without copying anything
+  const char *fields[MAX_FIELDS];
+  int nfields = 0;
+  fields[nfields++] = line;
+  for(const char *ptr=line;*ptr && nfields<MAX_FIELDS;ptr++)
+  {
+    if(*ptr == ',')
+    {
+      fields[nfields++] = ptr+1;
+    }
+  }
+  if(nfields <= WIND_SPEED)
+  {
+    return fail("Too few fields in weather record");
+  }
+
+  int month = std::atoi(fields[MONTH]);
+  int day = std::atoi(fields[DAY]);
+  int hour = std::atoi(fields[HOUR]);
+  int minute = std::atoi(fields[MINUTE]);
+  if(m_recordsPerHour == 1)
+  {
+    // Hourly files are inconsistent about using 0 or 60 here, either way it's the end of the hour
+    minute = 60;
+  }
+  int minutes = (hour-1)*60 + minute;
+  if(month < 1 || month > 12 || day < 1 || day > 31 || minutes < 0 || minutes > 24*60)
+  {
+    return fail("Bad date or time in weather record");
+  }
+
+  double T = std::strtod(fields[DRY_BULB],0);
+  if(T >= 99.9)
+  {
+    return fail("Missing dry bulb temperature in weather record");
+  }
+  T += 273.15;
+  double P = std::strtod(fields[PRESSURE],0);
+  if(P >= 999999.0 || P <= 0.0)
+  {
+    P = 101325.0;
+  }
+  double windSpeed = std::strtod(fields[WIND_SPEED],0);
+  if(windSpeed >= 999.0 || windSpeed < 0.0)
+  {
+    windSpeed = 0.0;
+  }
+  double windDirection = std::strtod(fields[WIND_DIRECTION],0);
+  if(windDirection >= 999.0 || windDirection < 0.0)
+  {
+    windDirection = 0.0;
+  }
+
+  // Humidity ratio from the dew point if we have it, relative humidity if we don't
+  double pw = 0.0;
+  double dewPoint = std::strtod(fields[DEW_POINT],0);
+  if(dewPoint < 99.9)
+  {
+    pw = saturationPressure(dewPoint+273.15);
+  }
+  else
+  {
+    double rh = std::strtod(fields[RELATIVE_HUMIDITY],0);
+    if(rh < 999.0 && rh >= 0.0)
+    {
+      pw = 0.01*rh*saturationPressure(T);
+    }
+  }
+  double Hr = 0.0;
+  if(pw < P)
+  {
+    Hr = 1000.0*0.621945*pw/(P-pw);
+  }
+
+  // Radiation is in Wh/m^2, which becomes kJ/m^2
+  double Ith = std::strtod(fields[GLOBAL_HORIZONTAL],0);
+  if(Ith >= 9999.0 || Ith < 0.0)
+  {
+    Ith = 0.0;
+  }
+  double Idn = std::strtod(fields[DIRECT_NORMAL],0);
+  if(Idn >= 9999.0 || Idn < 0.0)
+  {
+    Idn = 0.0;
+  }
+  double Ts = T;
+  double ir = std::strtod(fields[HORIZONTAL_IR],0);
+  if(ir < 9999.0 && ir > 0.0)
+  {
+    Ts = std::pow(ir/5.6697e-8,0.25);
+  }
+
+  int rain = 0;
+  if(nfields > LIQUID_PRECIPITATION)
+  {
+    double depth = std::strtod(fields[LIQUID_PRECIPITATION],0);
+    rain = (depth > 0.0 && depth < 999.0) ? 1 : 0;
+  }
+  int snow = 0;
+  if(nfields > SNOW_DEPTH)
+  {
+    double depth = std::strtod(fields[SNOW_DEPTH],0);
+    snow = (depth > 0.0 && depth < 999.0) ? 1 : 0;
+  }
+
+  char buffer[256];
+  int n = std::sprintf(buffer,"%d/%d\t%02d:%02d:00\t%.2f\t%.0f\t%.2f\t%.0f\t%.3f\t%.1f\t%.1f\t%.2f\t%d\t%d\n",
+    month,day,minutes/60,minutes%60,T,P,windSpeed,windDirection,Hr,3.6*Ith,3.6*Idn,Ts,rain,snow);
+  wth.write(buffer,n);
+  return true;
+}
+
+} // contamutils
@@ -0,0 +1,67 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_EPWTOWTH_HPP
+#define CONTAMUTILITIES_EPWTOWTH_HPP
+
+#include <iosfwd>
+#include <string>
+
+namespace contamutils {
+
+// Streaming EPW to CONTAM WTH conversion. The EPW header is read to get the
+// data period, then the records are converted one line at a time, so memory
+// use doesn't depend on the length of the file. Only the fields that go into
+// the WTH file are parsed.
+class EpwToWthConverter
+{
+public:
+  EpwToWthConverter();
+
+  bool convert(const std::string &epwPath, const std::string &wthPath);
+  bool convert(std::istream &epw, std::ostream &wth, const std::string &description);
+
+  // Number of weather records written by the last conversion
+  unsigned long records() const;
+  std::string errorMessage() const;
+
+  // Bump this whenever the output changes, anything that caches WTH files should key on it
+  static const char *version();
+
+private:
+  bool readHeader(std::istream &epw);
+  bool writeDays(std::ostream &wth, const std::string &description);
+  bool convertRecord(const char *line, std::ostream &wth);
+  bool fail(const std::string &message);
+
+  int m_recordsPerHour;
+  int m_startDayOfWeek;
+  int m_startMonth;
+  int m_startDay;
+  int m_endMonth;
+  int m_endDay;
+  bool m_leapYear;
+  unsigned long m_records;
+  unsigned long m_lineNumber;
+  std::string m_error;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_EPWTOWTH_HPP
@@ -0,0 +1,237 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "FileLocator.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace contamutils {
+
+static const char *SIDECAR_HEADER = "FileLocatorIndex 1";
+
+FileLocator::FileLocator(const openstudio::path &base, int maxDepth) : m_base(base), m_maxDepth(maxDepth),
+  m_verbose(false), m_useSidecar(true), m_indexed(false), m_fresh(false)
+{
+}
+
+const char *FileLocator::sidecarName()
+{
+  return ".contam-file-index";
+}
+
+void FileLocator::addPreferredDirectory(const std::string &relativePath)
+{
+  m_preferred.push_back(relativePath);
+}
+
+void FileLocator::setVerbose(bool verbose)
+{
+  m_verbose = verbose;
+}
+
+void FileLocator::setUseSidecar(bool useSidecar)
+{
+  m_useSidecar = useSidecar;
+}
+
+boost::optional<openstudio::path> FileLocator::find(const std::string &filename)
+{
+  if(!boost::filesystem::is_directory(m_base))
+  {
+    return boost::none;
+  }
+  // Check the name as given and then the preferred locations, these are cheap
+  openstudio::path given = openstudio::toPath(filename);
+  openstudio::path filepath = m_base / given;
+  if(m_verbose)
+  {
+    std::cout << "Looking for " << openstudio::toString(filepath) << std::endl;
+  }
+  if(boost::filesystem::is_regular_file(filepath))
+  {
+    return boost::optional<openstudio::path>(filepath);
+  }
+  std::string name = given.filename().string();
+  for(unsigned i=0;i<m_preferred.size();i++)
+  {
+    filepath = m_base / openstudio::toPath(m_preferred[i]) / openstudio::toPath(name);
+    if(m_verbose)
+    {
+      std::cout << "Looking for " << openstudio::toString(filepath) << std::endl;
+    }
+    if(boost::filesystem::is_regular_file(filepath))
+    {
+      return boost::optional<openstudio::path>(filepath);
+    }
+  }
+
+  if(!m_indexed)
+  {
+    if(!(m_useSidecar && loadSidecar()))
+    {
+      buildIndex();
+    }
+  }
+  boost::optional<openstudio::path> found = lookup(name);
+  if(!found && !m_fresh)
+  {
+    // The saved index may be out of date, so look again before giving up
+    buildIndex();
+    found = lookup(name);
+  }
+  if(m_verbose)
+  {
+    if(found)
+    {
+      std::cout << "Found " << openstudio::toString(*found) << std::endl;
+    }
+    else
+    {
+      std::cout << "Failed to find " << name << " below " << openstudio::toString(m_base) << std::endl;
+    }
+  }
+  return found;
+}
+
+boost::optional<openstudio::path> FileLocator::lookup(const std::string &name) const
+{
+  std::map<std::string,std::string>::const_iterator iter = m_index.find(name);
+  if(iter == m_index.end())
+  {
+    return boost::none;
+  }
+  openstudio::path path = m_base / openstudio::toPath(iter->second);
+  if(!boost::filesystem::is_regular_file(path))
+  {
+    return boost::none;
+  }
+  return boost::optional<openstudio::path>(path);
+}
+
+void FileLocator::buildIndex()
+{
+  m_index.clear();
+  // Breadth first, so the shallowest copy of a name wins, and sorted within a
+  // directory so that the answer doesn't depend on the file system
+  std::deque<std::pair<openstudio::path,int> > queue;
+  queue.push_back(std::make_pair(openstudio::path(),0));
+  while(!queue.empty())
+  {
+    openstudio::path relative = queue.front().first;
+    int depth = queue.front().second;
+    queue.pop_front();
+    std::vector<openstudio::path> entries;
+    boost::system::error_code ec;
+    boost::filesystem::directory_iterator iter(m_base / relative,ec);
+    boost::filesystem::directory_iterator end;
+    for(;!ec && iter!=end;iter.increment(ec))
+    {
+      entries.push_back(iter->path());
+    }
+    std::sort(entries.begin(),entries.end());
+    for(unsigned i=0;i<entries.size();i++)
+    {
+      openstudio::path entryRelative = relative / entries[i].filename();
+      if(boost::filesystem::is_directory(entries[i]))
+      {
+        if(m_maxDepth < 0 || depth < m_maxDepth)
+        {
+          queue.push_back(std::make_pair(entryRelative,depth+1));
+        }
+      }
+      else
+      {
+        std::string name = entries[i].filename().string();
+        if(m_index.find(name) == m_index.end() && name != sidecarName())
+        {
+          m_index[name] = entryRelative.string();
+        }
+      }
+    }
+  }
+  m_indexed = true;
+  m_fresh = true;
+  if(m_useSidecar)
+  {
+    saveSidecar();
+  }
+}
+
+bool FileLocator::loadSidecar()
+{
+  openstudio::path sidecar = m_base / openstudio::toPath(sidecarName());
+  std::ifstream file(openstudio::toString(sidecar).c_str());
+  if(!file.good())
+  {
+    return false;
+  }
+  std::string line;
+  if(!std::getline(file,line) || line != SIDECAR_HEADER)
+  {
+    return false;
+  }
+  // The depth limit has to match, or the index could be missing things
+  if(!std::getline(file,line))
+  {
+    return false;
+  }
+  std::stringstream depth;
+  depth << m_maxDepth;
+  if(line != depth.str())
+  {
+    return false;
+  }
+  m_index.clear();
+  while(std::getline(file,line))
+  {
+    std::string::size_type tab = line.find('\t');
+    if(tab != std::string::npos)
+    {
+      m_index[line.substr(0,tab)] = line.substr(tab+1);
+    }
+  }
+  m_indexed = true;
+  m_fresh = false;
+  return true;
+}
+
+void FileLocator::saveSidecar() const
+{
+  openstudio::path sidecar = m_base / openstudio::toPath(sidecarName());
+  std::ofstream file(openstudio::toString(sidecar).c_str(),std::ios::out|std::ios::trunc);
+  if(!file.good())
+  {
+    // Read-only directories just don't get a sidecar
+    return;
+  }
+  file << SIDECAR_HEADER << std::endl;
+  file << m_maxDepth << std::endl;
+  for(std::map<std::string,std::string>::const_iterator iter=m_index.begin();iter!=m_index.end();++iter)
+  {
+    file << iter->first << '\t' << iter->second << std::endl;
+  }
+}
+
+} // contamutils
@@ -0,0 +1,75 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_FILELOCATOR_HPP
+#define CONTAMUTILITIES_FILELOCATOR_HPP
+
+#include <utilities/core/Path.hpp>
+
+#include <boost/optional.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace contamutils {
+
+// Find files by name somewhere below a base directory. The directory tree is
+// walked once (breadth first, optionally to a limited depth) to build a name
+// to path index that is used for every lookup after that. Preferred
+// directories (like the "run" directory of a simulation) are checked before
+// the index. The index is saved to a small sidecar file in the base directory
+// and reused by later runs: hits from a saved index are checked to still
+// exist, and a miss causes one rebuild before giving up.
+class FileLocator
+{
+public:
+  explicit FileLocator(const openstudio::path &base, int maxDepth=-1);
+
+  // Directories relative to the base that are checked first, in order
+  void addPreferredDirectory(const std::string &relativePath);
+  void setVerbose(bool verbose);
+  // Turn the sidecar file on or off (default: on)
+  void setUseSidecar(bool useSidecar);
+
+  boost::optional<openstudio::path> find(const std::string &filename);
+
+  // Name of the sidecar index file written into the base directory
+  static const char *sidecarName();
+
+private:
+  bool loadSidecar();
+  void saveSidecar() const;
+  void buildIndex();
+  boost::optional<openstudio::path> lookup(const std::string &name) const;
+
+  openstudio::path m_base;
+  int m_maxDepth;
+  bool m_verbose;
+  bool m_useSidecar;
+  bool m_indexed;
+  bool m_fresh;
+  std::vector<std::string> m_preferred;
+  // File name -> path relative to the base, shallowest first
+  std::map<std::string,std::string> m_index;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_FILELOCATOR_HPP
@@ -0,0 +1,83 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "FlowConversion.hpp"
+
+namespace contamutils {
+
+// Grid and report times that are within this many days (about 0.01 s) of each
+// other are the same time
+static const double TIME_TOLERANCE = 1.0e-7;
+
+void sampleOntoGrid(const double *days, const double *values, std::size_t count, double offset,
+  double step, std::size_t steps, double *out, double outOfRange)
+{
+  std::size_t j = 0;
+  for(std::size_t i=0;i<steps;i++)
+  {
+    double t = (i+1)*step - offset - TIME_TOLERANCE;
+    while(j < count && days[j] < t)
+    {
+      j++;
+    }
+    out[i] = j < count ? values[j] : outOfRange;
+  }
+}
+
+void volumeFlowFactors(const double *P, const double *T, std::size_t steps, double *factor)
+{
+  for(std::size_t i=0;i<steps;i++)
+  {
+    factor[i] = DRY_AIR_GAS_CONSTANT*T[i]/P[i];
+  }
+}
+
+void massToVolumeFlow(const double *mass, std::size_t zones, std::size_t steps, const double *factor,
+  double *volume)
+{
+  for(std::size_t z=0;z<zones;z++)
+  {
+    const double *in = mass + z*steps;
+    double *out = volume + z*steps;
+    for(std::size_t i=0;i<steps;i++)
+    {
+      out[i] = in[i]*factor[i];
+    }
+  }
+}
+
+void accumulateRows(const double *rows, std::size_t count, std::size_t steps, const int *target,
+  std::size_t targets, double *out)
+{
+  for(std::size_t r=0;r<count;r++)
+  {
+    if(target[r] < 0 || (std::size_t)target[r] >= targets)
+    {
+      continue;
+    }
+    const double *in = rows + r*steps;
+    double *sum = out + target[r]*steps;
+    for(std::size_t i=0;i<steps;i++)
+    {
+      sum[i] += in[i];
+    }
+  }
+}
+
+} // contamutils
@@ -0,0 +1,60 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_FLOWCONVERSION_HPP
+#define CONTAMUTILITIES_FLOWCONVERSION_HPP
+
+#include <cstddef>
+
+namespace contamutils {
+
+// Gas constant of dry air [J/kg/K]
+const double DRY_AIR_GAS_CONSTANT = 287.058;
+
+// Schedule values are computed on a uniform grid: step i is at (i+1)*step
+// days after the start of the simulation, just like stepping a DateTime from
+// start+delta to the end. Everything here works on plain contiguous arrays so
+// the inner loops are simple enough for the compiler to vectorize.
+
+// Sample a series onto the grid in a single pass. The series times are in
+// days from its first report, which is offset days after the grid start, and
+// must be increasing. Each grid step gets the value of the first report at or
+// after it; steps after the last report get outOfRange.
+void sampleOntoGrid(const double *days, const double *values, std::size_t count, double offset,
+  double step, std::size_t steps, double *out, double outOfRange=0.0);
+
+// The mass to volume flow factor R*T/P for each step, T in K and P in Pa
+void volumeFlowFactors(const double *P, const double *T, std::size_t steps, double *factor);
+
+// Convert a zone-major matrix of mass flows [kg/s] into volume flows [m^3/s],
+// volume[z*steps+i] = mass[z*steps+i]*factor[i]. The two may be the same array.
+void massToVolumeFlow(const double *mass, std::size_t zones, std::size_t steps, const double *factor,
+  double *volume);
+
+// Add rows of a row-major matrix (count rows of steps values each) into the
+// rows of out (targets rows of steps values). Row r is added to row target[r],
+// rows with a negative target are skipped. This is a sparse incidence matrix
+// with one nonzero per row, like surfaces (or paths) that each belong to one
+// space, applied in place with no temporaries.
+void accumulateRows(const double *rows, std::size_t count, std::size_t steps, const int *target,
+  std::size_t targets, double *out);
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_FLOWCONVERSION_HPP
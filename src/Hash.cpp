@@ -0,0 +1,63 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "Hash.hpp"
+
+#include <fstream>
+
+namespace contamutils {
+
+void fnv1a(boost::uint64_t &hash, const char *data, std::size_t n)
+{
+  for(std::size_t i=0;i<n;i++)
+  {
+    hash ^= (unsigned char)data[i];
+    hash *= 1099511628211ULL;
+  }
+}
+
+void fnv1a(boost::uint64_t &hash, const std::string &data)
+{
+  fnv1a(hash,data.data(),data.size());
+}
+
+bool fnv1aFile(boost::uint64_t &hash, const std::string &path, boost::uint64_t &size)
+{
+  std::ifstream file(path.c_str(),std::ios::in|std::ios::binary);
+  if(!file.good())
+  {
+    return false;
+  }
+  char buffer[65536];
+  size = 0;
+  while(file)
+  {
+    file.read(buffer,sizeof(buffer));
+    std::streamsize n = file.gcount();
+    if(n <= 0)
+    {
+      break;
+    }
+    fnv1a(hash,buffer,(std::size_t)n);
+    size += n;
+  }
+  return true;
+}
+
+} // contamutils
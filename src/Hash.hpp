@@ -0,0 +1,40 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_HASH_HPP
+#define CONTAMUTILITIES_HASH_HPP
+
+#include <boost/cstdint.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace contamutils {
+
+// 64-bit FNV-1a, which is plenty to tell input files apart
+const boost::uint64_t FNV1A_BASIS = 14695981039346656037ULL;
+
+void fnv1a(boost::uint64_t &hash, const char *data, std::size_t n);
+void fnv1a(boost::uint64_t &hash, const std::string &data);
+// Hash the contents of a file, false if it can't be read
+bool fnv1aFile(boost::uint64_t &hash, const std::string &path, boost::uint64_t &size);
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_HASH_HPP
@@ -0,0 +1,348 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "InfiltrationFile.hpp"
+
+#include <boost/static_assert.hpp>
+
+#include <cstring>
+
+namespace contamutils {
+
+static const boost::uint32_t FORMAT_VERSION = 2;
+static const boost::uint32_t BYTE_ORDER_MARK = 0x01020304;
+static const std::size_t HEADER_SIZE = 96;
+static const std::size_t UNITS_SIZE = 24;
+
+struct InfiltrationFileHeader
+{
+  char magic[8];
+  boost::uint32_t version;
+  boost::uint32_t byteOrder;
+  boost::uint32_t columnCount;
+  boost::uint32_t reserved;
+  boost::uint64_t rowCount;
+  boost::uint64_t dataOffset;
+  double timestep;
+  boost::int32_t start[6];
+  char units[UNITS_SIZE];
+};
+BOOST_STATIC_ASSERT(sizeof(InfiltrationFileHeader) == HEADER_SIZE);
+
+InfiltrationStart::InfiltrationStart() : year(0), month(1), day(1), hour(0), minute(0), second(0)
+{
+}
+
+InfiltrationStart::InfiltrationStart(int year, int month, int day, int hour, int minute, int second)
+  : year(year), month(month), day(day), hour(hour), minute(minute), second(second)
+{
+}
+
+InfiltrationFileWriter::InfiltrationFileWriter(const InfiltrationStart &start, double timestep, const std::string &units)
+  : m_start(start), m_timestep(timestep), m_units(units), m_rows(0)
+{
+}
+
+bool InfiltrationFileWriter::open(const std::string &path)
+{
+  if(m_file.is_open())
+  {
+    m_file.close();
+  }
+  m_path = path;
+  m_rows = 0;
+  m_names.clear();
+  m_error.clear();
+  m_file.clear();
+  m_file.open(path.c_str(),std::ios::out|std::ios::binary|std::ios::trunc);
+  if(!m_file.good())
+  {
+    m_error = "Failed to open '" + path + "' for writing";
+    return false;
+  }
+  // Hold the place of the header, it is filled in once the columns are known
+  InfiltrationFileHeader header;
+  std::memset(&header,0,sizeof(header));
+  m_file.write((const char*)&header,sizeof(header));
+  return true;
+}
+
+bool InfiltrationFileWriter::isOpen() const
+{
+  return m_file.is_open();
+}
+
+bool InfiltrationFileWriter::addColumn(const std::string &name, const std::vector<double> &values)
+{
+  return addColumn(name,values.empty() ? 0 : &values[0],values.size());
+}
+
+bool InfiltrationFileWriter::addColumn(const std::string &name, const double *values, std::size_t count)
+{
+  if(!m_file.is_open())
+  {
+    m_error = "No file is open for column '" + name + "'";
+    return false;
+  }
+  if(!m_names.empty() && count != m_rows)
+  {
+    m_error = "Column '" + name + "' has a different length than the others";
+    return false;
+  }
+  if(count)
+  {
+    m_file.write((const char*)values,count*sizeof(double));
+  }
+  if(!m_file)
+  {
+    m_error = "Failed to write column '" + name + "' to '" + m_path + "'";
+    return false;
+  }
+  m_rows = count;
+  m_names.push_back(name);
+  return true;
+}
+
+unsigned InfiltrationFileWriter::columnCount() const
+{
+  return m_names.size();
+}
+
+std::string InfiltrationFileWriter::errorMessage() const
+{
+  return m_error;
+}
+
+bool InfiltrationFileWriter::close()
+{
+  if(!m_file.is_open())
+  {
+    m_error = "No file is open";
+    return false;
+  }
+  InfiltrationFileHeader header;
+  std::memset(&header,0,sizeof(header));
+  std::memcpy(header.magic,InfiltrationFile::magic(),8);
+  header.version = FORMAT_VERSION;
+  header.byteOrder = BYTE_ORDER_MARK;
+  header.columnCount = m_names.size();
+  header.rowCount = m_rows;
+  header.dataOffset = HEADER_SIZE;
+  header.timestep = m_timestep;
+  header.start[0] = m_start.year;
+  header.start[1] = m_start.month;
+  header.start[2] = m_start.day;
+  header.start[3] = m_start.hour;
+  header.start[4] = m_start.minute;
+  header.start[5] = m_start.second;
+  std::strncpy(header.units,m_units.c_str(),UNITS_SIZE-1);
+
+  // The columns are already in place, so the names go on the end
+  for(unsigned i=0;i<m_names.size();i++)
+  {
+    boost::uint32_t length = m_names[i].size();
+    m_file.write((const char*)&length,sizeof(length));
+    m_file.write(m_names[i].data(),length);
+  }
+  m_file.seekp(0);
+  m_file.write((const char*)&header,sizeof(header));
+  m_file.close();
+  if(!m_file)
+  {
+    m_error = "Failed to write '" + m_path + "'";
+    return false;
+  }
+  return true;
+}
+
+InfiltrationFile::InfiltrationFile() : m_data(0), m_rows(0), m_dataOffset(0), m_timestep(0)
+{
+}
+
+InfiltrationFile::InfiltrationFile(const std::string &path) : m_data(0), m_rows(0), m_dataOffset(0), m_timestep(0)
+{
+  open(path);
+}
+
+const char *InfiltrationFile::magic()
+{
+  return "CXINFBIN";
+}
+
+bool InfiltrationFile::fail(const std::string &message)
+{
+  close();
+  m_error = message;
+  return false;
+}
+
+bool InfiltrationFile::open(const std::string &path)
+{
+  close();
+  m_error.clear();
+  try
+  {
+    boost::interprocess::file_mapping mapping(path.c_str(),boost::interprocess::read_only);
+    boost::interprocess::mapped_region region(mapping,boost::interprocess::read_only);
+    m_mapping.swap(mapping);
+    m_region.swap(region);
+  }
+  catch(const boost::interprocess::interprocess_exception &exc)
+  {
+    return fail("Failed to map '" + path + "': " + exc.what());
+  }
+  m_data = static_cast<const char*>(m_region.get_address());
+  std::size_t size = m_region.get_size();
+  if(size < HEADER_SIZE)
+  {
+    return fail("'" + path + "' is too short to be an infiltration file");
+  }
+  InfiltrationFileHeader header;
+  std::memcpy(&header,m_data,sizeof(header));
+  if(std::memcmp(header.magic,magic(),8))
+  {
+    return fail("'" + path + "' is not an infiltration file");
+  }
+  if(header.byteOrder != BYTE_ORDER_MARK)
+  {
+    return fail("'" + path + "' was written on a machine with a different byte order");
+  }
+  if(header.version != FORMAT_VERSION)
+  {
+    return fail("'" + path + "' has an unsupported format version");
+  }
+  if(header.dataOffset < HEADER_SIZE || header.dataOffset%8 || header.dataOffset > size
+    || (header.columnCount && header.rowCount > (size - header.dataOffset)/sizeof(double)/header.columnCount))
+  {
+    return fail("'" + path + "' is truncated or has a bad data offset");
+  }
+  // Read the names that follow the columns, keeping an eye on the end of the file
+  std::size_t pos = header.dataOffset + header.columnCount*header.rowCount*sizeof(double);
+  for(unsigned i=0;i<header.columnCount;i++)
+  {
+    boost::uint32_t length;
+    if(pos + sizeof(length) > size)
+    {
+      return fail("'" + path + "' is truncated");
+    }
+    std::memcpy(&length,m_data+pos,sizeof(length));
+    pos += sizeof(length);
+    if(pos + length > size)
+    {
+      return fail("'" + path + "' is truncated");
+    }
+    m_names.push_back(std::string(m_data+pos,length));
+    pos += length;
+  }
+  m_rows = header.rowCount;
+  m_dataOffset = header.dataOffset;
+  m_timestep = header.timestep;
+  m_start = InfiltrationStart(header.start[0],header.start[1],header.start[2],header.start[3],header.start[4],header.start[5]);
+  header.units[UNITS_SIZE-1] = '\0';
+  m_units = header.units;
+  return true;
+}
+
+void InfiltrationFile::close()
+{
+  boost::interprocess::mapped_region region;
+  boost::interprocess::file_mapping mapping;
+  m_region.swap(region);
+  m_mapping.swap(mapping);
+  m_data = 0;
+  m_rows = 0;
+  m_dataOffset = 0;
+  m_timestep = 0;
+  m_start = InfiltrationStart();
+  m_units.clear();
+  m_names.clear();
+}
+
+bool InfiltrationFile::isOpen() const
+{
+  return m_data != 0;
+}
+
+unsigned InfiltrationFile::columnCount() const
+{
+  return m_names.size();
+}
+
+boost::uint64_t InfiltrationFile::rowCount() const
+{
+  return m_rows;
+}
+
+double InfiltrationFile::timestep() const
+{
+  return m_timestep;
+}
+
+InfiltrationStart InfiltrationFile::start() const
+{
+  return m_start;
+}
+
+std::string InfiltrationFile::units() const
+{
+  return m_units;
+}
+
+const std::vector<std::string> &InfiltrationFile::names() const
+{
+  return m_names;
+}
+
+int InfiltrationFile::columnIndex(const std::string &name) const
+{
+  for(unsigned i=0;i<m_names.size();i++)
+  {
+    if(m_names[i] == name)
+    {
+      return i;
+    }
+  }
+  return -1;
+}
+
+const double *InfiltrationFile::column(unsigned index) const
+{
+  if(!m_data || index >= m_names.size())
+  {
+    return 0;
+  }
+  return reinterpret_cast<const double*>(m_data + m_dataOffset + index*m_rows*sizeof(double));
+}
+
+const double *InfiltrationFile::column(const std::string &name) const
+{
+  int index = columnIndex(name);
+  if(index < 0)
+  {
+    return 0;
+  }
+  return column(index);
+}
+
+std::string InfiltrationFile::errorMessage() const
+{
+  return m_error;
+}
+
+} // contamutils
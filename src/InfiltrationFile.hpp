@@ -0,0 +1,140 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_INFILTRATIONFILE_HPP
+#define CONTAMUTILITIES_INFILTRATIONFILE_HPP
+
+#include <boost/cstdint.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace contamutils {
+
+// Binary infiltration results. The file is a fixed header, one contiguous
+// block of native float64 values per column, starting on an 8-byte boundary,
+// and then the column names. Mapping the file into memory makes every column an
+// ordinary array, so reading one zone is a pointer offset and not a parse. The
+// names come last so that the columns can be written as they are produced.
+//
+//   offset  size  contents
+//        0     8  magic "CXINFBIN"
+//        8     4  format version (2)
+//       12     4  byte order mark 0x01020304, written natively
+//       16     4  number of columns
+//       20     4  reserved (0)
+//       24     8  number of rows (values per column)
+//       32     8  offset of the first column from the start of the file
+//       40     8  timestep [s]
+//       48    24  time of the first row: year, month, day, hour, minute, second (int32)
+//       72    24  units, nul padded
+//  dataOffset  -  columns, each (number of rows)*8 bytes
+//           -  -  for each column: uint32 name length followed by the name
+struct InfiltrationStart
+{
+  InfiltrationStart();
+  InfiltrationStart(int year, int month, int day, int hour=0, int minute=0, int second=0);
+
+  int year;
+  int month;
+  int day;
+  int hour;
+  int minute;
+  int second;
+};
+
+// Write named columns of equal length straight to the file as they are added,
+// so the writer never holds a copy of the values. The header and the names are
+// written by close(); a file that is never closed has no magic and won't open.
+class InfiltrationFileWriter
+{
+public:
+  InfiltrationFileWriter(const InfiltrationStart &start, double timestep, const std::string &units="m3/s");
+
+  bool open(const std::string &path);
+  bool isOpen() const;
+  // Every column has to have the same number of values as the first one
+  bool addColumn(const std::string &name, const std::vector<double> &values);
+  bool addColumn(const std::string &name, const double *values, std::size_t count);
+  bool close();
+
+  unsigned columnCount() const;
+  std::string errorMessage() const;
+
+private:
+  InfiltrationStart m_start;
+  double m_timestep;
+  std::string m_units;
+  std::string m_path;
+  std::ofstream m_file;
+  boost::uint64_t m_rows;
+  std::vector<std::string> m_names;
+  std::string m_error;
+};
+
+// Read-only, memory mapped access to a binary infiltration file. Pointers
+// returned by column() are valid until the file is closed or destroyed.
+class InfiltrationFile
+{
+public:
+  InfiltrationFile();
+  explicit InfiltrationFile(const std::string &path);
+
+  bool open(const std::string &path);
+  void close();
+  bool isOpen() const;
+
+  unsigned columnCount() const;
+  boost::uint64_t rowCount() const;
+  double timestep() const;
+  InfiltrationStart start() const;
+  std::string units() const;
+  const std::vector<std::string> &names() const;
+
+  // Index of the named column, -1 if there isn't one
+  int columnIndex(const std::string &name) const;
+  const double *column(unsigned index) const;
+  const double *column(const std::string &name) const;
+
+  std::string errorMessage() const;
+
+  static const char *magic();
+
+private:
+  bool fail(const std::string &message);
+
+  boost::interprocess::file_mapping m_mapping;
+  boost::interprocess::mapped_region m_region;
+  const char *m_data;
+  boost::uint64_t m_rows;
+  boost::uint64_t m_dataOffset;
+  double m_timestep;
+  InfiltrationStart m_start;
+  std::string m_units;
+  std::vector<std::string> m_names;
+  std::string m_error;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_INFILTRATIONFILE_HPP
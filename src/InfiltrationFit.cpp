@@ -0,0 +1,115 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "InfiltrationFit.hpp"
+
+#include <cmath>
+#include <vector>
+
+namespace contamutils {
+
+// A pivot smaller than this fraction of its diagonal entry means the column
+// is (nearly) a combination of the ones before it
+static const double PIVOT_TOLERANCE = 1.0e-10;
+
+// One step of the Cholesky factorization: the pivot that is left after the
+// earlier columns are taken out, or zero if the column should be dropped
+static inline double pivot(double diagonal, double remainder)
+{
+  return remainder > PIVOT_TOLERANCE*diagonal ? std::sqrt(remainder) : 0.0;
+}
+
+void fitInfiltration(const double *speeds, const double *deltaT, const double *flows, std::size_t rows,
+  std::size_t zones, double *b, double *c, double *d, double *residual)
+{
+  // The unknowns are ordered (c, d, b) so that the temperature term is the
+  // one dropped when it adds nothing. The speed-only entries are the same
+  // for every zone.
+  double n00 = 0.0, n01 = 0.0, n11 = 0.0;
+  std::vector<double> n02(zones,0.0), n12(zones,0.0), n22(zones,0.0);
+  std::vector<double> g0(zones,0.0), g1(zones,0.0), g2(zones,0.0);
+  for(std::size_t r=0;r<rows;r++)
+  {
+    double u = speeds[r];
+    double u2 = u*u;
+    n00 += u*u;
+    n01 += u*u2;
+    n11 += u2*u2;
+    const double *t = deltaT + r*zones;
+    const double *q = flows + r*zones;
+    for(std::size_t z=0;z<zones;z++)
+    {
+      n02[z] += u*t[z];
+      n12[z] += u2*t[z];
+      n22[z] += t[z]*t[z];
+      g0[z] += u*q[z];
+      g1[z] += u2*q[z];
+      g2[z] += t[z]*q[z];
+    }
+  }
+
+  // Factor and solve each zone's system. A dropped column gets a unit pivot
+  // and no coupling, which makes its coefficient come out zero.
+  double l00 = pivot(n00,n00);
+  bool keep0 = l00 > 0.0;
+  l00 = keep0 ? l00 : 1.0;
+  double l10 = keep0 ? n01/l00 : 0.0;
+  double l11 = pivot(n11,n11-l10*l10);
+  bool keep1 = l11 > 0.0;
+  l11 = keep1 ? l11 : 1.0;
+  for(std::size_t z=0;z<zones;z++)
+  {
+    double l20 = keep0 ? n02[z]/l00 : 0.0;
+    double l21 = keep1 ? (n12[z]-l20*l10)/l11 : 0.0;
+    double l22 = pivot(n22[z],n22[z]-l20*l20-l21*l21);
+    bool keep2 = l22 > 0.0;
+    l22 = keep2 ? l22 : 1.0;
+    l20 = keep2 ? l20 : 0.0;
+    l21 = keep2 ? l21 : 0.0;
+    // Forward substitution
+    double y0 = keep0 ? g0[z]/l00 : 0.0;
+    double y1 = keep1 ? (g1[z]-l10*y0)/l11 : 0.0;
+    double y2 = keep2 ? (g2[z]-l20*y0-l21*y1)/l22 : 0.0;
+    // Back substitution
+    b[z] = y2/l22;
+    d[z] = (y1-l21*b[z])/l11;
+    c[z] = (y0-l10*d[z]-l20*b[z])/l00;
+    residual[z] = 0.0;
+  }
+
+  for(std::size_t r=0;r<rows;r++)
+  {
+    double u = speeds[r];
+    double u2 = u*u;
+    const double *t = deltaT + r*zones;
+    const double *q = flows + r*zones;
+    for(std::size_t z=0;z<zones;z++)
+    {
+      double e = q[z] - (b[z]*t[z] + c[z]*u + d[z]*u2);
+      residual[z] += e*e;
+    }
+  }
+  double scale = rows > 0 ? 1.0/(double)rows : 0.0;
+  for(std::size_t z=0;z<zones;z++)
+  {
+    residual[z] = std::sqrt(residual[z]*scale);
+  }
+}
+
+} // contamutils
@@ -0,0 +1,44 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_INFILTRATIONFIT_HPP
+#define CONTAMUTILITIES_INFILTRATIONFIT_HPP
+
+#include <cstddef>
+
+namespace contamutils {
+
+// Least-squares fit of the design flow rate form Q = b*|dT| + c*U + d*U^2 for
+// every zone at once. The samples are rows (one per simulated condition) of
+// zone values, stored row-major: the wind speed U is the same for all the
+// zones in a row, the temperature difference dT and the infiltration Q are
+// not. The 3x3 normal equations are accumulated and solved for all the zones
+// together, on plain arrays like the flow conversions, so the fit stays cheap
+// however many rows there are. A coefficient the samples can't tell apart from
+// the others (b with no stack-driven rows, or d with only one speed) is left
+// at zero rather than blowing up.
+//
+// speeds[rows], deltaT[rows*zones], flows[rows*zones]; b, c, d and residual
+// are [zones], residual being the RMS error over the rows.
+void fitInfiltration(const double *speeds, const double *deltaT, const double *flows, std::size_t rows,
+  std::size_t zones, double *b, double *c, double *d, double *residual);
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_INFILTRATIONFIT_HPP
@@ -0,0 +1,167 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_JOBQUEUE_HPP
+#define CONTAMUTILITIES_JOBQUEUE_HPP
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+#include <deque>
+#include <exception>
+#include <iostream>
+
+namespace contamutils {
+
+// A minimal worker pool: queue up jobs, then run() them on a fixed number of
+// threads and block until the queue is drained. Alternatively, start() the
+// workers first and keep adding jobs (from any thread, jobs included) until
+// wait() is called. Jobs are responsible for their own error reporting, but
+// anything thrown out of a job is caught and counted so that one bad case
+// doesn't take the whole run down with it.
+class JobQueue
+{
+public:
+  explicit JobQueue(int nthreads=0) : m_nthreads(nthreads), m_failures(0), m_closed(true)
+  {
+    if(m_nthreads <= 0)
+    {
+      m_nthreads = defaultThreadCount();
+    }
+  }
+
+  void add(boost::function<void ()> job)
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_jobs.push_back(job);
+    m_ready.notify_one();
+  }
+
+  // Run everything in the queue, returns the number of jobs that threw
+  int run()
+  {
+    int nthreads = m_nthreads;
+    if((int)m_jobs.size() < nthreads)
+    {
+      nthreads = (int)m_jobs.size();
+    }
+    if(nthreads <= 1)
+    {
+      // No point in spinning up threads, just do it here
+      worker();
+      return m_failures;
+    }
+    boost::thread_group threads;
+    for(int i=0;i<nthreads;i++)
+    {
+      threads.create_thread(boost::bind(&JobQueue::worker,this));
+    }
+    threads.join_all();
+    return m_failures;
+  }
+
+  // Start the workers and return, they wait for jobs until wait() is called
+  void start()
+  {
+    m_closed = false;
+    for(int i=0;i<m_nthreads;i++)
+    {
+      m_threads.create_thread(boost::bind(&JobQueue::worker,this));
+    }
+  }
+
+  // Finish everything queued so far and stop the workers started by start(),
+  // returns the number of jobs that threw
+  int wait()
+  {
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      m_closed = true;
+      m_ready.notify_all();
+    }
+    m_threads.join_all();
+    return m_failures;
+  }
+
+  int threadCount() const
+  {
+    return m_nthreads;
+  }
+
+  static int defaultThreadCount()
+  {
+    int n = (int)boost::thread::hardware_concurrency();
+    if(n < 1)
+    {
+      n = 1;
+    }
+    return n;
+  }
+
+private:
+  void worker()
+  {
+    while(true)
+    {
+      boost::function<void ()> job;
+      {
+        boost::mutex::scoped_lock lock(m_mutex);
+        while(m_jobs.empty() && !m_closed)
+        {
+          m_ready.wait(lock);
+        }
+        if(m_jobs.empty())
+        {
+          return;
+        }
+        job = m_jobs.front();
+        m_jobs.pop_front();
+      }
+      try
+      {
+        job();
+      }
+      catch(std::exception &e)
+      {
+        boost::mutex::scoped_lock lock(m_mutex);
+        std::cout << "Job failed: " << e.what() << std::endl;
+        m_failures++;
+      }
+      catch(...)
+      {
+        boost::mutex::scoped_lock lock(m_mutex);
+        std::cout << "Job failed with unknown exception" << std::endl;
+        m_failures++;
+      }
+    }
+  }
+
+  std::deque<boost::function<void ()> > m_jobs;
+  boost::mutex m_mutex;
+  boost::condition_variable m_ready;
+  boost::thread_group m_threads;
+  int m_nthreads;
+  int m_failures;
+  bool m_closed;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_JOBQUEUE_HPP
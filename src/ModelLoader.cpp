@@ -0,0 +1,238 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "ModelLoader.hpp"
+#include "JobQueue.hpp"
+
+#include <osversion/VersionTranslator.hpp>
+#include <utilities/idd/IddEnums.hxx>
+#include <utilities/idf/IdfFile.hpp>
+#include <utilities/idf/IdfObject.hpp>
+
+#include <OpenStudio.hxx>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace contamutils {
+
+// How far into the file to look for the OS:Version object
+static const unsigned VERSION_SEARCH_LINES = 200;
+
+boost::optional<std::string> osmVersion(std::istream &in)
+{
+  std::string buffer;
+  std::string line;
+  for(unsigned n=0;n<VERSION_SEARCH_LINES && std::getline(in,line);n++)
+  {
+    // Comments run to the end of the line
+    std::string::size_type comment = line.find('!');
+    if(comment != std::string::npos)
+    {
+      line.erase(comment);
+    }
+    buffer += line;
+    buffer += '\n';
+    std::string::size_type end;
+    while((end = buffer.find(';')) != std::string::npos)
+    {
+      std::vector<std::string> fields;
+      boost::split(fields,buffer.substr(0,end),boost::is_any_of(","));
+      buffer.erase(0,end+1);
+      if(boost::iequals(boost::trim_copy(fields[0]),"OS:Version"))
+      {
+        if(fields.size() < 3)
+        {
+          return boost::none;
+        }
+        return boost::optional<std::string>(boost::trim_copy(fields[2]));
+      }
+    }
+  }
+  return boost::none;
+}
+
+boost::optional<std::string> osmVersion(const openstudio::path &path)
+{
+  std::ifstream file(openstudio::toString(path).c_str(),std::ios::in|std::ios::binary);
+  if(!file.good())
+  {
+    return boost::none;
+  }
+  return osmVersion(file);
+}
+
+std::string currentOsmVersion()
+{
+  return openstudio::openStudioVersion();
+}
+
+OsmObjectRanges osmObjectRanges(const std::string &text)
+{
+  OsmObjectRanges ranges;
+  std::size_t begin = std::string::npos;
+  for(std::size_t i=0;i<text.size();i++)
+  {
+    char c = text[i];
+    if(c == '!')
+    {
+      i = text.find('\n',i);
+      if(i == std::string::npos)
+      {
+        break;
+      }
+    }
+    else if(c == ';')
+    {
+      if(begin != std::string::npos)
+      {
+        ranges.push_back(std::make_pair(begin,i+1));
+        begin = std::string::npos;
+      }
+    }
+    else if(begin == std::string::npos && !std::isspace((unsigned char)c))
+    {
+      begin = i;
+    }
+  }
+  return ranges;
+}
+
+static void parseObjects(const std::string &text, const OsmObjectRanges &ranges, std::size_t first, std::size_t last,
+  std::vector<boost::optional<openstudio::IdfObject> > *objects)
+{
+  for(std::size_t i=first;i<last;i++)
+  {
+    (*objects)[i] = openstudio::IdfObject::load(text.substr(ranges[i].first,ranges[i].second-ranges[i].first));
+  }
+}
+
+static boost::optional<openstudio::IdfFile> parseParallel(std::istream &in, int jobs)
+{
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  std::string text = buffer.str();
+  OsmObjectRanges ranges = osmObjectRanges(text);
+  if(ranges.empty())
+  {
+    return boost::none;
+  }
+  std::vector<boost::optional<openstudio::IdfObject> > objects(ranges.size());
+  // Do the first one here, so that the IDD and anything else that is set up
+  // on first use is ready before the workers get to it
+  parseObjects(text,ranges,0,1,&objects);
+  // A few chunks per thread, objects vary a lot in size
+  std::size_t chunk = std::max<std::size_t>(1,ranges.size()/(4*jobs));
+  JobQueue queue(jobs);
+  for(std::size_t first=1;first<ranges.size();first+=chunk)
+  {
+    queue.add(boost::bind(&parseObjects,boost::cref(text),boost::cref(ranges),first,
+      std::min(first+chunk,ranges.size()),&objects));
+  }
+  if(queue.run() > 0)
+  {
+    return boost::none;
+  }
+  openstudio::IdfFile idfFile(openstudio::IddFileType::OpenStudio);
+  for(std::size_t i=0;i<objects.size();i++)
+  {
+    if(!objects[i])
+    {
+      return boost::none;
+    }
+    // The file already has its own version object
+    if(objects[i]->iddObject().type() != openstudio::IddObjectType::OS_Version)
+    {
+      idfFile.addObject(*objects[i]);
+    }
+  }
+  return boost::optional<openstudio::IdfFile>(idfFile);
+}
+
+boost::optional<openstudio::model::Model> loadModelDirect(const openstudio::path &path, int jobs)
+{
+  std::ifstream file(openstudio::toString(path).c_str(),std::ios::in|std::ios::binary);
+  if(!file.good())
+  {
+    return boost::none;
+  }
+  try
+  {
+    boost::optional<openstudio::IdfFile> idfFile;
+    if(jobs > 1)
+    {
+      idfFile = parseParallel(file,jobs);
+    }
+    else
+    {
+      idfFile = openstudio::IdfFile::load(file,openstudio::IddFileType::OpenStudio);
+    }
+    if(!idfFile)
+    {
+      return boost::none;
+    }
+    return boost::optional<openstudio::model::Model>(openstudio::model::Model(*idfFile));
+  }
+  catch(...)
+  {
+    return boost::none;
+  }
+}
+
+boost::optional<openstudio::model::Model> loadModelTranslated(const openstudio::path &path)
+{
+  openstudio::osversion::VersionTranslator vt;
+  return vt.loadModel(path);
+}
+
+boost::optional<openstudio::model::Model> loadModel(const openstudio::path &path, int jobs)
+{
+  boost::optional<std::string> version = osmVersion(path);
+  if(version && *version == currentOsmVersion())
+  {
+    boost::optional<openstudio::model::Model> model = loadModelDirect(path,jobs);
+    if(model)
+    {
+      return model;
+    }
+  }
+  return loadModelTranslated(path);
+}
+
+boost::optional<openstudio::model::Model> loadModel(const openstudio::path &path)
+{
+  int jobs = 1;
+  const char *value = std::getenv("CONTAM_LOAD_JOBS");
+  if(value && *value)
+  {
+    jobs = std::atoi(value);
+  }
+  return loadModel(path,jobs);
+}
+
+} // contamutils
@@ -0,0 +1,66 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_MODELLOADER_HPP
+#define CONTAMUTILITIES_MODELLOADER_HPP
+
+#include <model/Model.hpp>
+#include <utilities/core/Path.hpp>
+
+#include <boost/optional.hpp>
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace contamutils {
+
+// The version identifier in an OSM's OS:Version object. OpenStudio always
+// writes that object first, so only the top of the file is read; none if it
+// isn't there.
+boost::optional<std::string> osmVersion(const openstudio::path &path);
+boost::optional<std::string> osmVersion(std::istream &in);
+
+// Where each object is in the text of an OSM, from its class name up to and
+// including the semicolon that ends it
+typedef std::vector<std::pair<std::size_t,std::size_t> > OsmObjectRanges;
+OsmObjectRanges osmObjectRanges(const std::string &text);
+
+// The version of OpenStudio the tools are built against
+std::string currentOsmVersion();
+
+// Load an OSM, going through the VersionTranslator only if the file is from
+// some other version of OpenStudio. A current file is parsed straight into a
+// model, with its objects split over jobs threads if jobs is more than 1. If
+// that fails for any reason, the VersionTranslator gets a go at it anyway.
+// Without jobs, CONTAM_LOAD_JOBS (default 1) says how many threads to use.
+boost::optional<openstudio::model::Model> loadModel(const openstudio::path &path);
+boost::optional<openstudio::model::Model> loadModel(const openstudio::path &path, int jobs);
+
+// The same, but always through the VersionTranslator, for comparison
+boost::optional<openstudio::model::Model> loadModelTranslated(const openstudio::path &path);
+
+// Load a current OSM directly and nothing else, none if anything goes wrong
+boost::optional<openstudio::model::Model> loadModelDirect(const openstudio::path &path, int jobs);
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_MODELLOADER_HPP
@@ -0,0 +1,302 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "PathFlowMatrix.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <istream>
+
+namespace contamutils {
+
+// Default link flow columns, used when there's no header to go by
+static const int DAY_COLUMN = 0;
+static const int TIME_COLUMN = 1;
+static const int PATH_COLUMN = 3;
+static const int F0_COLUMN = 5;
+static const int F1_COLUMN = 6;
+
+static void splitFields(const std::string &line, std::vector<std::string> &fields)
+{
+  fields.clear();
+  std::string::size_type pos = 0;
+  while(pos < line.size())
+  {
+    while(pos < line.size() && std::isspace((unsigned char)line[pos]))
+    {
+      pos++;
+    }
+    std::string::size_type end = pos;
+    while(end < line.size() && !std::isspace((unsigned char)line[end]))
+    {
+      end++;
+    }
+    if(end > pos)
+    {
+      fields.push_back(line.substr(pos,end-pos));
+    }
+    pos = end;
+  }
+}
+
+static double toDouble(const std::string &field, bool &ok)
+{
+  char *end;
+  double value = std::strtod(field.c_str(),&end);
+  ok = end != field.c_str() && *end == '\0';
+  return value;
+}
+
+static double inflow(double F0, double F1, PathFlowMatrix::Flow flow)
+{
+  switch(flow)
+  {
+  case PathFlowMatrix::InwardPositive:
+    return std::max(F0,0.0) + std::max(F1,0.0);
+  case PathFlowMatrix::InwardNegative:
+    return std::max(-F0,0.0) + std::max(-F1,0.0);
+  default:
+    break;
+  }
+  return F0 + F1;
+}
+
+PathFlowMatrix::Path::Path(int nr, Flow flow) : nr(nr), flow(flow)
+{
+}
+
+PathFlowMatrix::PathFlowMatrix() : m_paths(0)
+{
+}
+
+double PathFlowMatrix::contamDay(const std::string &date, const std::string &time)
+{
+  static const char *months[] = {"jan","feb","mar","apr","may","jun","jul","aug","sep","oct","nov","dec"};
+  static const int daysBefore[] = {0,31,59,90,120,151,181,212,243,273,304,334};
+  if(date.size() < 4)
+  {
+    return -1;
+  }
+  std::string month = date.substr(0,3);
+  std::transform(month.begin(),month.end(),month.begin(),::tolower);
+  int index = -1;
+  for(int i=0;i<12;i++)
+  {
+    if(month == months[i])
+    {
+      index = i;
+      break;
+    }
+  }
+  int day = std::atoi(date.c_str()+3);
+  int hours, minutes, seconds;
+  if(index < 0 || day < 1 || day > 31 || std::sscanf(time.c_str(),"%d:%d:%d",&hours,&minutes,&seconds) != 3)
+  {
+    return -1;
+  }
+  return daysBefore[index] + day - 1 + (3600.0*hours + 60.0*minutes + seconds)/86400.0;
+}
+
+bool PathFlowMatrix::fail(const std::string &message)
+{
+  m_paths = 0;
+  m_days.clear();
+  m_values.clear();
+  m_error = message;
+  return false;
+}
+
+bool PathFlowMatrix::readLfr(const std::string &path, const std::vector<Path> &paths)
+{
+  std::ifstream file(path.c_str());
+  if(!file.good())
+  {
+    return fail("Failed to open link flow file '" + path + "'");
+  }
+  return readLfr(file,paths);
+}
+
+bool PathFlowMatrix::readLfr(std::istream &lfr, const std::vector<Path> &paths)
+{
+  m_paths = 0;
+  m_days.clear();
+  m_values.clear();
+  m_error.clear();
+
+  // Path number -> index in the matrix
+  int maxNr = 0;
+  for(unsigned i=0;i<paths.size();i++)
+  {
+    maxNr = std::max(maxNr,paths[i].nr);
+  }
+  std::vector<int> index(maxNr+1,-1);
+  for(unsigned i=0;i<paths.size();i++)
+  {
+    if(paths[i].nr > 0)
+    {
+      index[paths[i].nr] = i;
+    }
+  }
+  std::size_t npaths = paths.size();
+
+  int dayColumn = DAY_COLUMN;
+  int timeColumn = TIME_COLUMN;
+  int pathColumn = PATH_COLUMN;
+  int f0Column = F0_COLUMN;
+  int f1Column = F1_COLUMN;
+
+  // Read time-major, one row of all the selected paths per report time
+  std::vector<double> timeMajor;
+  std::string line;
+  std::vector<std::string> fields;
+  std::string lastDate, lastTime;
+  std::size_t lineNumber = 0;
+  while(std::getline(lfr,line))
+  {
+    lineNumber++;
+    splitFields(line,fields);
+    if(fields.empty())
+    {
+      continue;
+    }
+    int needed = std::max(std::max(dayColumn,timeColumn),std::max(pathColumn,std::max(f0Column,f1Column)));
+    bool ok = (int)fields.size() > needed;
+    double nr = 0;
+    if(ok)
+    {
+      nr = toDouble(fields[pathColumn],ok);
+    }
+    if(!ok)
+    {
+      // Take the column layout from the header if there is one
+      if(m_days.empty())
+      {
+        for(unsigned i=0;i<fields.size();i++)
+        {
+          std::string name = fields[i];
+          std::transform(name.begin(),name.end(),name.begin(),::tolower);
+          if(name == "day" || name == "date")
+          {
+            dayColumn = i;
+          }
+          else if(name == "time")
+          {
+            timeColumn = i;
+          }
+          else if(name == "p#" || name == "path")
+          {
+            pathColumn = i;
+          }
+          else if(name == "f0")
+          {
+            f0Column = i;
+          }
+          else if(name == "f1")
+          {
+            f1Column = i;
+          }
+        }
+      }
+      continue;
+    }
+    if(fields[dayColumn] != lastDate || fields[timeColumn] != lastTime)
+    {
+      double day = contamDay(fields[dayColumn],fields[timeColumn]);
+      if(day < 0)
+      {
+        char buffer[64];
+        std::sprintf(buffer,"Bad date or time on link flow line %lu",(unsigned long)lineNumber);
+        return fail(buffer);
+      }
+      m_days.push_back(day);
+      timeMajor.resize(timeMajor.size()+npaths,0.0);
+      lastDate = fields[dayColumn];
+      lastTime = fields[timeColumn];
+    }
+    int pathNr = (int)nr;
+    if(pathNr <= 0 || pathNr > maxNr || index[pathNr] < 0)
+    {
+      continue;
+    }
+    bool ok0, ok1;
+    double F0 = toDouble(fields[f0Column],ok0);
+    double F1 = toDouble(fields[f1Column],ok1);
+    if(!ok0 || !ok1)
+    {
+      char buffer[64];
+      std::sprintf(buffer,"Bad flow on link flow line %lu",(unsigned long)lineNumber);
+      return fail(buffer);
+    }
+    timeMajor[(m_days.size()-1)*npaths + index[pathNr]] = inflow(F0,F1,paths[index[pathNr]].flow);
+  }
+
+  // Turn it around so that each path is one row
+  std::size_t ntimes = m_days.size();
+  m_paths = npaths;
+  m_values.resize(npaths*ntimes);
+  for(std::size_t t=0;t<ntimes;t++)
+  {
+    const double *in = &timeMajor[t*npaths];
+    for(std::size_t p=0;p<npaths;p++)
+    {
+      m_values[p*ntimes+t] = in[p];
+    }
+  }
+  return true;
+}
+
+std::size_t PathFlowMatrix::pathCount() const
+{
+  return m_paths;
+}
+
+std::size_t PathFlowMatrix::timeCount() const
+{
+  return m_days.size();
+}
+
+const std::vector<double> &PathFlowMatrix::days() const
+{
+  return m_days;
+}
+
+const std::vector<double> &PathFlowMatrix::values() const
+{
+  return m_values;
+}
+
+const double *PathFlowMatrix::row(std::size_t index) const
+{
+  if(index >= m_paths || m_days.empty())
+  {
+    return 0;
+  }
+  return &m_values[index*m_days.size()];
+}
+
+std::string PathFlowMatrix::errorMessage() const
+{
+  return m_error;
+}
+
+} // contamutils
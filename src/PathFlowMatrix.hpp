@@ -0,0 +1,78 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_PATHFLOWMATRIX_HPP
+#define CONTAMUTILITIES_PATHFLOWMATRIX_HPP
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace contamutils {
+
+// Flows through a set of airflow paths as one contiguous path by time matrix
+// (path-major, so each path's flows are a single row) and one time axis that
+// all of the paths share. Times are in days from midnight on January 1st.
+class PathFlowMatrix
+{
+public:
+  // What to keep for a path. CONTAM flows are positive from zone n to zone m;
+  // for an exterior path, inward says which sign is flow into the building.
+  enum Flow {Net, InwardPositive, InwardNegative};
+
+  struct Path
+  {
+    Path(int nr, Flow flow=Net);
+
+    int nr;
+    Flow flow;
+  };
+
+  PathFlowMatrix();
+
+  // Read the SimReadX link flow results (.lfr) for the given paths. Missing
+  // paths or times leave zeros in the matrix.
+  bool readLfr(const std::string &path, const std::vector<Path> &paths);
+  bool readLfr(std::istream &lfr, const std::vector<Path> &paths);
+
+  std::size_t pathCount() const;
+  std::size_t timeCount() const;
+  const std::vector<double> &days() const;
+  const std::vector<double> &values() const;
+  // Flows for the path at the given index (not path number), timeCount() long
+  const double *row(std::size_t index) const;
+  std::string errorMessage() const;
+
+  // Days from midnight January 1st for a CONTAM date like "Jan01" and time like
+  // "13:00:00", -1 if they can't be parsed
+  static double contamDay(const std::string &date, const std::string &time);
+
+private:
+  bool fail(const std::string &message);
+
+  std::size_t m_paths;
+  std::vector<double> m_days;
+  std::vector<double> m_values;
+  std::string m_error;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_PATHFLOWMATRIX_HPP
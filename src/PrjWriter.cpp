@@ -0,0 +1,200 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "PrjWriter.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+
+namespace contamutils {
+
+bool writePrj(const std::string &prj, std::ostream &out)
+{
+  out.write(prj.data(),prj.size());
+  out.flush();
+  return out.good();
+}
+
+bool writePrj(const openstudio::contam::IndexModel &model, std::ostream &out)
+{
+  return writePrj(model.toString(),out);
+}
+
+bool writePrj(const openstudio::contam::IndexModel &model, const openstudio::path &path)
+{
+  std::ofstream file(openstudio::toString(path).c_str(),std::ios::out|std::ios::binary);
+  if(!file.good())
+  {
+    return false;
+  }
+  return writePrj(model,file);
+}
+
+// Find the one whitespace-delimited field that differs between two renderings
+static bool differingField(const std::string &base, const std::string &changed, std::size_t &start,
+  std::size_t &size, std::string &changedField)
+{
+  std::size_t n = std::min(base.size(),changed.size());
+  std::size_t first = 0;
+  while(first < n && base[first] == changed[first])
+  {
+    first++;
+  }
+  if(first == n && base.size() == changed.size())
+  {
+    return false;
+  }
+  std::size_t common = 0;
+  while(common < n-first && base[base.size()-1-common] == changed[changed.size()-1-common])
+  {
+    common++;
+  }
+  std::size_t end = base.size() - common;
+  while(first > 0 && !std::isspace((unsigned char)base[first-1]))
+  {
+    first--;
+  }
+  while(end < base.size() && !std::isspace((unsigned char)base[end]))
+  {
+    end++;
+  }
+  std::size_t changedEnd = changed.size() - (base.size() - end);
+  if(first >= end || first >= changedEnd)
+  {
+    return false;
+  }
+  for(std::size_t i=first;i<end;i++)
+  {
+    if(std::isspace((unsigned char)base[i]))
+    {
+      return false;
+    }
+  }
+  changedField = changed.substr(first,changedEnd-first);
+  for(std::size_t i=0;i<changedField.size();i++)
+  {
+    if(std::isspace((unsigned char)changedField[i]))
+    {
+      return false;
+    }
+  }
+  start = first;
+  size = end - first;
+  return true;
+}
+
+PrjTemplate::PrjTemplate() : m_first(0), m_firstSize(0), m_second(0), m_secondSize(0), m_speedFirst(true)
+{
+}
+
+bool PrjTemplate::fail(const std::string &message)
+{
+  m_prj.clear();
+  m_error = message;
+  return false;
+}
+
+std::string PrjTemplate::formatNumber(double value)
+{
+  std::ostringstream stream;
+  stream << value;
+  return stream.str();
+}
+
+bool PrjTemplate::build(openstudio::contam::IndexModel &model)
+{
+  double speed = model.ssWeather().windspd();
+  double direction = model.ssWeather().winddir();
+  std::string base = model.toString();
+  double otherSpeed = speed == 7.25 ? 3.5 : 7.25;
+  model.ssWeather().setWindspd(otherSpeed);
+  std::string speedChanged = model.toString();
+  model.ssWeather().setWindspd(speed);
+  double otherDirection = direction == 135 ? 225 : 135;
+  model.ssWeather().setWinddir(otherDirection);
+  std::string directionChanged = model.toString();
+  model.ssWeather().setWinddir(direction);
+  return build(base,speed,direction,speedChanged,otherSpeed,directionChanged,otherDirection);
+}
+
+bool PrjTemplate::build(const std::string &base, double speed, double direction, const std::string &speedChanged,
+  double otherSpeed, const std::string &directionChanged, double otherDirection)
+{
+  m_error.clear();
+  std::size_t speedStart, speedSize, directionStart, directionSize;
+  std::string speedField, directionField;
+  if(!differingField(base,speedChanged,speedStart,speedSize,speedField))
+  {
+    return fail("Failed to find the wind speed in the PRJ");
+  }
+  if(!differingField(base,directionChanged,directionStart,directionSize,directionField))
+  {
+    return fail("Failed to find the wind direction in the PRJ");
+  }
+  if(speedStart == directionStart)
+  {
+    return fail("Wind speed and direction are the same field in the PRJ");
+  }
+  // The fields will be rewritten, so they had better be written the same way
+  if(base.compare(speedStart,speedSize,formatNumber(speed)) || speedField != formatNumber(otherSpeed)
+    || base.compare(directionStart,directionSize,formatNumber(direction))
+    || directionField != formatNumber(otherDirection))
+  {
+    return fail("Wind fields in the PRJ are not formatted as expected");
+  }
+  m_prj = base;
+  m_speedFirst = speedStart < directionStart;
+  m_first = m_speedFirst ? speedStart : directionStart;
+  m_firstSize = m_speedFirst ? speedSize : directionSize;
+  m_second = m_speedFirst ? directionStart : speedStart;
+  m_secondSize = m_speedFirst ? directionSize : speedSize;
+  return true;
+}
+
+bool PrjTemplate::valid() const
+{
+  return !m_prj.empty();
+}
+
+bool PrjTemplate::write(std::ostream &out, double speed, double direction) const
+{
+  if(!valid())
+  {
+    return false;
+  }
+  std::size_t firstEnd = m_first + m_firstSize;
+  std::size_t secondEnd = m_second + m_secondSize;
+  out.write(m_prj.data(),m_first);
+  out << formatNumber(m_speedFirst ? speed : direction);
+  out.write(m_prj.data()+firstEnd,m_second-firstEnd);
+  out << formatNumber(m_speedFirst ? direction : speed);
+  out.write(m_prj.data()+secondEnd,m_prj.size()-secondEnd);
+  out.flush();
+  return out.good();
+}
+
+std::string PrjTemplate::errorMessage() const
+{
+  return m_error;
+}
+
+} // contamutils
@@ -0,0 +1,80 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_PRJWRITER_HPP
+#define CONTAMUTILITIES_PRJWRITER_HPP
+
+#include <airflow/contam/ForwardTranslator.hpp>
+
+#include <utilities/core/Path.hpp>
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace contamutils {
+
+// Write a model's PRJ exactly as IndexModel renders it. The text goes out as
+// is, so the only copy is the one toString() makes; going through QString and
+// QTextStream added a UTF-16 copy and an encoding pass on top of that.
+bool writePrj(const openstudio::contam::IndexModel &model, std::ostream &out);
+bool writePrj(const openstudio::contam::IndexModel &model, const openstudio::path &path);
+// Same for PRJ text that has already been rendered
+bool writePrj(const std::string &prj, std::ostream &out);
+
+// A PRJ rendered once with the steady-state wind speed and direction found in
+// it, so that the cases of a wind sweep can be written without rendering the
+// whole model again for each one. The fields are found by rendering with the
+// wind changed and comparing, and the template is only valid if the numbers
+// come out exactly as the model would have written them.
+class PrjTemplate
+{
+public:
+  PrjTemplate();
+
+  // Render the model (three times), the model's wind is left as it was
+  bool build(openstudio::contam::IndexModel &model);
+  // Build from renderings of the same model with its wind (base), then with a
+  // different speed, then with a different direction
+  bool build(const std::string &base, double speed, double direction, const std::string &speedChanged,
+    double otherSpeed, const std::string &directionChanged, double otherDirection);
+
+  bool valid() const;
+  // Write the PRJ with the given wind
+  bool write(std::ostream &out, double speed, double direction) const;
+  std::string errorMessage() const;
+
+  // Numbers the way the PRJ writer formats them
+  static std::string formatNumber(double value);
+
+private:
+  bool fail(const std::string &message);
+
+  std::string m_prj;
+  std::size_t m_first;       // Offset of the first wind field
+  std::size_t m_firstSize;
+  std::size_t m_second;      // Offset of the second wind field
+  std::size_t m_secondSize;
+  bool m_speedFirst;
+  std::string m_error;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_PRJWRITER_HPP
@@ -0,0 +1,255 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "Profiler.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace contamutils {
+
+#ifdef _WIN32
+static double seconds(const FILETIME &time)
+{
+  ULARGE_INTEGER value;
+  value.LowPart = time.dwLowDateTime;
+  value.HighPart = time.dwHighDateTime;
+  return value.QuadPart*1.0e-7;
+}
+#else
+static double seconds(const struct timeval &time)
+{
+  return time.tv_sec + time.tv_usec*1.0e-6;
+}
+#endif
+
+ProcessTimes ProcessTimes::now()
+{
+  ProcessTimes times;
+  times.wall = boost::chrono::steady_clock::now();
+  times.cpu = 0.0;
+  times.childCpu = 0.0;
+#ifdef _WIN32
+  // Windows doesn't keep track of the children for us
+  FILETIME creation, exit, kernel, user;
+  if(GetProcessTimes(GetCurrentProcess(),&creation,&exit,&kernel,&user))
+  {
+    times.cpu = seconds(kernel) + seconds(user);
+  }
+#else
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF,&usage) == 0)
+  {
+    times.cpu = seconds(usage.ru_utime) + seconds(usage.ru_stime);
+  }
+  if(getrusage(RUSAGE_CHILDREN,&usage) == 0)
+  {
+    times.childCpu = seconds(usage.ru_utime) + seconds(usage.ru_stime);
+  }
+#endif
+  return times;
+}
+
+double peakMemory()
+{
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if(GetProcessMemoryInfo(GetCurrentProcess(),&counters,sizeof(counters)))
+  {
+    return counters.PeakWorkingSetSize/1048576.0;
+  }
+  return 0.0;
+#else
+  struct rusage usage;
+  getrusage(RUSAGE_SELF,&usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss/1048576.0;
+#else
+  return usage.ru_maxrss/1024.0;
+#endif
+#endif
+}
+
+static std::string jsonString(const std::string &value)
+{
+  std::string out = "\"";
+  for(std::string::size_type i=0;i<value.size();i++)
+  {
+    unsigned char c = value[i];
+    if(c == '"' || c == '\\')
+    {
+      out += '\\';
+      out += c;
+    }
+    else if(c < 0x20)
+    {
+      char escape[8];
+      std::sprintf(escape,"\\u%04x",c);
+      out += escape;
+    }
+    else
+    {
+      out += c;
+    }
+  }
+  return out + "\"";
+}
+
+static double elapsed(const ProcessTimes &start, const ProcessTimes &end)
+{
+  return boost::chrono::duration<double>(end.wall - start.wall).count();
+}
+
+Profiler::Profiler(const std::string &program) : m_program(program), m_start(ProcessTimes::now()), m_written(false)
+{
+}
+
+Profiler::~Profiler()
+{
+  if(!m_written)
+  {
+    write();
+  }
+}
+
+void Profiler::setOutput(const std::string &path)
+{
+  m_output = path;
+}
+
+void Profiler::setInput(const std::string &input)
+{
+  m_input = input;
+}
+
+bool Profiler::enabled() const
+{
+  return !m_output.empty();
+}
+
+void Profiler::add(const std::string &phase, const ProcessTimes &start, const ProcessTimes &end)
+{
+  double memory = peakMemory();
+  boost::mutex::scoped_lock lock(m_mutex);
+  std::vector<Phase>::iterator iter = m_phases.begin();
+  while(iter != m_phases.end() && iter->name != phase)
+  {
+    ++iter;
+  }
+  if(iter == m_phases.end())
+  {
+    Phase blank = {phase,0,0.0,0.0,0.0,0.0};
+    iter = m_phases.insert(m_phases.end(),blank);
+  }
+  iter->count++;
+  iter->wall += elapsed(start,end);
+  iter->cpu += end.cpu - start.cpu;
+  iter->childCpu += end.childCpu - start.childCpu;
+  iter->processPeakMemoryAtEnd = memory;
+}
+
+bool Profiler::write()
+{
+  if(!enabled())
+  {
+    return true;
+  }
+  m_written = true;
+  if(m_output == "-")
+  {
+    writeJson(std::cout);
+    return std::cout.good();
+  }
+  std::ofstream file(m_output.c_str());
+  writeJson(file);
+  if(!file.good())
+  {
+    std::cout << "Failed to write profile '" << m_output << "'." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void Profiler::writeJson(std::ostream &out) const
+{
+  ProcessTimes end = ProcessTimes::now();
+  double memory = peakMemory();
+  boost::mutex::scoped_lock lock(m_mutex);
+  std::streamsize precision = out.precision(6);
+  out << "{" << std::endl;
+  out << "  \"program\": " << jsonString(m_program) << "," << std::endl;
+  out << "  \"input\": " << jsonString(m_input) << "," << std::endl;
+  out << "  \"wall_s\": " << elapsed(m_start,end) << "," << std::endl;
+  out << "  \"cpu_s\": " << end.cpu << "," << std::endl;
+  out << "  \"child_cpu_s\": " << end.childCpu << "," << std::endl;
+  out << "  \"peak_memory_mib\": " << memory << "," << std::endl;
+  out << "  \"phases\": [";
+  for(unsigned i=0;i<m_phases.size();i++)
+  {
+    const Phase &phase = m_phases[i];
+    out << (i ? "," : "") << std::endl;
+    out << "    {\"name\": " << jsonString(phase.name) << ", \"count\": " << phase.count
+      << ", \"wall_s\": " << phase.wall << ", \"cpu_s\": " << phase.cpu << ", \"child_cpu_s\": " << phase.childCpu
+      << ", \"process_peak_memory_mib_at_end\": " << phase.processPeakMemoryAtEnd << "}";
+  }
+  out << std::endl << "  ]" << std::endl << "}" << std::endl;
+  out.precision(precision);
+}
+
+ProfilePhase::ProfilePhase(Profiler &profiler, const std::string &name) : m_profiler(&profiler), m_name(name),
+  m_running(profiler.enabled())
+{
+  if(m_running)
+  {
+    m_start = ProcessTimes::now();
+  }
+}
+
+ProfilePhase::ProfilePhase(Profiler *profiler, const std::string &name) : m_profiler(profiler), m_name(name),
+  m_running(profiler && profiler->enabled())
+{
+  if(m_running)
+  {
+    m_start = ProcessTimes::now();
+  }
+}
+
+ProfilePhase::~ProfilePhase()
+{
+  stop();
+}
+
+void ProfilePhase::stop()
+{
+  if(m_running)
+  {
+    m_profiler->add(m_name,m_start,ProcessTimes::now());
+    m_running = false;
+  }
+}
+
+} // contamutils
@@ -0,0 +1,112 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_PROFILER_HPP
+#define CONTAMUTILITIES_PROFILER_HPP
+
+#include <boost/chrono.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace contamutils {
+
+// Where the process is at, as far as the profiler is concerned
+struct ProcessTimes
+{
+  static ProcessTimes now();
+
+  boost::chrono::steady_clock::time_point wall;
+  double cpu;      // User plus system time of this process [s]
+  double childCpu; // Same for child processes that have finished (ContamX, SimReadX) [s]
+};
+
+// Peak memory use of the process so far [MiB]
+double peakMemory();
+
+// Wall time and CPU time by phase, for the --profile option. A phase is timed
+// with a ProfilePhase. Phases with the same name are added together, so a
+// phase that runs once per case or per model (possibly in several threads at
+// once) reports its total and how many times it ran. CPU times are for the
+// whole process, so phases that overlap in different threads both count the
+// CPU use of either. Memory isn't split by phase: each phase only records the
+// peak of the whole process when it last ended, which is not what the phase
+// itself used. The report is written as JSON when the profiler goes away (so a
+// run that fails part way still gets one), or earlier with write().
+class Profiler : private boost::noncopyable
+{
+public:
+  explicit Profiler(const std::string &program);
+  ~Profiler();
+
+  // Report to this file ("-" for the console), profiling is off until there is one
+  void setOutput(const std::string &path);
+  // Anything that helps tell reports apart, like the input file
+  void setInput(const std::string &input);
+  bool enabled() const;
+
+  void add(const std::string &phase, const ProcessTimes &start, const ProcessTimes &end);
+
+  bool write();
+  void writeJson(std::ostream &out) const;
+
+private:
+  struct Phase
+  {
+    std::string name;
+    unsigned count;
+    double wall;
+    double cpu;
+    double childCpu;
+    double processPeakMemoryAtEnd;
+  };
+
+  std::string m_program;
+  std::string m_input;
+  std::string m_output;
+  ProcessTimes m_start;
+  std::vector<Phase> m_phases;
+  bool m_written;
+  mutable boost::mutex m_mutex;
+};
+
+// Times one phase from construction until stop() or destruction, whichever
+// comes first. Does nothing if there is no profiler or it isn't enabled.
+class ProfilePhase : private boost::noncopyable
+{
+public:
+  ProfilePhase(Profiler &profiler, const std::string &name);
+  ProfilePhase(Profiler *profiler, const std::string &name);
+  ~ProfilePhase();
+
+  void stop();
+
+private:
+  Profiler *m_profiler;
+  std::string m_name;
+  ProcessTimes m_start;
+  bool m_running;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_PROFILER_HPP
@@ -0,0 +1,111 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "ScheduleGrid.hpp"
+#include "FlowConversion.hpp"
+
+#include <utilities/data/Vector.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace contamutils {
+
+int parseContamTime(const std::string &time)
+{
+  int hours, minutes, seconds;
+  char extra;
+  if(std::sscanf(time.c_str(),"%d:%d:%d%c",&hours,&minutes,&seconds,&extra) != 3)
+  {
+    return -1;
+  }
+  if(hours < 0 || minutes < 0 || minutes > 59 || seconds < 0 || seconds > 59)
+  {
+    return -1;
+  }
+  return 3600*hours + 60*minutes + seconds;
+}
+
+std::string formatContamTime(int seconds)
+{
+  char buffer[16];
+  std::sprintf(buffer,"%02d:%02d:%02d",seconds/3600,(seconds/60)%60,seconds%60);
+  return std::string(buffer);
+}
+
+bool isScheduleTimestep(int seconds)
+{
+  return seconds > 0 && seconds%60 == 0 && 3600%seconds == 0;
+}
+
+static int gcd(int a, int b)
+{
+  while(b)
+  {
+    int r = a%b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+int setOutputTimestep(openstudio::contam::IndexModel &model, int timestep)
+{
+  if(timestep == 0)
+  {
+    timestep = parseContamTime(model.rc().time_list());
+  }
+  if(!isScheduleTimestep(timestep))
+  {
+    return -1;
+  }
+  model.rc().setTime_list(formatContamTime(timestep));
+  // ContamX can only report at multiples of the calculation timestep
+  int calculation = parseContamTime(model.rc().time_step());
+  if(calculation <= 0 || timestep%calculation)
+  {
+    calculation = calculation > 0 ? gcd(calculation,timestep) : timestep;
+    model.rc().setTime_step(formatContamTime(calculation));
+  }
+  return timestep;
+}
+
+std::size_t gridSteps(const openstudio::DateTime &start, const openstudio::DateTime &end, const openstudio::Time &delta)
+{
+  double steps = (end - start).totalDays()/delta.totalDays();
+  if(steps <= 0)
+  {
+    return 0;
+  }
+  return (std::size_t)std::floor(steps + 1.0e-6);
+}
+
+void sampleOntoGrid(const openstudio::TimeSeries &series, const openstudio::DateTime &start, double step,
+  std::size_t steps, double *out)
+{
+  // TimeSeries hands out copies, but at least don't copy them again
+  openstudio::Vector days = series.daysFromFirstReport();
+  openstudio::Vector values = series.values();
+  std::size_t count = std::min(days.size(),values.size());
+  double offset = (series.firstReportDateTime() - start).totalDays();
+  sampleOntoGrid(count ? &days[0] : 0,count ? &values[0] : 0,count,offset,step,steps,out);
+}
+
+} // contamutils
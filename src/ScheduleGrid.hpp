@@ -0,0 +1,56 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_SCHEDULEGRID_HPP
+#define CONTAMUTILITIES_SCHEDULEGRID_HPP
+
+#include <airflow/contam/ForwardTranslator.hpp>
+
+#include <utilities/data/TimeSeries.hpp>
+#include <utilities/time/DateTime.hpp>
+#include <utilities/time/Time.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace contamutils {
+
+// Seconds in a CONTAM "HH:MM:SS" time, -1 if it can't be parsed
+int parseContamTime(const std::string &time);
+std::string formatContamTime(int seconds);
+
+// Schedules have to divide an hour evenly into whole minutes
+bool isScheduleTimestep(int seconds);
+
+// Set up the model to report results every timestep seconds, making the
+// calculation timestep smaller if it doesn't divide the new output interval.
+// A timestep of zero keeps the model's own output interval. Returns the
+// output interval in seconds, or -1 if it can't be used for a schedule.
+int setOutputTimestep(openstudio::contam::IndexModel &model, int timestep);
+
+// Number of whole timesteps between start and end
+std::size_t gridSteps(const openstudio::DateTime &start, const openstudio::DateTime &end, const openstudio::Time &delta);
+
+// Sample a TimeSeries onto the schedule grid that starts at start (see sampleOntoGrid in FlowConversion.hpp)
+void sampleOntoGrid(const openstudio::TimeSeries &series, const openstudio::DateTime &start, double step,
+  std::size_t steps, double *out);
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_SCHEDULEGRID_HPP
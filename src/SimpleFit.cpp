@@ -0,0 +1,293 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "SimpleFit.hpp"
+#include "InfiltrationFit.hpp"
+
+#include <model/Space.hpp>
+#include <model/Space_Impl.hpp>
+#include <model/ThermalZone.hpp>
+#include <model/SpaceInfiltrationDesignFlowRate.hpp>
+#include <model/SpaceInfiltrationDesignFlowRate_Impl.hpp>
+#include <model/SpaceInfiltrationEffectiveLeakageArea.hpp>
+#include <model/SpaceInfiltrationEffectiveLeakageArea_Impl.hpp>
+
+#include <boost/foreach.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <iostream>
+#include <sstream>
+
+namespace contamutils {
+
+// The calm stack cases go in the rows after the wind speeds
+static void addStackCases(std::vector<SweepCase> &cases, int firstRow, const std::vector<double> &stackDifferences,
+  double Tref)
+{
+  for(unsigned i=0;i<stackDifferences.size();i++)
+  {
+    cases.push_back(SweepCase(0.0,0.0,firstRow+i,1.0,Tref-stackDifferences[i]));
+  }
+}
+
+std::vector<SweepCase> simpleFitCases(int ndirs, const std::vector<double> &speeds,
+  const std::vector<double> &stackDifferences, double Tref)
+{
+  std::vector<SweepCase> cases;
+  if(ndirs < 1)
+  {
+    return cases;
+  }
+  double delta = 360.0/(double)ndirs;
+  for(unsigned i=0;i<speeds.size();i++)
+  {
+    for(int j=0;j<ndirs;j++)
+    {
+      cases.push_back(SweepCase(speeds[i],j*delta,i,1.0/(double)ndirs));
+    }
+  }
+  addStackCases(cases,speeds.size(),stackDifferences,Tref);
+  return cases;
+}
+
+std::vector<double> windRoseSpeeds(const WindRose &rose, double minProbability)
+{
+  std::vector<double> speeds;
+  double maxSpeed = rose.maxSpeed();
+  for(double low=WINDROSE_CALM_SPEED;low<=maxSpeed;low+=WINDROSE_BIN_WIDTH)
+  {
+    if(rose.probability(low,low+WINDROSE_BIN_WIDTH) >= minProbability)
+    {
+      speeds.push_back(rose.meanSpeed(low,low+WINDROSE_BIN_WIDTH));
+    }
+  }
+  return speeds;
+}
+
+std::vector<SweepCase> windRoseFitCases(const WindRose &rose, int ndirs, const std::vector<double> &speeds,
+  double minShare, const std::vector<double> &stackDifferences, double Tref)
+{
+  std::vector<SweepCase> cases;
+  if(ndirs < 1)
+  {
+    return cases;
+  }
+  double delta = 360.0/(double)ndirs;
+  std::vector<double> windy = rose.sectorProbabilities(ndirs,WINDROSE_CALM_SPEED,HUGE_VAL);
+  for(unsigned i=0;i<speeds.size();i++)
+  {
+    std::vector<double> p = windy;
+    if(speeds[i] >= WINDROSE_CALM_SPEED)
+    {
+      double low = WINDROSE_CALM_SPEED
+        + std::floor((speeds[i]-WINDROSE_CALM_SPEED)/WINDROSE_BIN_WIDTH)*WINDROSE_BIN_WIDTH;
+      std::vector<double> bin = rose.sectorProbabilities(ndirs,low,low+WINDROSE_BIN_WIDTH);
+      if(std::accumulate(bin.begin(),bin.end(),0.0) > 0.0)
+      {
+        p = bin;
+      }
+    }
+    double total = std::accumulate(p.begin(),p.end(),0.0);
+    if(total <= 0.0)
+    {
+      // No wind at all, so nothing to go on
+      p.assign(ndirs,1.0);
+      total = ndirs;
+    }
+    // Drop the directions the wind hardly ever comes from, but always keep the most common one
+    int most = std::max_element(p.begin(),p.end()) - p.begin();
+    double kept = 0.0;
+    for(int j=0;j<ndirs;j++)
+    {
+      if(j != most && p[j] < minShare*total)
+      {
+        p[j] = 0.0;
+      }
+      kept += p[j];
+    }
+    for(int j=0;j<ndirs;j++)
+    {
+      if(p[j] > 0.0)
+      {
+        cases.push_back(SweepCase(speeds[i],j*delta,i,p[j]/kept));
+      }
+    }
+  }
+  addStackCases(cases,speeds.size(),stackDifferences,Tref);
+  return cases;
+}
+
+bool parseFitValues(const std::string &list, std::vector<double> &values)
+{
+  values.clear();
+  std::stringstream stream(list);
+  std::string entry;
+  while(std::getline(stream,entry,','))
+  {
+    std::istringstream field(entry);
+    double value;
+    if(!(field >> value) || !(field >> std::ws).eof())
+    {
+      return false;
+    }
+    values.push_back(value);
+  }
+  return true;
+}
+
+std::vector<double> zoneTemperatures(const openstudio::contam::IndexModel &model)
+{
+  std::vector<openstudio::contam::Zone> zones = model.zones();
+  std::vector<double> T(zones.size());
+  for(unsigned i=0;i<zones.size();i++)
+  {
+    T[i] = zones[i].T0();
+  }
+  return T;
+}
+
+std::vector<DesignFlowRateFit> fitDesignFlowRates(const std::vector<SweepCase> &cases,
+  const std::vector<std::vector<double> > &results, const std::vector<double> &zoneTemperatures, double Tambt)
+{
+  std::vector<DesignFlowRateFit> fits;
+  if(results.empty())
+  {
+    return fits;
+  }
+  std::size_t rows = results.size();
+  std::size_t zones = results[0].size();
+  // The wind speed and outdoor temperature of each row
+  std::vector<double> speeds(rows,0.0);
+  std::vector<double> outdoor(rows,Tambt);
+  for(unsigned i=0;i<cases.size();i++)
+  {
+    if(cases[i].row >= 0 && (std::size_t)cases[i].row < rows)
+    {
+      speeds[cases[i].row] = cases[i].speed;
+      if(cases[i].temperature > 0.0)
+      {
+        outdoor[cases[i].row] = cases[i].temperature;
+      }
+    }
+  }
+  std::vector<double> deltaT(rows*zones,0.0);
+  std::vector<double> flows(rows*zones,0.0);
+  for(std::size_t r=0;r<rows;r++)
+  {
+    for(std::size_t z=0;z<zones;z++)
+    {
+      double T = z < zoneTemperatures.size() ? zoneTemperatures[z] : Tambt;
+      deltaT[r*zones+z] = std::fabs(T - outdoor[r]);
+      flows[r*zones+z] = results[r][z];
+    }
+  }
+  std::vector<double> b(zones), c(zones), d(zones), residual(zones);
+  fitInfiltration(&speeds[0],&deltaT[0],&flows[0],rows,zones,&b[0],&c[0],&d[0],&residual[0]);
+
+  fits.resize(zones);
+  for(std::size_t z=0;z<zones;z++)
+  {
+    double flow = 0.0;
+    for(std::size_t r=0;r<rows;r++)
+    {
+      flow = std::max(flow,std::fabs(flows[r*zones+z]));
+    }
+    fits[z].residual = residual[z];
+    if(flow > 0.0)
+    {
+      fits[z].flow = flow;
+      fits[z].B = b[z]/flow;
+      fits[z].C = c[z]/flow;
+      fits[z].D = d[z]/flow;
+    }
+  }
+  return fits;
+}
+
+bool setDesignFlowRates(openstudio::model::Model &model, const std::map<openstudio::Handle,int> &zoneMap,
+  const std::vector<DesignFlowRateFit> &fits, double density, std::ostream &out)
+{
+  // Remove previous infiltration objects
+  std::vector<openstudio::model::SpaceInfiltrationDesignFlowRate> dfrInf = model.getConcreteModelObjects<openstudio::model::SpaceInfiltrationDesignFlowRate>();
+  BOOST_FOREACH(openstudio::model::SpaceInfiltrationDesignFlowRate inf, dfrInf)
+  {
+    inf.remove();
+  }
+  std::vector<openstudio::model::SpaceInfiltrationEffectiveLeakageArea> elaInf = model.getConcreteModelObjects<openstudio::model::SpaceInfiltrationEffectiveLeakageArea>();
+  BOOST_FOREACH(openstudio::model::SpaceInfiltrationEffectiveLeakageArea inf, elaInf)
+  {
+    inf.remove();
+  }
+
+  // Build a map to the index - this will need to be changed significantly if we want more than one
+  // space per zone.
+  std::vector<openstudio::model::Space> spaces = model.getConcreteModelObjects<openstudio::model::Space>();
+  std::map<openstudio::Handle,int> spaceMap;
+  BOOST_FOREACH(openstudio::model::Space space, spaces)
+  {
+    boost::optional<openstudio::model::ThermalZone> thermalZone = space.thermalZone();
+    if(!thermalZone)
+    {
+      out << "Warning: Unattached space '" << openstudio::toString(space.handle()) << "'" << std::endl;
+    }
+    else
+    {
+      std::map<openstudio::Handle,int>::const_iterator iter = zoneMap.find(thermalZone->handle());
+      if(iter != zoneMap.end())
+      {
+        spaceMap[space.handle()] = iter->second;
+      }
+      else
+      {
+        out << "Warning: lookup failed for zone '" << openstudio::toString(thermalZone->handle()) << "'" << std::endl;
+      }
+    }
+  }
+
+  // Generate infiltration objects and attach to spaces
+  std::pair <openstudio::Handle,int> handleInt;
+  BOOST_FOREACH(handleInt, spaceMap)
+  {
+    boost::optional<openstudio::model::Space> space = model.getModelObject<openstudio::model::Space>(handleInt.first);
+    if(!space)
+    {
+      out << "Failed to find space " << openstudio::toString(handleInt.first)<< std::endl;
+      return false;
+    }
+    unsigned index = handleInt.second-1;
+    if(index >= fits.size())
+    {
+      out << "No fit for zone " << handleInt.second << std::endl;
+      return false;
+    }
+    openstudio::model::SpaceInfiltrationDesignFlowRate infObj(model);
+    // The sweep flows are in kg/s, EnergyPlus wants m^3/s
+    infObj.setDesignFlowRate(fits[index].flow/density);
+    infObj.setConstantTermCoefficient(0.0);
+    infObj.setTemperatureTermCoefficient(fits[index].B);
+    infObj.setVelocityTermCoefficient(fits[index].C);
+    infObj.setVelocitySquaredTermCoefficient(fits[index].D);
+    infObj.setSpace(*space);
+  }
+  return true;
+}
+
+} // contamutils
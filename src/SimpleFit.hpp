@@ -0,0 +1,97 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_SIMPLEFIT_HPP
+#define CONTAMUTILITIES_SIMPLEFIT_HPP
+
+#include "WindRose.hpp"
+#include "WindSweep.hpp"
+
+#include <airflow/contam/ForwardTranslator.hpp>
+#include <model/Model.hpp>
+#include <utilities/core/UUID.hpp>
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace contamutils {
+
+// The coefficients for one zone's design flow rate infiltration object
+struct DesignFlowRateFit
+{
+  DesignFlowRateFit() : flow(0.0), B(0.0), C(0.0), D(0.0), residual(0.0)
+  {}
+  double flow;     // Largest infiltration over the sampled conditions [kg/s]
+  double B;        // Temperature term coefficient [1/K]
+  double C;        // Velocity term coefficient [s/m]
+  double D;        // Velocity squared term coefficient [s^2/m^2]
+  double residual; // RMS error of the fit over the sampled conditions [kg/s]
+};
+
+// Every direction at each wind speed, then one calm case for each stack
+// temperature difference [K] with the outdoor air that much colder than Tref.
+// Row i of the results is speeds[i], each case weighted so that the rows come
+// out direction-averaged, and the stack rows follow.
+std::vector<SweepCase> simpleFitCases(int ndirs, const std::vector<double> &speeds,
+  const std::vector<double> &stackDifferences, double Tref);
+
+// The wind rose speed bins [m/s]: records slower than the calm speed have no
+// real direction, faster ones are binned this wide starting from it
+const double WINDROSE_CALM_SPEED = 0.5;
+const double WINDROSE_BIN_WIDTH = 2.0;
+
+// The mean speed of each wind rose speed bin that has at least minProbability
+// of the records
+std::vector<double> windRoseSpeeds(const WindRose &rose, double minProbability);
+
+// Like simpleFitCases, but each speed's directions are weighted by how often
+// the wind blows from them at speeds in the same bin of the wind rose, and
+// directions with less than minShare of the bin are not simulated at all. A
+// speed in an empty (or the calm) bin uses the directions of all the records
+// that aren't calm.
+std::vector<SweepCase> windRoseFitCases(const WindRose &rose, int ndirs, const std::vector<double> &speeds,
+  double minShare, const std::vector<double> &stackDifferences, double Tref);
+
+// Read a comma-separated list of numbers, like the --speeds option. False if
+// any entry isn't a number.
+bool parseFitValues(const std::string &list, std::vector<double> &values);
+
+// The initial temperature of each zone of a translated model [K]
+std::vector<double> zoneTemperatures(const openstudio::contam::IndexModel &model);
+
+// Least-squares fit of B, C and D for each zone to every row of the sweep
+// results, all zones at once. The conditions of each row come from its cases,
+// with Tambt the outdoor temperature of cases that keep the model's. The flow
+// is the largest of the zone's rows and the coefficients are scaled to match,
+// so a zone with no infiltration at all gets an all-zero fit.
+std::vector<DesignFlowRateFit> fitDesignFlowRates(const std::vector<SweepCase> &cases,
+  const std::vector<std::vector<double> > &results, const std::vector<double> &zoneTemperatures, double Tambt);
+
+// Replace the model's infiltration objects with one design flow rate object
+// per space, found through the translator's zone map. The design flow rate
+// [m^3/s] is the fitted mass flow [kg/s] divided by density [kg/m^3]. Warnings
+// go to out, false if a space can't be found.
+bool setDesignFlowRates(openstudio::model::Model &model, const std::map<openstudio::Handle,int> &zoneMap,
+  const std::vector<DesignFlowRateFit> &fits, double density, std::ostream &out);
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_SIMPLEFIT_HPP
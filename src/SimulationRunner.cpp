@@ -0,0 +1,221 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "SimulationRunner.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <QProcess>
+#include <QString>
+#include <QStringList>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace contamutils {
+
+static std::string trim(const std::string &string)
+{
+  std::string::size_type first = 0;
+  std::string::size_type last = string.size();
+  while(first < last && std::isspace((unsigned char)string[first]))
+  {
+    first++;
+  }
+  while(last > first && std::isspace((unsigned char)string[last-1]))
+  {
+    last--;
+  }
+  std::string result = string.substr(first,last-first);
+  if(result.size() > 1 && result[0] == '"' && result[result.size()-1] == '"')
+  {
+    result = result.substr(1,result.size()-2);
+  }
+  return result;
+}
+
+static std::string environment(const char *name)
+{
+  const char *value = std::getenv(name);
+  return value ? std::string(value) : std::string();
+}
+
+// Make a program path absolute against base. A bare name is left for the PATH
+// search unless there's a file by that name in base.
+static openstudio::path resolve(const std::string &name, const openstudio::path &base)
+{
+  openstudio::path exe = openstudio::toPath(name);
+  if(!exe.has_parent_path() && !boost::filesystem::is_regular_file(base / exe))
+  {
+    return exe;
+  }
+  return boost::filesystem::absolute(exe,base);
+}
+
+// Take the first of the choices that's set, leave exe alone if none are. The
+// first two are relative to the current directory, the third to thirdBase.
+static void choose(openstudio::path &exe, const std::string &first, const std::string &second,
+  const std::string &third, const openstudio::path &thirdBase)
+{
+  openstudio::path current = boost::filesystem::current_path();
+  if(!first.empty())
+  {
+    exe = resolve(first,current);
+  }
+  else if(!second.empty())
+  {
+    exe = resolve(second,current);
+  }
+  else if(!third.empty())
+  {
+    exe = resolve(third,thirdBase);
+  }
+}
+
+SimulationRunner::SimulationRunner() : m_contamx(openstudio::toPath("contamx3")),
+  m_simreadx(openstudio::toPath("simreadx"))
+{
+}
+
+bool SimulationRunner::configure(const std::string &contamx, const std::string &simreadx,
+  const std::string &configFile)
+{
+  m_error.clear();
+  std::string fileContamX;
+  std::string fileSimReadX;
+  std::string config = configFile.empty() ? environment("CONTAM_CONFIG") : configFile;
+  openstudio::path configDir;
+  if(!config.empty())
+  {
+    configDir = boost::filesystem::absolute(openstudio::toPath(config)).parent_path();
+    std::ifstream file(config.c_str());
+    if(!file.good())
+    {
+      m_error = "Failed to open config file '" + config + "'";
+      return false;
+    }
+    std::string line;
+    while(std::getline(file,line))
+    {
+      line = trim(line);
+      std::string::size_type equals = line.find('=');
+      if(line.empty() || line[0] == '#' || equals == std::string::npos)
+      {
+        continue;
+      }
+      std::string key = trim(line.substr(0,equals));
+      std::transform(key.begin(),key.end(),key.begin(),::tolower);
+      std::string value = trim(line.substr(equals+1));
+      if(key == "contamx")
+      {
+        fileContamX = value;
+      }
+      else if(key == "simreadx")
+      {
+        fileSimReadX = value;
+      }
+    }
+  }
+
+  // The runs happen in other working directories, so the paths can't stay relative
+  choose(m_contamx,contamx,environment("CONTAM_CONTAMX"),fileContamX,configDir);
+  choose(m_simreadx,simreadx,environment("CONTAM_SIMREADX"),fileSimReadX,configDir);
+  return true;
+}
+
+void SimulationRunner::setContamX(const openstudio::path &exe)
+{
+  m_contamx = exe;
+}
+
+void SimulationRunner::setSimReadX(const openstudio::path &exe)
+{
+  m_simreadx = exe;
+}
+
+openstudio::path SimulationRunner::contamX() const
+{
+  return m_contamx;
+}
+
+openstudio::path SimulationRunner::simReadX() const
+{
+  return m_simreadx;
+}
+
+std::string SimulationRunner::errorMessage() const
+{
+  return m_error;
+}
+
+bool SimulationRunner::runContamX(const openstudio::path &prjPath, std::string &error,
+  const openstudio::path &workingDir) const
+{
+  std::vector<std::string> args;
+  args.push_back(openstudio::toString(prjPath));
+  return run(m_contamx,args,workingDir,"ContamX",error);
+}
+
+bool SimulationRunner::runSimReadX(const openstudio::path &prjPath, std::string &error,
+  const openstudio::path &workingDir) const
+{
+  std::vector<std::string> args;
+  args.push_back("-a");
+  args.push_back(openstudio::toString(prjPath));
+  return run(m_simreadx,args,workingDir,"SimReadX",error);
+}
+
+bool SimulationRunner::run(const openstudio::path &exe, const std::vector<std::string> &args,
+  const openstudio::path &workingDir, const std::string &label, std::string &error) const
+{
+  QStringList arguments;
+  for(unsigned i=0;i<args.size();i++)
+  {
+    arguments << openstudio::toQString(args[i]);
+  }
+  QProcess process;
+  if(!workingDir.empty())
+  {
+    process.setWorkingDirectory(openstudio::toQString(workingDir));
+  }
+  process.start(openstudio::toQString(exe), arguments);
+  if(!process.waitForStarted(-1))
+  {
+    error = "Failed to start " + label + " process (" + openstudio::toString(exe) + ").";
+    return false;
+  }
+  if(!process.waitForFinished(-1))
+  {
+    error = "Failed to complete " + label + " process.";
+    return false;
+  }
+  if(process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0)
+  {
+    std::stringstream message;
+    message << label << " failed with exit code " << process.exitCode() << ".";
+    error = message.str();
+    return false;
+  }
+  return true;
+}
+
+} // contamutils
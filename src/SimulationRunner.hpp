@@ -0,0 +1,73 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_SIMULATIONRUNNER_HPP
+#define CONTAMUTILITIES_SIMULATIONRUNNER_HPP
+
+#include <utilities/core/Path.hpp>
+
+#include <string>
+#include <vector>
+
+namespace contamutils {
+
+// Runs ContamX and SimReadX. Each executable comes from the first of these
+// that names it: the command line, an environment variable (CONTAM_CONTAMX,
+// CONTAM_SIMREADX), a config file given on the command line or in
+// CONTAM_CONFIG, and finally the bare program name, found on the PATH. The
+// config file has one "contamx = path" or "simreadx = path" per line, and
+// lines starting with # are comments. Relative paths are made absolute, the
+// ones in the config file against the config file's directory and the others
+// against the current directory, so that they still work when a run has its
+// own working directory. The run functions don't change the runner, so one
+// runner can be shared by several threads.
+class SimulationRunner
+{
+public:
+  SimulationRunner();
+
+  // Set up from the command line values (empty if not given), returns false if
+  // a config file was named but couldn't be read
+  bool configure(const std::string &contamx, const std::string &simreadx, const std::string &configFile);
+
+  void setContamX(const openstudio::path &exe);
+  void setSimReadX(const openstudio::path &exe);
+  openstudio::path contamX() const;
+  openstudio::path simReadX() const;
+  std::string errorMessage() const;
+
+  // Simulate a PRJ, ContamX writes its results next to it
+  bool runContamX(const openstudio::path &prjPath, std::string &error,
+    const openstudio::path &workingDir=openstudio::path()) const;
+  // Convert the results of a PRJ to text with SimReadX
+  bool runSimReadX(const openstudio::path &prjPath, std::string &error,
+    const openstudio::path &workingDir=openstudio::path()) const;
+
+private:
+  bool run(const openstudio::path &exe, const std::vector<std::string> &args, const openstudio::path &workingDir,
+    const std::string &label, std::string &error) const;
+
+  openstudio::path m_contamx;
+  openstudio::path m_simreadx;
+  std::string m_error;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_SIMULATIONRUNNER_HPP
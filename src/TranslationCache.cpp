@@ -0,0 +1,352 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "TranslationCache.hpp"
+#include "Hash.hpp"
+#include "PrjWriter.hpp"
+
+#include <OpenStudio.hxx>
+
+#include <model/WeatherFile.hpp>
+
+#include <utilities/time/Date.hpp>
+#include <utilities/time/Time.hpp>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace contamutils {
+
+// Change this whenever what goes into an entry changes
+static const char *CACHE_VERSION = "TranslationCache 1";
+
+static void writeDateTime(std::ostream &out, const char *label, const boost::optional<openstudio::DateTime> &dateTime)
+{
+  if(dateTime)
+  {
+    openstudio::Date date = dateTime->date();
+    openstudio::Time time = dateTime->time();
+    out << label << '\t' << date.year() << '\t' << date.monthOfYear().value() << '\t' << date.dayOfMonth() << '\t'
+      << time.hours() << '\t' << time.minutes() << '\t' << time.seconds() << std::endl;
+  }
+}
+
+static boost::optional<openstudio::DateTime> readDateTime(std::istream &in)
+{
+  int year, month, day, hours, minutes, seconds;
+  if(!(in >> year >> month >> day >> hours >> minutes >> seconds) || month < 1 || month > 12)
+  {
+    return boost::none;
+  }
+  return openstudio::DateTime(openstudio::Date(openstudio::MonthOfYear(month),day,year),
+    openstudio::Time(0,hours,minutes,seconds));
+}
+
+static void writeMap(std::ostream &out, const char *label, const std::map<openstudio::Handle,int> &map)
+{
+  for(std::map<openstudio::Handle,int>::const_iterator iter=map.begin();iter!=map.end();++iter)
+  {
+    out << label << '\t' << openstudio::toString(iter->first) << '\t' << iter->second << std::endl;
+  }
+}
+
+TranslatorSettings::TranslatorSettings() : setLevel(true), level("Average"), flow(27.1), translateHVAC(true)
+{
+}
+
+void TranslatorSettings::apply(openstudio::contam::ForwardTranslator &translator) const
+{
+  if(setLevel)
+  {
+    translator.setAirtightnessLevel(level);
+  }
+  else
+  {
+    translator.setExteriorFlowRate(flow,0.65,75.0);
+  }
+  if(returnSupplyRatio)
+  {
+    translator.setReturnSupplyRatio(*returnSupplyRatio);
+  }
+  translator.setTranslateHVAC(translateHVAC);
+}
+
+std::string TranslatorSettings::toString() const
+{
+  std::stringstream stream;
+  stream.precision(17);
+  if(setLevel)
+  {
+    stream << "level=" << level;
+  }
+  else
+  {
+    stream << "flow=" << flow;
+  }
+  stream << ";hvac=" << translateHVAC << ";rsr=";
+  if(returnSupplyRatio)
+  {
+    stream << *returnSupplyRatio;
+  }
+  else
+  {
+    stream << "default";
+  }
+  return stream.str();
+}
+
+Translation::Translation()
+{
+}
+
+Translation::Translation(const openstudio::contam::IndexModel &model,
+  const openstudio::contam::ForwardTranslator &translator, const openstudio::model::Model &osm)
+  : model(model), zoneMap(translator.zoneMap()), surfaceMap(translator.surfaceMap()),
+  startDateTime(translator.startDateTime()), endDateTime(translator.endDateTime())
+{
+  boost::optional<openstudio::model::WeatherFile> weatherFile = osm.weatherFile();
+  if(weatherFile)
+  {
+    weatherPath = weatherFile->path();
+  }
+}
+
+bool translateModel(const openstudio::model::Model &model, const TranslatorSettings &settings,
+  const openstudio::path &cvfPath, Translation &translation, std::string &error)
+{
+  openstudio::contam::ForwardTranslator translator;
+  settings.apply(translator);
+  boost::optional<openstudio::contam::IndexModel> cx = translator.translateModel(model);
+  if(!cx)
+  {
+    error = "Translation failed, check errors and warnings for more information.";
+    return false;
+  }
+  if(!cx->valid())
+  {
+    error = "Translation returned an invalid model, check errors and warnings for more information.";
+    return false;
+  }
+  translation = Translation(*cx,translator,model);
+  if(!cvfPath.empty() && translator.writeCvFile(cvfPath))
+  {
+    translation.cvfPath = cvfPath;
+  }
+  return true;
+}
+
+TranslationCache::TranslationCache(const openstudio::path &directory) : m_directory(directory)
+{
+}
+
+std::string TranslationCache::errorMessage() const
+{
+  return m_error;
+}
+
+boost::optional<openstudio::path> TranslationCache::defaultDirectory()
+{
+  const char *value = std::getenv("CONTAM_TRANSLATION_CACHE");
+  if(value && *value)
+  {
+    return boost::optional<openstudio::path>(openstudio::toPath(value));
+  }
+  return boost::none;
+}
+
+bool TranslationCache::fail(const std::string &message)
+{
+  m_error = message;
+  return false;
+}
+
+std::string TranslationCache::key(const openstudio::path &osmPath, const boost::optional<openstudio::path> &sqlPath,
+  const TranslatorSettings &settings)
+{
+  boost::uint64_t hash = FNV1A_BASIS;
+  fnv1a(hash,CACHE_VERSION);
+  // A different OpenStudio can translate the same model differently
+  fnv1a(hash,"openstudio:" + openstudio::openStudioVersion());
+  fnv1a(hash,settings.toString());
+  boost::uint64_t size;
+  if(!fnv1aFile(hash,openstudio::toString(osmPath),size))
+  {
+    return std::string();
+  }
+  // The results can be huge, so go by their size and time rather than contents
+  if(sqlPath)
+  {
+    boost::system::error_code ec;
+    std::stringstream stream;
+    stream << "sql:" << boost::filesystem::file_size(*sqlPath,ec) << ':'
+      << boost::filesystem::last_write_time(*sqlPath,ec);
+    fnv1a(hash,stream.str());
+  }
+  char key[64];
+  std::sprintf(key,"%016llx-%llu",(unsigned long long)hash,(unsigned long long)size);
+  return std::string(key);
+}
+
+bool TranslationCache::load(const std::string &key, const openstudio::path &cvfPath, Translation &translation)
+{
+  m_error.clear();
+  openstudio::path mapsPath = m_directory / openstudio::toPath(key + ".maps");
+  openstudio::path prjPath = m_directory / openstudio::toPath(key + ".prj");
+  std::ifstream maps(openstudio::toString(mapsPath).c_str());
+  if(!maps.good())
+  {
+    return fail("No cached translation");
+  }
+  std::string line;
+  if(!std::getline(maps,line) || line != CACHE_VERSION)
+  {
+    return fail("Cached translation is from a different version");
+  }
+  Translation loaded;
+  bool haveCvf = false;
+  while(std::getline(maps,line))
+  {
+    std::string::size_type tab = line.find('\t');
+    std::string label = line.substr(0,tab);
+    std::string rest = tab == std::string::npos ? std::string() : line.substr(tab+1);
+    std::istringstream fields(rest);
+    if(label == "zone" || label == "surface")
+    {
+      std::string handle;
+      int nr;
+      if(!(fields >> handle >> nr))
+      {
+        return fail("Bad map entry in cached translation");
+      }
+      (label == "zone" ? loaded.zoneMap : loaded.surfaceMap)[openstudio::toUUID(handle)] = nr;
+    }
+    else if(label == "start" || label == "end")
+    {
+      boost::optional<openstudio::DateTime> dateTime = readDateTime(fields);
+      if(!dateTime)
+      {
+        return fail("Bad run period in cached translation");
+      }
+      (label == "start" ? loaded.startDateTime : loaded.endDateTime) = dateTime;
+    }
+    else if(label == "weather")
+    {
+      loaded.weatherPath = openstudio::toPath(rest);
+    }
+    else if(label == "cvf")
+    {
+      haveCvf = true;
+    }
+  }
+  openstudio::contam::IndexModel model(prjPath);
+  if(!model.valid())
+  {
+    return fail("Failed to read cached PRJ '" + openstudio::toString(prjPath) + "'");
+  }
+  loaded.model = model;
+  if(haveCvf && !cvfPath.empty())
+  {
+    boost::system::error_code ec;
+    boost::filesystem::copy_file(m_directory / openstudio::toPath(key + ".cvf"),cvfPath,
+      boost::filesystem::copy_option::overwrite_if_exists,ec);
+    if(ec)
+    {
+      return fail("Failed to copy cached CVF to '" + openstudio::toString(cvfPath) + "'");
+    }
+    loaded.cvfPath = cvfPath;
+  }
+  translation = loaded;
+  return true;
+}
+
+bool TranslationCache::moveIntoPlace(const openstudio::path &temporary, const openstudio::path &target)
+{
+  boost::system::error_code ec;
+  boost::filesystem::rename(temporary,target,ec);
+  if(ec)
+  {
+    boost::filesystem::remove(temporary,ec);
+    // Someone else may have beaten us to it, which is just fine
+    if(!boost::filesystem::exists(target))
+    {
+      return fail("Failed to move '" + openstudio::toString(target) + "' into the translation cache");
+    }
+  }
+  return true;
+}
+
+bool TranslationCache::store(const std::string &key, const Translation &translation)
+{
+  m_error.clear();
+  if(!translation.model)
+  {
+    return fail("No translated model to store");
+  }
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(m_directory,ec);
+  if(ec)
+  {
+    return fail("Failed to create translation cache directory '" + openstudio::toString(m_directory) + "'");
+  }
+  openstudio::path temporary = m_directory / boost::filesystem::unique_path(key + "-%%%%-%%%%.tmp");
+  if(translation.cvfPath)
+  {
+    boost::filesystem::copy_file(*translation.cvfPath,temporary,ec);
+    if(ec || !moveIntoPlace(temporary,m_directory / openstudio::toPath(key + ".cvf")))
+    {
+      boost::filesystem::remove(temporary,ec);
+      return fail("Failed to store the CVF in the translation cache");
+    }
+  }
+  if(!writePrj(*translation.model,temporary)
+    || !moveIntoPlace(temporary,m_directory / openstudio::toPath(key + ".prj")))
+  {
+    boost::filesystem::remove(temporary,ec);
+    return fail("Failed to store the PRJ in the translation cache");
+  }
+  {
+    std::ofstream maps(openstudio::toString(temporary).c_str());
+    maps << CACHE_VERSION << std::endl;
+    writeDateTime(maps,"start",translation.startDateTime);
+    writeDateTime(maps,"end",translation.endDateTime);
+    if(translation.weatherPath)
+    {
+      maps << "weather\t" << openstudio::toString(*translation.weatherPath) << std::endl;
+    }
+    if(translation.cvfPath)
+    {
+      maps << "cvf" << std::endl;
+    }
+    writeMap(maps,"zone",translation.zoneMap);
+    writeMap(maps,"surface",translation.surfaceMap);
+    if(!maps.good())
+    {
+      maps.close();
+      boost::filesystem::remove(temporary,ec);
+      return fail("Failed to write the maps to the translation cache");
+    }
+  }
+  return moveIntoPlace(temporary,m_directory / openstudio::toPath(key + ".maps"));
+}
+
+} // contamutils
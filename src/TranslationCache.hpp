@@ -0,0 +1,113 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_TRANSLATIONCACHE_HPP
+#define CONTAMUTILITIES_TRANSLATIONCACHE_HPP
+
+#include <airflow/contam/ForwardTranslator.hpp>
+
+#include <model/Model.hpp>
+
+#include <utilities/core/Path.hpp>
+#include <utilities/core/UUID.hpp>
+#include <utilities/time/DateTime.hpp>
+
+#include <boost/optional.hpp>
+
+#include <map>
+#include <string>
+
+namespace contamutils {
+
+// The translator settings that change the translated model. Every tool sets
+// up its translator through apply(), so the cache key always matches what the
+// translator was actually asked to do.
+struct TranslatorSettings
+{
+  TranslatorSettings();
+
+  bool setLevel;                             // Use the airtightness level, otherwise the flow
+  std::string level;                         // Leaky|Average|Tight
+  double flow;                               // Leakage per envelope area [m^3/h/m^2]
+  boost::optional<double> returnSupplyRatio; // Translator default if not set
+  bool translateHVAC;
+
+  void apply(openstudio::contam::ForwardTranslator &translator) const;
+  std::string toString() const;
+};
+
+// What the tools need from a translation, whether it just happened or came
+// out of the cache
+struct Translation
+{
+  Translation();
+  // Everything from a translator that has just translated a model
+  Translation(const openstudio::contam::IndexModel &model, const openstudio::contam::ForwardTranslator &translator,
+    const openstudio::model::Model &osm);
+
+  boost::optional<openstudio::contam::IndexModel> model;
+  std::map<openstudio::Handle,int> zoneMap;
+  std::map<openstudio::Handle,int> surfaceMap;
+  boost::optional<openstudio::DateTime> startDateTime;
+  boost::optional<openstudio::DateTime> endDateTime;
+  boost::optional<openstudio::path> weatherPath; // As given by the OSM, not yet looked for
+  boost::optional<openstudio::path> cvfPath;     // Where the CVF was written, if there is one
+};
+
+// Translate a model, writing the CVF to cvfPath if the translator makes one
+// (an empty cvfPath skips the CVF)
+bool translateModel(const openstudio::model::Model &model, const TranslatorSettings &settings,
+  const openstudio::path &cvfPath, Translation &translation, std::string &error);
+
+// A directory of translated models keyed by a hash of the OSM contents, the
+// EnergyPlus results attached to it, the translator settings and the OpenStudio
+// version, so that running several tools on one model only translates it once. An entry is a
+// PRJ, the maps and run period (.maps) and the CVF if there was one. Entries
+// are written to temporary files and renamed into place, and the .maps file
+// goes last, so a reader never sees half of one.
+class TranslationCache
+{
+public:
+  explicit TranslationCache(const openstudio::path &directory);
+
+  // The key for a model, empty if the OSM can't be read
+  static std::string key(const openstudio::path &osmPath, const boost::optional<openstudio::path> &sqlPath,
+    const TranslatorSettings &settings);
+
+  // Load an entry, copying its CVF (if any) to cvfPath unless that is empty
+  bool load(const std::string &key, const openstudio::path &cvfPath, Translation &translation);
+  // Store a translation, the CVF is taken from translation.cvfPath
+  bool store(const std::string &key, const Translation &translation);
+
+  std::string errorMessage() const;
+
+  // The cache directory from the CONTAM_TRANSLATION_CACHE environment variable, if set
+  static boost::optional<openstudio::path> defaultDirectory();
+
+private:
+  bool fail(const std::string &message);
+  bool moveIntoPlace(const openstudio::path &temporary, const openstudio::path &target);
+
+  openstudio::path m_directory;
+  std::string m_error;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_TRANSLATIONCACHE_HPP
@@ -0,0 +1,273 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "WindRose.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace contamutils {
+
+// Change this whenever what goes into the cache changes
+static const char *CACHE_VERSION = "WindRose 1";
+
+// Field positions in an EPW data record
+static const int WIND_DIRECTION = 20;
+static const int WIND_SPEED = 21;
+
+WindRose::WindRose() : m_records(0)
+{
+}
+
+std::string WindRose::errorMessage() const
+{
+  return m_error;
+}
+
+bool WindRose::fail(const std::string &message)
+{
+  m_error = message;
+  return false;
+}
+
+openstudio::path WindRose::cachePath(const openstudio::path &epwPath)
+{
+  return openstudio::toPath(openstudio::toString(epwPath) + ".windrose");
+}
+
+bool WindRose::read(const openstudio::path &epwPath)
+{
+  std::ifstream epw(openstudio::toString(epwPath).c_str());
+  if(!epw.good())
+  {
+    return fail("Failed to open EPW file '" + openstudio::toString(epwPath) + "'");
+  }
+  return read(epw);
+}
+
+bool WindRose::read(std::istream &epw)
+{
+  m_counts.clear();
+  m_records = 0;
+  m_error.clear();
+  std::string line;
+  for(int i=0;i<8;i++)
+  {
+    if(!std::getline(epw,line))
+    {
+      return fail("Incomplete EPW header");
+    }
+  }
+  while(std::getline(epw,line))
+  {
+    // Find the two wind fields without splitting the whole record
+    const char *fields[WIND_SPEED+1];
+    int nfields = 0;
+    fields[nfields++] = line.c_str();
+    for(const char *ptr=line.c_str();*ptr && nfields<=WIND_SPEED;ptr++)
+    {
+      if(*ptr == ',')
+      {
+        fields[nfields++] = ptr+1;
+      }
+    }
+    if(nfields <= WIND_SPEED)
+    {
+      continue;
+    }
+    double direction = std::strtod(fields[WIND_DIRECTION],0);
+    double speed = std::strtod(fields[WIND_SPEED],0);
+    if(direction >= 999.0 || direction < 0.0 || speed >= 999.0 || speed < 0.0)
+    {
+      continue;
+    }
+    int degrees = (int)std::floor(direction + 0.5) % 360;
+    int tenths = (int)std::floor(10.0*speed + 0.5);
+    m_counts[std::make_pair(degrees,tenths)]++;
+    m_records++;
+  }
+  if(m_records == 0)
+  {
+    return fail("No wind records found");
+  }
+  return true;
+}
+
+bool WindRose::load(const openstudio::path &epwPath)
+{
+  // The EPW can be big, so go by its size and time rather than its contents
+  boost::system::error_code ec;
+  std::stringstream stamp;
+  stamp << boost::filesystem::file_size(epwPath,ec) << '\t' << boost::filesystem::last_write_time(epwPath,ec);
+  if(ec)
+  {
+    return fail("Failed to find EPW file '" + openstudio::toString(epwPath) + "'");
+  }
+  openstudio::path cache = cachePath(epwPath);
+  if(readCache(cache,stamp.str()))
+  {
+    return true;
+  }
+  if(!read(epwPath))
+  {
+    return false;
+  }
+  writeCache(cache,stamp.str());
+  return true;
+}
+
+bool WindRose::readCache(const openstudio::path &cachePath, const std::string &stamp)
+{
+  std::ifstream in(openstudio::toString(cachePath).c_str());
+  std::string line;
+  if(!std::getline(in,line) || line != CACHE_VERSION || !std::getline(in,line) || line != stamp)
+  {
+    return false;
+  }
+  std::map<std::pair<int,int>,unsigned long> counts;
+  unsigned long records = 0;
+  int degrees, tenths;
+  unsigned long count;
+  while(in >> degrees >> tenths >> count)
+  {
+    counts[std::make_pair(degrees,tenths)] += count;
+    records += count;
+  }
+  if(!in.eof() || records == 0)
+  {
+    return false;
+  }
+  m_counts.swap(counts);
+  m_records = records;
+  m_error.clear();
+  return true;
+}
+
+void WindRose::writeCache(const openstudio::path &cachePath, const std::string &stamp) const
+{
+  // Written to the side and renamed into place, so a reader never sees half a file
+  boost::system::error_code ec;
+  openstudio::path temporary = cachePath.parent_path()
+    / boost::filesystem::unique_path(cachePath.filename().string() + "-%%%%-%%%%.tmp");
+  {
+    std::ofstream out(openstudio::toString(temporary).c_str());
+    out << CACHE_VERSION << '\n' << stamp << '\n';
+    for(std::map<std::pair<int,int>,unsigned long>::const_iterator iter=m_counts.begin();iter!=m_counts.end();++iter)
+    {
+      out << iter->first.first << '\t' << iter->first.second << '\t' << iter->second << '\n';
+    }
+    if(!out.good())
+    {
+      out.close();
+      boost::filesystem::remove(temporary,ec);
+      return;
+    }
+  }
+  boost::filesystem::rename(temporary,cachePath,ec);
+  if(ec)
+  {
+    boost::filesystem::remove(temporary,ec);
+  }
+}
+
+unsigned long WindRose::records() const
+{
+  return m_records;
+}
+
+double WindRose::maxSpeed() const
+{
+  int tenths = 0;
+  for(std::map<std::pair<int,int>,unsigned long>::const_iterator iter=m_counts.begin();iter!=m_counts.end();++iter)
+  {
+    if(iter->first.second > tenths)
+    {
+      tenths = iter->first.second;
+    }
+  }
+  return tenths/10.0;
+}
+
+double WindRose::probability(double low, double high) const
+{
+  if(m_records == 0)
+  {
+    return 0.0;
+  }
+  unsigned long count = 0;
+  for(std::map<std::pair<int,int>,unsigned long>::const_iterator iter=m_counts.begin();iter!=m_counts.end();++iter)
+  {
+    double speed = iter->first.second/10.0;
+    if(speed >= low && speed < high)
+    {
+      count += iter->second;
+    }
+  }
+  return (double)count/(double)m_records;
+}
+
+std::vector<double> WindRose::sectorProbabilities(int ndirs, double low, double high) const
+{
+  if(ndirs < 1)
+  {
+    return std::vector<double>();
+  }
+  std::vector<double> p(ndirs,0.0);
+  if(m_records == 0)
+  {
+    return p;
+  }
+  double width = 360.0/(double)ndirs;
+  for(std::map<std::pair<int,int>,unsigned long>::const_iterator iter=m_counts.begin();iter!=m_counts.end();++iter)
+  {
+    double speed = iter->first.second/10.0;
+    if(speed >= low && speed < high)
+    {
+      int sector = (int)std::floor((iter->first.first + 0.5*width)/width) % ndirs;
+      p[sector] += iter->second;
+    }
+  }
+  for(int j=0;j<ndirs;j++)
+  {
+    p[j] /= (double)m_records;
+  }
+  return p;
+}
+
+double WindRose::meanSpeed(double low, double high) const
+{
+  unsigned long count = 0;
+  double sum = 0.0;
+  for(std::map<std::pair<int,int>,unsigned long>::const_iterator iter=m_counts.begin();iter!=m_counts.end();++iter)
+  {
+    double speed = iter->first.second/10.0;
+    if(speed >= low && speed < high)
+    {
+      count += iter->second;
+      sum += iter->second*speed;
+    }
+  }
+  return count > 0 ? sum/(double)count : 0.0;
+}
+
+} // contamutils
@@ -0,0 +1,80 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_WINDROSE_HPP
+#define CONTAMUTILITIES_WINDROSE_HPP
+
+#include <utilities/core/Path.hpp>
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace contamutils {
+
+// The joint distribution of wind speed and direction at a site, from the
+// records of an EPW file. The records are streamed one line at a time and
+// counted at the resolution of the file (whole degrees and tenths of a m/s),
+// so one pass over the file serves any number of direction sectors and any
+// speed bins. load() keeps the counts in a small file next to the EPW and
+// reuses them for as long as the EPW doesn't change.
+class WindRose
+{
+public:
+  WindRose();
+
+  bool read(const openstudio::path &epwPath);
+  bool read(std::istream &epw);
+  // Use the counts cached next to the EPW if they are current, otherwise read
+  // the EPW and cache them. Failing to write the cache isn't an error.
+  bool load(const openstudio::path &epwPath);
+
+  // Number of records with a usable wind speed and direction
+  unsigned long records() const;
+  // Fastest wind speed in the records [m/s]
+  double maxSpeed() const;
+  // Fraction of the records with a speed in [low,high) [m/s]
+  double probability(double low, double high) const;
+  // Fraction of the records with a speed in [low,high) in each of ndirs
+  // direction sectors, sector j centered on j*360/ndirs degrees
+  std::vector<double> sectorProbabilities(int ndirs, double low, double high) const;
+  // Mean speed of the records with a speed in [low,high), zero if there are none
+  double meanSpeed(double low, double high) const;
+
+  std::string errorMessage() const;
+
+  // Where load() caches the counts for an EPW file
+  static openstudio::path cachePath(const openstudio::path &epwPath);
+
+private:
+  bool readCache(const openstudio::path &cachePath, const std::string &stamp);
+  void writeCache(const openstudio::path &cachePath, const std::string &stamp) const;
+  bool fail(const std::string &message);
+
+  // Record count by (degrees, tenths of a m/s)
+  std::map<std::pair<int,int>,unsigned long> m_counts;
+  unsigned long m_records;
+  std::string m_error;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_WINDROSE_HPP
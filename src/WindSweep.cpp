@@ -0,0 +1,317 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "WindSweep.hpp"
+#include "ContamNetwork.hpp"
+#include "JobQueue.hpp"
+#include "PrjWriter.hpp"
+
+#include <airflow/contam/SimFile.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+
+#include <QString>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace contamutils {
+
+WindSweep::WindSweep(const openstudio::contam::IndexModel &model, const SimulationRunner &runner)
+  : m_model(model), m_runner(runner), m_scratch(openstudio::toPath("sweep")),
+  m_solver(ContamX), m_jobs(0), m_verbose(true), m_profiler(0), m_Tambt(0.0), m_windspd(0.0), m_winddir(0.0),
+  m_simAf(0), m_results(0), m_nzones(0), m_finished(0), m_failed(false)
+{
+}
+
+void WindSweep::setSolver(Solver solver)
+{
+  m_solver = solver;
+}
+
+void WindSweep::setJobs(int jobs)
+{
+  m_jobs = jobs;
+}
+
+void WindSweep::setScratchDirectory(const openstudio::path &dir)
+{
+  m_scratch = dir;
+}
+
+void WindSweep::setVerbose(bool verbose)
+{
+  m_verbose = verbose;
+}
+
+void WindSweep::setProfiler(Profiler *profiler)
+{
+  m_profiler = profiler;
+}
+
+std::string WindSweep::errorMessage() const
+{
+  return m_error;
+}
+
+bool WindSweep::run(const std::vector<SweepCase> &cases, unsigned nzones, std::vector<std::vector<double> > &results)
+{
+  int nrows = 0;
+  for(unsigned i=0;i<cases.size();i++)
+  {
+    if(cases[i].row+1 > nrows)
+    {
+      nrows = cases[i].row+1;
+    }
+  }
+  results = std::vector<std::vector<double> >(nrows,std::vector<double>(nzones,0.0));
+
+  m_cases = cases;
+  m_Tambt = m_model.ssWeather().Tambt();
+  m_windspd = m_model.ssWeather().windspd();
+  m_winddir = m_model.ssWeather().winddir();
+  m_simAf = m_model.rc().sim_af();
+  m_results = &results;
+  m_nzones = nzones;
+  m_finished = 0;
+  m_failed = false;
+  m_error.clear();
+
+  if(m_solver == Builtin)
+  {
+    m_network = boost::shared_ptr<ContamNetwork>(new ContamNetwork(m_model));
+    if(!m_network->valid())
+    {
+      m_error = "Builtin solver setup failed: " + m_network->errorMessage();
+      m_network.reset();
+      m_results = 0;
+      return false;
+    }
+    if(m_network->zoneCount() != nzones)
+    {
+      m_error = "Unexpected number of zones in the airflow network.";
+      m_network.reset();
+      m_results = 0;
+      return false;
+    }
+  }
+  else
+  {
+    // Set the model for steady-state simulation
+    m_model.rc().setSim_af(0);
+    // Most cases only differ in the wind, so render the model once up front. Cases at another
+    // outdoor temperature are rendered in full.
+    if(!m_template.build(m_model) && m_verbose)
+    {
+      std::cout << "Writing each case in full: " << m_template.errorMessage() << std::endl;
+    }
+  }
+
+  JobQueue queue(m_jobs);
+  for(unsigned i=0;i<m_cases.size();i++)
+  {
+    queue.add(boost::bind(&WindSweep::runCase,this,i));
+  }
+  if(m_verbose)
+  {
+    std::cout << "Running " << m_cases.size() << " cases on " << queue.threadCount() << " worker(s)" << std::endl;
+  }
+  if(queue.run() > 0)
+  {
+    fail("One or more cases threw an exception");
+  }
+
+  // The model is shared with the caller, which may go on to render it
+  if(m_solver == ContamX)
+  {
+    m_model.ssWeather().setTambt(m_Tambt);
+    m_model.ssWeather().setWindspd(m_windspd);
+    m_model.ssWeather().setWinddir(m_winddir);
+    m_model.rc().setSim_af(m_simAf);
+  }
+  m_network.reset();
+  m_template = PrjTemplate();
+  m_results = 0;
+  return !m_failed;
+}
+
+bool WindSweep::failed()
+{
+  boost::mutex::scoped_lock lock(m_resultsMutex);
+  return m_failed;
+}
+
+void WindSweep::fail(const std::string &message)
+{
+  boost::mutex::scoped_lock lock(m_resultsMutex);
+  if(!m_failed)
+  {
+    m_failed = true;
+    m_error = message;
+  }
+}
+
+bool WindSweep::runBuiltin(const SweepCase &sweepCase, std::vector<double> &infiltration)
+{
+  ProfilePhase phase(m_profiler,"builtin_solve");
+  double Tambt = sweepCase.temperature > 0.0 ? sweepCase.temperature : m_Tambt;
+  double barpres;
+  {
+    boost::mutex::scoped_lock lock(m_modelMutex);
+    barpres = m_model.ssWeather().barpres();
+  }
+  if(!m_network->zoneInfiltration(sweepCase.speed,sweepCase.direction,Tambt,barpres,infiltration))
+  {
+    std::stringstream message;
+    message << "Builtin solver failed to converge (speed " << sweepCase.speed << ", direction "
+      << sweepCase.direction << ")";
+    fail(message.str());
+    return false;
+  }
+  return true;
+}
+
+bool WindSweep::runContamX(unsigned index, std::vector<double> &infiltration)
+{
+  const SweepCase &sweepCase = m_cases[index];
+  openstudio::path dir = m_scratch / openstudio::toPath(QString("case-%1").arg(index).toStdString());
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(dir,ec);
+  if(ec)
+  {
+    fail("Failed to create scratch directory '" + openstudio::toString(dir) + "'.");
+    return false;
+  }
+  std::string fileName = QString("temporary-%1-%2.prj").arg(sweepCase.speed).arg(sweepCase.direction).toStdString();
+  openstudio::path prjPath = dir / openstudio::toPath(fileName);
+
+  ProfilePhase writePhase(m_profiler,"prj_write");
+  std::ofstream file(openstudio::toString(prjPath).c_str(),std::ios::out|std::ios::binary);
+  bool written = false;
+  if(m_template.valid() && sweepCase.temperature <= 0.0)
+  {
+    written = file.good() && m_template.write(file,sweepCase.speed,sweepCase.direction);
+  }
+  else
+  {
+    // The model is shared by all the workers, so only touch it with the lock held
+    std::string prj;
+    {
+      boost::mutex::scoped_lock lock(m_modelMutex);
+      m_model.ssWeather().setWindspd(sweepCase.speed);
+      m_model.ssWeather().setWinddir(sweepCase.direction);
+      m_model.ssWeather().setTambt(sweepCase.temperature > 0.0 ? sweepCase.temperature : m_Tambt);
+      prj = m_model.toString();
+    }
+    written = file.good() && writePrj(prj,file);
+  }
+  if(!written)
+  {
+    fail("Failed to write file '" + openstudio::toString(prjPath) + "'.");
+    return false;
+  }
+  file.close();
+  writePhase.stop();
+
+  std::string error;
+  ProfilePhase contamxPhase(m_profiler,"contamx");
+  if(!m_runner.runContamX(openstudio::toPath(fileName),error,dir))
+  {
+    fail(error);
+    return false;
+  }
+  contamxPhase.stop();
+  //
+  // Get the results as text from SimReadX
+  //
+  ProfilePhase simreadxPhase(m_profiler,"simreadx");
+  if(!m_runner.runSimReadX(openstudio::toPath(fileName),error,dir))
+  {
+    fail(error);
+    return false;
+  }
+  simreadxPhase.stop();
+
+  ProfilePhase parsePhase(m_profiler,"sim_parse");
+  openstudio::path simPath = prjPath;
+  simPath.replace_extension(openstudio::toPath("sim").string());
+  openstudio::contam::SimFile sim(simPath);
+  std::vector<openstudio::TimeSeries> series;
+  {
+    boost::mutex::scoped_lock lock(m_modelMutex);
+    series = m_model.zoneInfiltration(&sim);
+  }
+  infiltration.clear();
+  for(unsigned k=0;k<series.size();k++)
+  {
+    // Check to make sure the values vector has 1 entry
+    if(series[k].values().size() != 1)
+    {
+      fail("Unexpected time series data.");
+      return false;
+    }
+    infiltration.push_back(series[k].value(0));
+  }
+  return true;
+}
+
+void WindSweep::runCase(unsigned index)
+{
+  if(failed())
+  {
+    // Something else already went wrong, don't bother
+    return;
+  }
+  const SweepCase &sweepCase = m_cases[index];
+  std::vector<double> infiltration;
+  if(m_solver == Builtin)
+  {
+    if(!runBuiltin(sweepCase,infiltration))
+    {
+      return;
+    }
+  }
+  else if(!runContamX(index,infiltration))
+  {
+    return;
+  }
+  if(infiltration.size() != m_nzones)
+  {
+    fail("Unexpected number of zones in case results.");
+    return;
+  }
+
+  // Reduce the results into the shared matrix
+  boost::mutex::scoped_lock lock(m_resultsMutex);
+  std::vector<double> &row = (*m_results)[sweepCase.row];
+  for(unsigned k=0;k<infiltration.size();k++)
+  {
+    row[k] += sweepCase.weight*infiltration[k];
+  }
+  m_finished++;
+  if(m_verbose)
+  {
+    std::cout << "Finished case " << m_finished << " of " << m_cases.size() << " (speed " << sweepCase.speed
+      << ", direction " << sweepCase.direction << ")" << std::endl;
+  }
+}
+
+} // contamutils
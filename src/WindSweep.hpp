@@ -0,0 +1,114 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_WINDSWEEP_HPP
+#define CONTAMUTILITIES_WINDSWEEP_HPP
+
+#include "PrjWriter.hpp"
+#include "Profiler.hpp"
+#include "SimulationRunner.hpp"
+
+#include <airflow/contam/ForwardTranslator.hpp>
+#include <utilities/core/Path.hpp>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <string>
+#include <vector>
+
+namespace contamutils {
+
+class ContamNetwork;
+
+// One steady-state simulation in a sweep. The zone infiltration from the case
+// is multiplied by the weight and added into the given row of the results.
+struct SweepCase
+{
+  SweepCase(double speed, double direction, int row, double weight, double temperature=0.0)
+    : speed(speed), direction(direction), row(row), weight(weight), temperature(temperature)
+  {}
+  double speed;       // Wind speed [m/s]
+  double direction;   // Wind direction [deg]
+  int row;            // Row of the results matrix to accumulate into
+  double weight;      // Weight applied to the case results
+  double temperature; // Outdoor temperature [K], zero to keep the model's
+};
+
+// Run a set of steady-state cases concurrently. With the ContamX solver each
+// case gets its own scratch directory so that the ContamX and SimReadX outputs
+// can't collide; the builtin solver does everything in memory. In both cases
+// the zone infiltration results are reduced into the results matrix as the
+// cases finish.
+class WindSweep
+{
+public:
+  enum Solver {ContamX, Builtin};
+
+  WindSweep(const openstudio::contam::IndexModel &model, const SimulationRunner &runner);
+
+  void setSolver(Solver solver);
+  void setJobs(int jobs);
+  void setScratchDirectory(const openstudio::path &dir);
+  void setVerbose(bool verbose);
+  // Time the PRJ writes, simulations and results parsing of each case
+  void setProfiler(Profiler *profiler);
+
+  // Run the cases, results will be resized to nrows x nzones. Returns false if any case failed.
+  bool run(const std::vector<SweepCase> &cases, unsigned nzones, std::vector<std::vector<double> > &results);
+
+  std::string errorMessage() const;
+
+private:
+  void runCase(unsigned index);
+  bool runContamX(unsigned index, std::vector<double> &infiltration);
+  bool runBuiltin(const SweepCase &sweepCase, std::vector<double> &infiltration);
+  // The flag is set by whichever worker fails first, so only look at it with the lock held
+  bool failed();
+  void fail(const std::string &message);
+
+  openstudio::contam::IndexModel m_model;
+  SimulationRunner m_runner;
+  openstudio::path m_scratch;
+  Solver m_solver;
+  int m_jobs;
+  bool m_verbose;
+  Profiler *m_profiler;
+
+  // Per-run state
+  std::vector<SweepCase> m_cases;
+  // The model's own steady weather and run control, put back when the run is over
+  double m_Tambt;
+  double m_windspd;
+  double m_winddir;
+  int m_simAf;
+  boost::shared_ptr<ContamNetwork> m_network;
+  PrjTemplate m_template;
+  std::vector<std::vector<double> > *m_results;
+  unsigned m_nzones;
+  unsigned m_finished;
+  bool m_failed;
+  std::string m_error;
+  boost::mutex m_modelMutex;
+  boost::mutex m_resultsMutex;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_WINDSWEEP_HPP
@@ -0,0 +1,138 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "WthCache.hpp"
+#include "EpwToWth.hpp"
+#include "Hash.hpp"
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+namespace contamutils {
+
+WthCache::WthCache(const openstudio::path &directory) : m_directory(directory), m_hit(false)
+{
+}
+
+bool WthCache::lastWasHit() const
+{
+  return m_hit;
+}
+
+std::string WthCache::errorMessage() const
+{
+  return m_error;
+}
+
+boost::optional<openstudio::path> WthCache::defaultDirectory()
+{
+  const char *value = std::getenv("CONTAM_WTH_CACHE");
+  if(value && *value)
+  {
+    return boost::optional<openstudio::path>(openstudio::toPath(value));
+  }
+  return boost::none;
+}
+
+std::string WthCache::key(const openstudio::path &epwPath)
+{
+  boost::uint64_t hash = FNV1A_BASIS;
+  fnv1a(hash,EpwToWthConverter::version());
+  boost::uint64_t size;
+  if(!fnv1aFile(hash,openstudio::toString(epwPath),size))
+  {
+    return std::string();
+  }
+  char key[64];
+  std::sprintf(key,"%016llx-%llu",(unsigned long long)hash,(unsigned long long)size);
+  return std::string(key);
+}
+
+boost::optional<openstudio::path> WthCache::wthPath(const openstudio::path &epwPath)
+{
+  m_hit = false;
+  m_error.clear();
+  std::string cacheKey = key(epwPath);
+  if(cacheKey.empty())
+  {
+    m_error = "Failed to read EPW file '" + openstudio::toString(epwPath) + "'";
+    return boost::none;
+  }
+  openstudio::path cached = m_directory / openstudio::toPath(cacheKey + ".wth");
+  if(boost::filesystem::exists(cached))
+  {
+    m_hit = true;
+    return boost::optional<openstudio::path>(cached);
+  }
+
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(m_directory,ec);
+  if(ec)
+  {
+    m_error = "Failed to create WTH cache directory '" + openstudio::toString(m_directory) + "'";
+    return boost::none;
+  }
+  // Convert into a temporary and move it into place when done, so that nobody
+  // else can ever see a partially written file
+  openstudio::path temporary = m_directory / boost::filesystem::unique_path(cacheKey + "-%%%%-%%%%.tmp");
+  EpwToWthConverter converter;
+  if(!converter.convert(openstudio::toString(epwPath),openstudio::toString(temporary)))
+  {
+    m_error = converter.errorMessage();
+    boost::filesystem::remove(temporary,ec);
+    return boost::none;
+  }
+  boost::filesystem::rename(temporary,cached,ec);
+  if(ec)
+  {
+    boost::filesystem::remove(temporary,ec);
+    // Someone else may have beaten us to it, which is just fine
+    if(!boost::filesystem::exists(cached))
+    {
+      m_error = "Failed to move converted WTH file into the cache";
+      return boost::none;
+    }
+  }
+  return boost::optional<openstudio::path>(cached);
+}
+
+bool WthCache::linkTo(const openstudio::path &cachedPath, const openstudio::path &target)
+{
+  boost::system::error_code ec;
+  boost::filesystem::remove(target,ec);
+  boost::filesystem::create_hard_link(cachedPath,target,ec);
+  if(!ec)
+  {
+    return true;
+  }
+  // Different volume or no hard link support, so copy it instead
+  boost::filesystem::copy_file(cachedPath,target,ec);
+  if(ec)
+  {
+    m_error = "Failed to link or copy '" + openstudio::toString(cachedPath) + "' to '" + openstudio::toString(target) + "'";
+    return false;
+  }
+  return true;
+}
+
+} // contamutils
@@ -0,0 +1,62 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#ifndef CONTAMUTILITIES_WTHCACHE_HPP
+#define CONTAMUTILITIES_WTHCACHE_HPP
+
+#include <utilities/core/Path.hpp>
+
+#include <boost/optional.hpp>
+
+#include <string>
+
+namespace contamutils {
+
+// A directory of converted WTH files named by a hash of the EPW contents and
+// the converter version, so that every model that uses the same weather file
+// shares a single conversion. New entries are written to a temporary file and
+// renamed into place, so several processes can share one cache directory.
+class WthCache
+{
+public:
+  explicit WthCache(const openstudio::path &directory);
+
+  // Return the cached WTH for an EPW file, converting it first if needed
+  boost::optional<openstudio::path> wthPath(const openstudio::path &epwPath);
+  // Hard link a cached WTH to another location, falls back on a copy
+  bool linkTo(const openstudio::path &cachedPath, const openstudio::path &target);
+
+  // True if the last successful lookup was already in the cache
+  bool lastWasHit() const;
+  std::string errorMessage() const;
+
+  // The cache key for an EPW file, empty if the file can't be read
+  static std::string key(const openstudio::path &epwPath);
+  // The cache directory from the CONTAM_WTH_CACHE environment variable, if set
+  static boost::optional<openstudio::path> defaultDirectory();
+
+private:
+  openstudio::path m_directory;
+  bool m_hit;
+  std::string m_error;
+};
+
+} // contamutils
+
+#endif // CONTAMUTILITIES_WTHCACHE_HPP
@@ -18,8 +18,20 @@
  *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  **********************************************************************/
 
+#include "AirflowView.hpp"
+#include "ContamResults.hpp"
+#include "EpwToWth.hpp"
+#include "FileLocator.hpp"
+#include "FlowConversion.hpp"
+#include "InfiltrationFile.hpp"
+#include "PrjWriter.hpp"
+#include "Profiler.hpp"
+#include "ScheduleGrid.hpp"
+#include "SimulationRunner.hpp"
+#include "TranslationCache.hpp"
+#include "WthCache.hpp"
+
 #include <airflow/contam/ForwardTranslator.hpp>
-#include <airflow/contam/SimFile.hpp>
 
 #include <model/Model.hpp>
 #include <model/Space.hpp>
@@ -27,9 +39,9 @@
 #include <model/ThermalZone.hpp>
 #include <model/WeatherFile.hpp>
 #include <model/ScheduleFixedInterval.hpp>
-#include <osversion/VersionTranslator.hpp>
 #include <utilities/core/CommandLine.hpp>
 #include <utilities/core/Path.hpp>
+#include <utilities/data/Vector.hpp>
 #include <utilities/sql/SqlFile.hpp>
 
 #include <model/SpaceInfiltrationDesignFlowRate.hpp>
@@ -37,8 +49,7 @@
 #include <model/SpaceInfiltrationEffectiveLeakageArea.hpp>
 #include <model/SpaceInfiltrationEffectiveLeakageArea_Impl.hpp>
 
-#include <QProcess>
-
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <fstream>
@@ -50,75 +61,66 @@ void usage( boost::program_options::options_description desc)
   std::cout << desc << std::endl;
 }
 
+// Use the same converter as the WTH cache, so the WTH is the same with or without a cache. The
+// EPW is still loaded for the pressure and temperature series used in the flow conversion.
 boost::optional<openstudio::EpwFile> translateEpw(openstudio::path epwpath, openstudio::path outpath)
 {
+  contamutils::EpwToWthConverter converter;
+  if(!converter.convert(openstudio::toString(epwpath),openstudio::toString(outpath)))
+  {
+    std::cout << "Translation of EPW file failed (" << converter.errorMessage() << "), weather will be steady state" << std::endl;
+    return boost::none;
+  }
   boost::optional<openstudio::EpwFile> epw;
   try
   {
-    openstudio::EpwFile epwFile(epwpath,true);
-    try
-    {
-      epwFile.translateToWth(outpath);
-    }
-    catch(...) // Is this going to work?
-    {
-      std::cout << "Translation of EPW file failed, weather will be steady state" << std::endl;
-      return false;
-    }
-    epw = boost::optional<openstudio::EpwFile>(epwFile);
+    epw = boost::optional<openstudio::EpwFile>(openstudio::EpwFile(epwpath,true));
   }
   catch(...)
   {
     std::cout << "Failed to correctly load EPW file, weather will be steady state" << std::endl;
-    return false;
   }
   return epw;
 }
 
-static boost::optional<openstudio::path> findFile(openstudio::path base, std::string filename)
-{
-  if(boost::filesystem::is_directory(base))
-  {
-    openstudio::path filepath = base / openstudio::toPath(filename);
-    std::cout<<"Looking for "<<openstudio::toString(filepath)<<std::endl;
-    if(boost::filesystem::exists(filepath))
-    {
-      return boost::optional<openstudio::path>(filepath);
-    }
-    // WHY!?!?!
-    boost::filesystem2::path basepath(openstudio::toString(base));
-    boost::filesystem::directory_iterator iter(basepath);
-    boost::filesystem::directory_iterator end;
-    for(;iter!=end;++iter)
-    {
-      boost::optional<openstudio::path> optional = findFile(openstudio::toPath(iter->path().string()),filename);
-      if(optional)
-      {
-        return optional;
-      }
-    }
-  }
-  return false;
-}
-
 int main(int argc, char *argv[])
 {
+  contamutils::Profiler profiler("compinf");
   std::string inputPathString;
   std::string outputPathString = "scheduled-infiltration.osm";
   std::string leakageDescriptorString="Average";
+  std::string wthCacheString;
+  std::string translationCacheString;
+  std::string contamxString;
+  std::string simreadxString;
+  std::string configString;
+  std::string profileString;
+  int searchDepth=-1;
+  int timestep=60;
   double flow=27.1;
   double returnSupplyRatio=1.0;
   bool setLevel = true;
   bool writeCsv = false;
+  bool writeBinary = false;
   boost::program_options::options_description desc("Allowed options");
 
   desc.add_options()
+    ("binary,b", "write out a memory-mappable binary results file")
+    ("config", boost::program_options::value<std::string>(&configString), "config file naming the ContamX and SimReadX executables (default: $CONTAM_CONFIG)")
+    ("contamx", boost::program_options::value<std::string>(&contamxString), "ContamX executable (default: $CONTAM_CONTAMX, the config file, or contamx3 on the PATH)")
     ("csv,c", "write out descriptive csv files")
     ("flow,f", boost::program_options::value<double>(&flow), "leakage flow rate per envelope area [m^3/h/m^2]")
+    ("full-load", "load every object in the OSM, not just the ones the airflow translation needs")
     ("help,h", "print help message and exit")
     ("input-path,i", boost::program_options::value<std::string>(&inputPathString), "path to input OSM file")
     ("level,l", boost::program_options::value<std::string>(&leakageDescriptorString), "airtightness: Leaky|Average|Tight (default: Average)")
-    ("quiet,q", "suppress progress output");
+    ("profile", boost::program_options::value<std::string>(&profileString), "write a JSON report of time and memory use by phase to this file (- for the console)")
+    ("quiet,q", "suppress progress output")
+    ("search-depth,d", boost::program_options::value<int>(&searchDepth), "how many directory levels to search for results and weather files (default: no limit)")
+    ("simreadx", boost::program_options::value<std::string>(&simreadxString), "SimReadX executable (default: $CONTAM_SIMREADX, the config file, or simreadx on the PATH)")
+    ("timestep,t", boost::program_options::value<int>(&timestep), "schedule timestep in minutes, must divide an hour (default: 60, 0: use the CONTAM output interval)")
+    ("translation-cache", boost::program_options::value<std::string>(&translationCacheString), "directory of translated models shared between runs (default: $CONTAM_TRANSLATION_CACHE)")
+    ("wth-cache,w", boost::program_options::value<std::string>(&wthCacheString), "directory of converted WTH files shared between runs (default: $CONTAM_WTH_CACHE)");
 
   boost::program_options::positional_options_description pos;
   pos.add("input-path", -1);
@@ -164,11 +166,35 @@ int main(int argc, char *argv[])
   {
     writeCsv = true;
   }
+
+  if(vm.count("binary"))
+  {
+    writeBinary = true;
+  }
+
+  if(!profileString.empty())
+  {
+    profiler.setOutput(profileString);
+    profiler.setInput(inputPathString);
+  }
+
+  contamutils::SimulationRunner runner;
+  if(!runner.configure(contamxString,simreadxString,configString))
+  {
+    std::cout << runner.errorMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
   
   // Open the model
   openstudio::path inputPath = openstudio::toPath(inputPathString);
-  openstudio::osversion::VersionTranslator vt;
-  boost::optional<openstudio::model::Model> model = vt.loadModel(inputPath);
+  contamutils::ProfilePhase loadPhase(profiler,"osm_load");
+  contamutils::AirflowView view;
+  boost::optional<openstudio::model::Model> model;
+  if(view.load(inputPath,vm.count("full-load") > 0))
+  {
+    model = view.model();
+  }
+  loadPhase.stop();
 
   if(!model)
   {
@@ -179,7 +205,9 @@ int main(int argc, char *argv[])
   // Try to find and connect a results file - this really should be done using the RunManager database,
   // but I don't know how to do that and it can be done right at a later date by someone who knows how
   openstudio::path dir = inputPath.parent_path() / inputPath.stem();
-  boost::optional<openstudio::path> sqlpath = findFile(dir,"eplusout.sql");
+  contamutils::FileLocator locator(dir,searchDepth);
+  locator.addPreferredDirectory("run");
+  boost::optional<openstudio::path> sqlpath = locator.find("eplusout.sql");
   if(sqlpath)
   {
     std::cout<<"Found results file, attaching it to the model."<<std::endl;
@@ -189,15 +217,19 @@ int main(int argc, char *argv[])
   openstudio::path prjPath = inputPath.replace_extension(openstudio::toPath("prj").string());
   openstudio::path cvfPath = inputPath.replace_extension(openstudio::toPath("cvf").string());
   openstudio::path wthPath = inputPath.replace_extension(openstudio::toPath("wth").string());
-  openstudio::path simPath = inputPath.replace_extension(openstudio::toPath("sim").string());
+  openstudio::path lfrPath = inputPath.replace_extension(openstudio::toPath("lfr").string());
 
-  bool needWth = true;
-  if(boost::filesystem::exists(wthPath))
+  boost::optional<contamutils::WthCache> wthCache;
+  if(!wthCacheString.empty())
   {
-    needWth = false;
+    wthCache = contamutils::WthCache(openstudio::toPath(wthCacheString));
+  }
+  else if(boost::optional<openstudio::path> cacheDir = contamutils::WthCache::defaultDirectory())
+  {
+    wthCache = contamutils::WthCache(*cacheDir);
   }
 
-  openstudio::contam::ForwardTranslator translator;
+  contamutils::TranslatorSettings settings;
   if(setLevel)
   {
     QVector<std::string> known;
@@ -207,46 +239,96 @@ int main(int argc, char *argv[])
       std::cout << "Unknown airtightness level '" << leakageDescriptorString << "'" << std::endl;
       return EXIT_FAILURE;
     }
-    translator.setAirtightnessLevel(leakageDescriptorString);
+    settings.level = leakageDescriptorString;
   }
   else
   {
-    translator.setExteriorFlowRate(flow,0.65,75.0);
+    settings.setLevel = false;
+    settings.flow = flow;
+  }
+  settings.translateHVAC = false;
+
+  // Use an earlier translation of the same model if there is one
+  boost::optional<contamutils::TranslationCache> translationCache;
+  if(!translationCacheString.empty())
+  {
+    translationCache = contamutils::TranslationCache(openstudio::toPath(translationCacheString));
+  }
+  else if(boost::optional<openstudio::path> cacheDir = contamutils::TranslationCache::defaultDirectory())
+  {
+    translationCache = contamutils::TranslationCache(*cacheDir);
   }
-  translator.setTranslateHVAC(false);
-  boost::optional<openstudio::contam::IndexModel> cx = translator.translateModel(model.get());
-  if(!cx)
+  std::string translationKey;
+  if(translationCache)
   {
-     std::cout << "Translation failed, check errors and warnings for more information." << std::endl;
-     return EXIT_FAILURE;
+    translationKey = contamutils::TranslationCache::key(openstudio::toPath(inputPathString),sqlpath,settings);
   }
-  if(!cx->valid())
+  contamutils::ProfilePhase translatePhase(profiler,"translation");
+  contamutils::Translation translation;
+  if(!translationKey.empty() && translationCache->load(translationKey,cvfPath,translation))
   {
-     std::cout << "Translation returned an invalid model, check errors and warnings for more information." << std::endl;
-     return EXIT_FAILURE;
+    std::cout << "Using cached translation" << std::endl;
   }
+  else
+  {
+    std::string error;
+    if(!contamutils::translateModel(*model,settings,cvfPath,translation,error))
+    {
+      std::cout << error << std::endl;
+      return EXIT_FAILURE;
+    }
+    if(!translationKey.empty() && !translationCache->store(translationKey,translation))
+    {
+      std::cout << "Translation cache failed (" << translationCache->errorMessage() << ")" << std::endl;
+    }
+  }
+  translatePhase.stop();
+  boost::optional<openstudio::contam::IndexModel> cx = translation.model;
   
   // Since we really need this to be a transient case, bail out now if it is not
-  if(!translator.startDateTime() || !translator.endDateTime())
+  if(!translation.startDateTime || !translation.endDateTime)
   {
     std::cout << "The translated model is a steady-state model, bailing out" << std::endl;
     return EXIT_FAILURE;
   }
+  // Have ContamX report at the schedule timestep
+  int timestepSeconds = contamutils::setOutputTimestep(*cx,60*timestep);
+  if(timestepSeconds < 0)
+  {
+    std::cout << "The schedule timestep must divide an hour into whole minutes" << std::endl;
+    return EXIT_FAILURE;
+  }
   boost::optional<openstudio::EpwFile> epwFile;
-  QFile file(openstudio::toQString(prjPath));
-  if(file.open(QFile::WriteOnly))
+  std::ofstream file(openstudio::toString(prjPath).c_str(),std::ios::out|std::ios::binary);
+  if(file.good())
   {
-    QTextStream textStream(&file);
     // Attempt to translate weather
+    contamutils::ProfilePhase weatherPhase(profiler,"epw_to_wth");
     boost::optional<openstudio::model::WeatherFile> weatherFile = model->weatherFile();
     if(weatherFile)
     {
       boost::optional<openstudio::path> path = weatherFile->path();
       if(path)
       {
-        boost::optional<openstudio::path> epwPath = findFile(dir,openstudio::toString(path->string()));
+        boost::optional<openstudio::path> epwPath = locator.find(openstudio::toString(path->string()));
         if(epwPath)
         {
+          // The WTH is only reusable if it was made from the EPW as it is now
+          bool needWth = !boost::filesystem::exists(wthPath)
+            || boost::filesystem::last_write_time(wthPath) < boost::filesystem::last_write_time(*epwPath);
+          if(wthCache)
+          {
+            boost::optional<openstudio::path> cachedPath = wthCache->wthPath(*epwPath);
+            if(cachedPath && wthCache->linkTo(*cachedPath,wthPath))
+            {
+              cx->setWTHpath(openstudio::toString(wthPath));
+              needWth = false;
+            }
+            else
+            {
+              std::cout << "WTH cache failed (" << wthCache->errorMessage() << "), converting directly" << std::endl;
+            }
+          }
           if(!needWth)
           {
             try
@@ -282,14 +364,21 @@ int main(int argc, char *argv[])
     {
       std::cout << "No weather file object to process, WTH file will not be written" << std::endl;
     }
+    weatherPhase.stop();
 
-    // Write out a CVF if needed
-    if(translator.writeCvFile(cvfPath))
+    // Use the CVF if the translation wrote one
+    if(translation.cvfPath)
     {
       // Need to set the CVF file in the PRJ, this path may need to be made relative. Not too sure
       cx->setCVFpath(openstudio::toString(cvfPath));
     }
-    textStream << openstudio::toQString(cx->toString());
+    contamutils::ProfilePhase writePhase(profiler,"prj_write");
+    if(!contamutils::writePrj(*cx,file))
+    {
+      std::cout << "Failed to write file '" << openstudio::toString(prjPath) << "'." << std::endl;
+      return EXIT_FAILURE;
+    }
+    file.close();
   }
   else
   {
@@ -297,7 +386,6 @@ int main(int argc, char *argv[])
     std::cout << "Check that this file location is accessible and may be written." << std::endl;
     return EXIT_FAILURE;
   }
-  file.close();
 
   // Now we should have a CONTAM model file. There will need to be some steps taken if parts of the 
   // process have not been successful (e.g. the creation of a WTH file), but for now just assume that
@@ -306,43 +394,45 @@ int main(int argc, char *argv[])
   // Run CONTAM on the PRJ file
   //
   std::cout << "Running CONTAM simulation" << std::endl;
-  // Ugly hard code
-  openstudio::path contamExe = openstudio::toPath("C:\\Program Files (x86)\\NIST\\CONTAM 3.1\\ContamX3.exe");
-  openstudio::path simreadxExe = openstudio::toPath("C:\\Users\\jwd131\\Software\\CONTAM\\simreadx.exe");
-  //
-  // Run CONTAM
-  //
-  QProcess contamProcess;
-  contamProcess.start(openstudio::toQString(contamExe), QStringList() << openstudio::toQString(prjPath));
-  if(!contamProcess.waitForStarted(-1))
+  std::string runError;
+  contamutils::ProfilePhase contamxPhase(profiler,"contamx");
+  if(!runner.runContamX(prjPath,runError))
   {
-    std::cout << "Failed to start ContamX process." << std::endl;
+    std::cout << runError << std::endl;
     return EXIT_FAILURE;
   }
-  if(!contamProcess.waitForFinished(-1))
+  contamxPhase.stop();
+  std::cout << "Successfully ran ContamX" << std::endl;
+  // Read in the flows through the exterior paths of each zone, all into one matrix
+  std::vector<std::vector<int> > pathIds = cx->zoneExteriorFlowPaths();
+  std::vector<int> pathNrs;
+  std::vector<int> pathZone;
+  for(unsigned i=0;i<pathIds.size();i++)
   {
-    std::cout << "Failed to complete ContamX process." << std::endl;
-    return EXIT_FAILURE;
+    for(unsigned j=0;j<pathIds[i].size();j++)
+    {
+      pathNrs.push_back(pathIds[i][j]);
+      pathZone.push_back(i);
+    }
   }
-  std::cout << "Successfully ran ContamX" << std::endl;
-  //
-  // Run SimRead - this will hopefully go away at some point
-  //
-  QProcess simreadProcess;
-  simreadProcess.start(openstudio::toQString(simreadxExe), QStringList() << "-a" << openstudio::toQString(prjPath));
-  if(!simreadProcess.waitForStarted(-1))
+  // Get the results as text from SimReadX
+  contamutils::ProfilePhase simreadxPhase(profiler,"simreadx");
+  if(!runner.runSimReadX(prjPath,runError))
   {
-    std::cout << "Failed to start SimReadX process." << std::endl;
+    std::cout << runError << std::endl;
     return EXIT_FAILURE;
   }
-  if(!simreadProcess.waitForFinished(-1))
+  simreadxPhase.stop();
+  std::cout << "Successfully ran SimReadX" << std::endl;
+  contamutils::PathFlowMatrix pathFlows;
+  contamutils::ProfilePhase parsePhase(profiler,"sim_parse");
+  if(!contamutils::readPathInfiltration(*cx,lfrPath,pathNrs,pathFlows)) // These are in kg/s
   {
-    std::cout << "Failed to complete SimReadX process." << std::endl;
+    std::cout << pathFlows.errorMessage() << std::endl;
     return EXIT_FAILURE;
   }
-  std::cout << "Successfully ran SimReadX" << std::endl;
-  // Read in the results
-  openstudio::contam::SimFile sim(simPath);
+  parsePhase.stop();
+  contamutils::ProfilePhase schedulePhase(profiler,"schedule_build");
   // Remove previous infiltration objects
   std::vector<openstudio::model::SpaceInfiltrationDesignFlowRate> dfrInf = model->getConcreteModelObjects<openstudio::model::SpaceInfiltrationDesignFlowRate>();
   BOOST_FOREACH(openstudio::model::SpaceInfiltrationDesignFlowRate inf, dfrInf)
@@ -355,10 +445,8 @@ int main(int argc, char *argv[])
     inf.remove();
   }
   // Set the default here in case the EpwFile route fails
-  openstudio::Time diff = translator.endDateTime().get()-translator.startDateTime().get();
-  //std::cout << diff.days()*24 << std::endl;
-  double ssP = cx->ssWeather().Tambt();
-  double ssT = cx->ssWeather().barpres();
+  double ssP = cx->ssWeather().barpres();
+  double ssT = cx->ssWeather().Tambt();
   // Try to get the outdoor conditions
   openstudio::TimeSeries seriesP;
   openstudio::TimeSeries seriesT;
@@ -374,7 +462,6 @@ int main(int argc, char *argv[])
       seriesT = optT.get();
     }
   }
-  //std::cout << ssP << " " << ssT << std::endl;
   // Open up a csv file if we need it
   std::ofstream csv;
   if(writeCsv)
@@ -385,14 +472,50 @@ int main(int argc, char *argv[])
       writeCsv = false;
     }
   }
-  std::vector<std::vector<int> > pathIds = cx->zoneExteriorFlowPaths();
-  std::vector<openstudio::TimeSeries> infiltration = cx->zoneInfiltration(&sim); // These are in kg/s
+  openstudio::Time delta(0,0,0,timestepSeconds);
+  // The binary file is written a space at a time as the schedules are made
+  openstudio::DateTime first = translation.startDateTime.get() + delta;
+  contamutils::InfiltrationFileWriter binary(contamutils::InfiltrationStart(first.date().year(),
+    first.date().monthOfYear().value(),first.date().dayOfMonth(),first.time().hours(),first.time().minutes(),
+    first.time().seconds()),delta.totalSeconds());
+  if(writeBinary && !binary.open("computed-infiltration.cxinf"))
+  {
+    std::cout << binary.errorMessage() << std::endl;
+  }
+  // Put the weather and the results for every zone onto the schedule grid once, then convert
+  // the whole zone by time matrix to m^3/s in one pass
+  openstudio::DateTime startDateTime = translation.startDateTime.get();
+  double step = delta.totalDays();
+  std::size_t steps = contamutils::gridSteps(startDateTime,translation.endDateTime.get(),delta);
+  std::vector<double> P(steps,ssP);
+  std::vector<double> T(steps,ssT);
+  if(variableWeather && steps)
+  {
+    contamutils::sampleOntoGrid(seriesP,startDateTime,step,steps,&P[0]);
+    contamutils::sampleOntoGrid(seriesT,startDateTime,step,steps,&T[0]);
+    for(std::size_t i=0;i<steps;i++)
+    {
+      T[i] += 273.15;
+    }
+  }
+  std::vector<double> factor(steps);
+  std::vector<double> massFlow(pathIds.size()*steps,0.0);
+  std::vector<double> volumeFlow(pathIds.size()*steps);
+  if(steps)
+  {
+    contamutils::volumeFlowFactors(&P[0],&T[0],steps,&factor[0]);
+    contamutils::accumulateOntoGrid(pathFlows,pathZone.empty() ? 0 : &pathZone[0],pathIds.size(),startDateTime,step,steps,
+      &massFlow[0]);
+    contamutils::massToVolumeFlow(&massFlow[0],pathIds.size(),steps,&factor[0],&volumeFlow[0]);
+  }
   // Create a schedule for each zone
-  std::map<openstudio::Handle,int> map = translator.zoneMap();
+  std::map<openstudio::Handle,int> map = translation.zoneMap;
   // This approach implicitly requires that each space is a zone. There should be a way to distibute the infiltration 
   // so that when it is all put together it adds up to the right thing. That would allow for more than one space in a 
   // zone - which needs to happen at some point.
   std::vector<openstudio::model::Space> spaces = model->getConcreteModelObjects<openstudio::model::Space>();
+  // One buffer for the schedule values that every space reuses
+  openstudio::Vector values(steps);
   BOOST_FOREACH(openstudio::model::Space space, spaces)
   {
     boost::optional<openstudio::model::ThermalZone> zone = space.thermalZone();
@@ -406,38 +529,23 @@ int main(int argc, char *argv[])
       std::cout << "Zone '" << openstudio::toString(zone->handle()) << "' has no associated CONTAM zone." << std::endl;
       continue;
     }
-    openstudio::TimeSeries zoneInfiltration = infiltration[map[zone->handle()]-1];
-    /*
-    std::cout << zoneInfiltration.value(0) << std::endl;
-    openstudio::DateTime dt(openstudio::Date(1,1),openstudio::Time(0,2));
-    std::cout << dt.toString() << " " << zoneInfiltration.value(dt) << std::endl;
-    std::cout << zoneInfiltration.firstReportDateTime().toString() << std::endl;
-    for(unsigned i=0;i<zoneInfiltration.values().size();i++)
-    {
-      std::cout << zoneInfiltration.values()[i] << std::endl;
-      //if(i==20)exit(0);
-    }
-    */
-    openstudio::Time delta(0,1); // Do an hourly schedule
-    std::vector<double> values;
-    for(openstudio::DateTime current=translator.startDateTime().get()+delta; current <= translator.endDateTime().get(); current += delta)
+    std::size_t offset = (map[zone->handle()]-1)*steps;
+    std::copy(volumeFlow.begin()+offset,volumeFlow.begin()+offset+steps,values.begin());
+    if(writeCsv && variableWeather)
     {
-      double inf = zoneInfiltration.value(current); // This will be in kg/s
-      double P = ssP;
-      double T = ssT;
-      if(variableWeather)
+      openstudio::DateTime current = startDateTime;
+      for(std::size_t i=0;i<steps;i++)
       {
-        P = seriesP.value(current);
-        T = seriesT.value(current) + 273.15;
-        if(writeCsv)
-        {
-          csv << current.toString() << "," << inf << "," << inf*287.058*T/P << "," << P << "," << T << std::endl;
-        }
+        current += delta;
+        csv << current.toString() << "," << massFlow[offset+i] << "," << values[i] << "," << P[i] << "," << T[i] << std::endl;
       }
-      values.push_back(inf*287.058*T/P); // Compute m^3/s
+    }
+    if(binary.isOpen())
+    {
+      binary.addColumn(space.name().get(),&volumeFlow[offset],steps);
     }
     // Make the time series
-    openstudio::TimeSeries infiltrationTimeSeries(translator.startDateTime()->date(),delta,openstudio::createVector(values),"");
+    openstudio::TimeSeries infiltrationTimeSeries(translation.startDateTime->date(),delta,values,"");
     //std::cout << infiltrationTimeSeries.firstReportDateTime().toString() << std::endl;
     // Make the schedule
     openstudio::model::ScheduleFixedInterval schedule(*model);
@@ -455,8 +563,16 @@ int main(int argc, char *argv[])
     csv.close();
   }
 
+  if(binary.isOpen() && !binary.close())
+  {
+    std::cout << binary.errorMessage() << std::endl;
+  }
+
+  schedulePhase.stop();
+
+  contamutils::ProfilePhase savePhase(profiler,"osm_save");
   openstudio::path outPath = openstudio::toPath(outputPathString);
-  if(!model->save(outPath,true))
+  if(!view.save(outPath))
   {
     std::cout << "Failed to write OSM file." << std::endl;
     return EXIT_FAILURE;
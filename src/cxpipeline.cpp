@@ -0,0 +1,791 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+#include "AdaptiveSweep.hpp"
+#include "EpwToWth.hpp"
+#include "JobQueue.hpp"
+#include "ModelLoader.hpp"
+#include "PrjWriter.hpp"
+#include "Profiler.hpp"
+#include "SimpleFit.hpp"
+#include "SimulationRunner.hpp"
+#include "TranslationCache.hpp"
+#include "WindSweep.hpp"
+#include "WthCache.hpp"
+
+#include <airflow/contam/ForwardTranslator.hpp>
+#include <model/Model.hpp>
+#include <model/Space.hpp>
+#include <utilities/core/CommandLine.hpp>
+#include <utilities/core/Path.hpp>
+
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <iostream>
+#include <vector>
+
+void usage( boost::program_options::options_description desc)
+{
+  std::cout << "Usage: cxpipeline [options] model.osm [model.osm ...]" << std::endl;
+  std::cout << "   or: cxpipeline --batch=manifest.txt [--jobs=N]" << std::endl;
+  std::cout << desc << std::endl;
+}
+
+// The stages that can follow translation. They always run in this order, whatever order they're given in.
+enum Stage {WritePrj=1, FitInfiltration=2, SaveOsm=4};
+
+// Everything that is the same for every model, checked once before anything runs
+struct PipelineSettings
+{
+  contamutils::TranslatorSettings translator;
+  boost::optional<openstudio::path> translationCacheDir;
+  boost::optional<openstudio::path> wthCacheDir;
+  openstudio::path scratchDir;
+  contamutils::WindSweep::Solver solver;
+  int stages;
+  int ndirs;
+  std::vector<double> speeds;
+  std::vector<double> stackDifferences;
+  int simJobs;
+  bool adaptive;
+  double adaptiveTolerance;
+  double density;
+  bool verbose;
+};
+
+struct PipelineJob
+{
+  openstudio::path inputPath;
+  openstudio::path outputDir;
+  openstudio::path prjPath;
+  openstudio::path osmPath;
+  openstudio::path scratchDir;
+  bool success;
+  int pending; // Stages that haven't finished yet
+  boost::chrono::steady_clock::time_point start; // When a model worker picked it up
+  double seconds;
+  std::string log;
+};
+
+// What the stages share. The CPU-bound work (loading, translating and fitting) runs on the model
+// workers, one model per worker, and everything that is mostly waiting on the disk (weather
+// conversion, PRJ writing and OSM saving) is handed off to the I/O workers so that the model worker
+// can get on with the next model.
+struct Pipeline
+{
+  Pipeline(const PipelineSettings &settings, const contamutils::SimulationRunner &runner, contamutils::Profiler &profiler,
+    int ioThreads) : settings(settings), runner(runner), profiler(profiler), io(ioThreads)
+  {}
+  const PipelineSettings &settings;
+  const contamutils::SimulationRunner &runner;
+  contamutils::Profiler &profiler;
+  contamutils::JobQueue io;
+  boost::mutex mutex; // Guards the job logs and counts, and the console
+};
+
+// The outcome of a weather conversion, which the model worker waits for before it renders the PRJ
+struct WeatherResult
+{
+  WeatherResult() : done(false), success(false)
+  {}
+
+  void finish(bool ok, const std::string &message)
+  {
+    boost::mutex::scoped_lock lock(mutex);
+    success = ok;
+    log = message;
+    done = true;
+    ready.notify_all();
+  }
+
+  bool wait(std::ostream &out)
+  {
+    boost::mutex::scoped_lock lock(mutex);
+    while(!done)
+    {
+      ready.wait(lock);
+    }
+    out << log;
+    return success;
+  }
+
+  boost::mutex mutex;
+  boost::condition_variable ready;
+  bool done;
+  bool success;
+  std::string log;
+};
+
+static void finishStage(Pipeline *pipeline, PipelineJob *job, bool success, const std::string &log)
+{
+  boost::mutex::scoped_lock lock(pipeline->mutex);
+  job->log += log;
+  if(!success)
+  {
+    job->success = false;
+  }
+  if(--job->pending == 0)
+  {
+    job->seconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - job->start).count();
+    if(pipeline->settings.verbose)
+    {
+      std::cout << (job->success ? "Finished " : "Failed ") << openstudio::toString(job->inputPath)
+        << " in " << job->seconds << " s" << std::endl;
+    }
+  }
+}
+
+// Hand a stage to the I/O workers, the job isn't done until it finishes
+static void addIoStage(Pipeline *pipeline, PipelineJob *job, boost::function<void ()> stage)
+{
+  {
+    boost::mutex::scoped_lock lock(pipeline->mutex);
+    job->pending++;
+  }
+  pipeline->io.add(stage);
+}
+
+static void convertWeather(Pipeline *pipeline, openstudio::path epwPath, openstudio::path wthPath,
+  boost::shared_ptr<WeatherResult> result)
+{
+  std::stringstream log;
+  bool success = false;
+  contamutils::ProfilePhase phase(pipeline->profiler,"epw_to_wth");
+  try
+  {
+    if(pipeline->settings.wthCacheDir)
+    {
+      // Convert once into the shared cache, then link the result in next to the PRJ
+      contamutils::WthCache cache(*pipeline->settings.wthCacheDir);
+      boost::optional<openstudio::path> cachedPath = cache.wthPath(epwPath);
+      success = cachedPath && cache.linkTo(*cachedPath,wthPath);
+      if(!success)
+      {
+        log << "WTH cache failed (" << cache.errorMessage() << "), WTH file will not be used in simulation" << std::endl;
+      }
+    }
+    else
+    {
+      contamutils::EpwToWthConverter converter;
+      success = converter.convert(openstudio::toString(epwPath),openstudio::toString(wthPath));
+      if(!success)
+      {
+        log << "EPW translation to WTH failed (" << converter.errorMessage()
+          << "), WTH file will not be used in simulation" << std::endl;
+      }
+    }
+  }
+  catch(std::exception &e)
+  {
+    log << "EPW translation to WTH threw an exception: " << e.what() << std::endl;
+    success = false;
+  }
+  catch(...)
+  {
+    log << "EPW translation to WTH threw an unknown exception" << std::endl;
+    success = false;
+  }
+  phase.stop();
+  result->finish(success,log.str());
+}
+
+static void writePrjStage(Pipeline *pipeline, PipelineJob *job, boost::shared_ptr<std::string> prj)
+{
+  std::stringstream log;
+  bool success = false;
+  contamutils::ProfilePhase phase(pipeline->profiler,"prj_write");
+  std::ofstream file(openstudio::toString(job->prjPath).c_str(),std::ios::out|std::ios::binary);
+  if(!file.good())
+  {
+    log << "Failed to open file '"<< openstudio::toString(job->prjPath) << "'." << std::endl;
+  }
+  else if(!(success = contamutils::writePrj(*prj,file)))
+  {
+    log << "Failed to write file '" << openstudio::toString(job->prjPath) << "'." << std::endl;
+  }
+  phase.stop();
+  finishStage(pipeline,job,success,log.str());
+}
+
+static void saveOsmStage(Pipeline *pipeline, PipelineJob *job, openstudio::model::Model model)
+{
+  std::stringstream log;
+  bool success = false;
+  contamutils::ProfilePhase phase(pipeline->profiler,"osm_save");
+  try
+  {
+    success = model.save(job->osmPath,true);
+    if(!success)
+    {
+      log << "Failed to write OSM file '" << openstudio::toString(job->osmPath) << "'." << std::endl;
+    }
+  }
+  catch(std::exception &e)
+  {
+    log << "Saving the OSM threw an exception: " << e.what() << std::endl;
+  }
+  catch(...)
+  {
+    log << "Saving the OSM threw an unknown exception" << std::endl;
+  }
+  phase.stop();
+  finishStage(pipeline,job,success,log.str());
+}
+
+// The model worker's part: load and translate once, start the weather conversion, fit, then hand the
+// PRJ and OSM to the I/O workers. The PRJ is rendered here, after the sweep has put the model's own
+// steady weather and run control back.
+static bool runModel(Pipeline *pipeline, PipelineJob *job, std::ostream &out)
+{
+  const PipelineSettings &settings = pipeline->settings;
+  bool writePrj = (settings.stages & WritePrj) != 0;
+  bool needOsm = (settings.stages & (FitInfiltration|SaveOsm)) != 0;
+  openstudio::path cvfPath = job->prjPath;
+  cvfPath.replace_extension(openstudio::toPath("cvf").string());
+  openstudio::path wthPath = job->prjPath;
+  wthPath.replace_extension(openstudio::toPath("wth").string());
+  if(!writePrj)
+  {
+    cvfPath = openstudio::path();
+  }
+
+  // A cached translation means the OSM only has to be loaded if it is going to be changed or saved
+  boost::optional<contamutils::TranslationCache> translationCache;
+  std::string translationKey;
+  if(settings.translationCacheDir)
+  {
+    translationCache = contamutils::TranslationCache(*settings.translationCacheDir);
+    translationKey = contamutils::TranslationCache::key(job->inputPath,boost::none,settings.translator);
+  }
+  contamutils::Translation translation;
+  contamutils::ProfilePhase cachePhase(pipeline->profiler,"translation");
+  bool cached = !translationKey.empty() && translationCache->load(translationKey,cvfPath,translation);
+  cachePhase.stop();
+  boost::optional<openstudio::model::Model> model;
+  if(!cached || needOsm)
+  {
+    contamutils::ProfilePhase loadPhase(pipeline->profiler,"osm_load");
+    model = contamutils::loadModel(job->inputPath);
+    if(!model)
+    {
+      out << "Unable to load file '"<< openstudio::toString(job->inputPath) << "' as an OpenStudio model." << std::endl;
+      return false;
+    }
+  }
+  if(!cached)
+  {
+    std::string error;
+    contamutils::ProfilePhase translatePhase(pipeline->profiler,"translation");
+    if(!contamutils::translateModel(*model,settings.translator,cvfPath,translation,error))
+    {
+      out << error << std::endl;
+      return false;
+    }
+    if(!translationKey.empty() && !translationCache->store(translationKey,translation))
+    {
+      out << "Translation cache failed (" << translationCache->errorMessage() << ")" << std::endl;
+    }
+  }
+  openstudio::contam::IndexModel cx = *translation.model;
+
+  // Start on the weather while the sweep runs
+  boost::shared_ptr<WeatherResult> weather;
+  if(writePrj)
+  {
+    if(translation.weatherPath)
+    {
+      boost::optional<openstudio::path> epwPath;
+      if(boost::filesystem::exists(*translation.weatherPath))
+      {
+        epwPath = *translation.weatherPath;
+      }
+      else if(boost::filesystem::exists(job->inputPath.parent_path() / *translation.weatherPath))
+      {
+        epwPath = job->inputPath.parent_path() / *translation.weatherPath;
+      }
+      if(epwPath)
+      {
+        weather = boost::shared_ptr<WeatherResult>(new WeatherResult());
+        pipeline->io.add(boost::bind(convertWeather,pipeline,*epwPath,wthPath,weather));
+      }
+      else
+      {
+        out << "Failed to find EPW file, WTH file will not be written" << std::endl;
+      }
+    }
+    else
+    {
+      out << "No weather file path, WTH file will not be written" << std::endl;
+    }
+  }
+
+  bool success = true;
+  if(settings.stages & FitInfiltration)
+  {
+    // Note we are assuming one space per zone! (maybe relax this later)
+    unsigned nzones = model->getConcreteModelObjects<openstudio::model::Space>().size();
+    std::vector<std::vector<double> > results;
+    contamutils::WindSweep sweep(cx,pipeline->runner);
+    sweep.setSolver(settings.solver);
+    sweep.setJobs(settings.simJobs);
+    sweep.setScratchDirectory(job->scratchDir);
+    sweep.setVerbose(false);
+    sweep.setProfiler(&pipeline->profiler);
+    contamutils::ProfilePhase sweepPhase(pipeline->profiler,"wind_sweep");
+    double Tambt = cx.ssWeather().Tambt();
+    std::vector<contamutils::SweepCase> cases = contamutils::simpleFitCases(settings.ndirs,settings.speeds,
+      settings.stackDifferences,Tambt);
+    std::string error;
+    bool swept;
+    if(settings.adaptive)
+    {
+      contamutils::AdaptiveSweep adaptive(sweep);
+      adaptive.setTolerance(settings.adaptiveTolerance);
+      adaptive.setScratchDirectory(job->scratchDir);
+      swept = adaptive.run(cases,nzones,results);
+      error = adaptive.errorMessage();
+      if(swept)
+      {
+        out << "Adaptive sampling ran " << adaptive.simulatedCases() << " of " << cases.size()
+          << " cases, saving " << cases.size()-adaptive.simulatedCases() << " simulations" << std::endl;
+      }
+    }
+    else
+    {
+      swept = sweep.run(cases,nzones,results);
+      error = sweep.errorMessage();
+    }
+    sweepPhase.stop();
+    if(!swept)
+    {
+      out << error << std::endl;
+      success = false;
+    }
+    else
+    {
+      contamutils::ProfilePhase fitPhase(pipeline->profiler,"fit");
+      std::vector<contamutils::DesignFlowRateFit> fits = contamutils::fitDesignFlowRates(cases,results,
+        contamutils::zoneTemperatures(cx),Tambt);
+      success = contamutils::setDesignFlowRates(*model,translation.zoneMap,fits,settings.density,out);
+    }
+  }
+
+  if(writePrj)
+  {
+    if(weather && weather->wait(out))
+    {
+      cx.setWTHpath(openstudio::toString(wthPath));
+    }
+    if(translation.cvfPath)
+    {
+      cx.setCVFpath(openstudio::toString(cvfPath));
+    }
+    contamutils::ProfilePhase renderPhase(pipeline->profiler,"prj_render");
+    boost::shared_ptr<std::string> prj(new std::string(cx.toString()));
+    renderPhase.stop();
+    addIoStage(pipeline,job,boost::bind(writePrjStage,pipeline,job,prj));
+  }
+  // Don't save a model that is only partly fitted
+  if(success && (settings.stages & SaveOsm))
+  {
+    addIoStage(pipeline,job,boost::bind(saveOsmStage,pipeline,job,*model));
+  }
+  return success;
+}
+
+static void processModel(Pipeline *pipeline, PipelineJob *job)
+{
+  std::stringstream log;
+  bool success = false;
+  job->start = boost::chrono::steady_clock::now();
+  try
+  {
+    success = runModel(pipeline,job,log);
+  }
+  catch(std::exception &e)
+  {
+    log << "Processing threw an exception: " << e.what() << std::endl;
+  }
+  catch(...)
+  {
+    log << "Processing threw an unknown exception" << std::endl;
+  }
+  finishStage(pipeline,job,success,log.str());
+}
+
+static PipelineJob makeJob(const openstudio::path &inputPath, const openstudio::path &outputDir)
+{
+  PipelineJob job;
+  job.inputPath = inputPath;
+  job.outputDir = outputDir.empty() ? inputPath.parent_path() : outputDir;
+  job.prjPath = job.outputDir / openstudio::toPath(openstudio::toString(inputPath.stem()) + ".prj");
+  job.osmPath = job.outputDir / openstudio::toPath(openstudio::toString(inputPath.stem()) + "-simple-fit.osm");
+  job.success = true;
+  job.pending = 0;
+  job.seconds = 0.0;
+  return job;
+}
+
+// The manifest has one model per line: the input OSM path, optionally followed by a tab or comma and the
+// output directory. Blank lines and lines starting with '#' are ignored.
+static bool readManifest(const std::string &manifestPath, const openstudio::path &outputDir,
+  std::vector<PipelineJob> &jobs)
+{
+  std::ifstream manifest(manifestPath.c_str());
+  if(!manifest.good())
+  {
+    return false;
+  }
+  std::string line;
+  while(std::getline(manifest,line))
+  {
+    std::string::size_type start = line.find_first_not_of(" \t\r");
+    if(start == std::string::npos || line[start] == '#')
+    {
+      continue;
+    }
+    std::string::size_type end = line.find_last_not_of(" \t\r");
+    line = line.substr(start,end-start+1);
+    std::string::size_type split = line.find_first_of("\t,");
+    std::string input = line.substr(0,split);
+    input = input.substr(0,input.find_last_not_of(" \t")+1);
+    openstudio::path dir = outputDir;
+    if(split != std::string::npos)
+    {
+      std::string output = line.substr(split+1);
+      std::string::size_type first = output.find_first_not_of(" \t");
+      if(first != std::string::npos)
+      {
+        dir = openstudio::toPath(output.substr(first));
+      }
+    }
+    jobs.push_back(makeJob(openstudio::toPath(input),dir));
+  }
+  return true;
+}
+
+static bool parseStages(const std::string &list, int &stages)
+{
+  stages = 0;
+  std::stringstream stream(list);
+  std::string name;
+  while(std::getline(stream,name,','))
+  {
+    std::string::size_type first = name.find_first_not_of(" ");
+    std::string::size_type last = name.find_last_not_of(" ");
+    name = first == std::string::npos ? std::string() : name.substr(first,last-first+1);
+    if(name == "prj")
+    {
+      stages |= WritePrj;
+    }
+    else if(name == "fit")
+    {
+      stages |= FitInfiltration;
+    }
+    else if(name == "osm")
+    {
+      stages |= SaveOsm;
+    }
+    else
+    {
+      std::cout << "Unknown stage '" << name << "'" << std::endl;
+      return false;
+    }
+  }
+  if((stages & SaveOsm) && !(stages & FitInfiltration))
+  {
+    std::cout << "The osm stage saves the fitted model, so it needs the fit stage" << std::endl;
+    return false;
+  }
+  return stages != 0;
+}
+
+int main(int argc, char *argv[])
+{
+  contamutils::Profiler profiler("cxpipeline");
+  std::vector<std::string> inputPathStrings;
+  std::string batchString;
+  std::string outputDirString;
+  std::string leakageDescriptorString="Average";
+  std::string solverString="contamx";
+  std::string stagesString="prj,fit,osm";
+  std::string scratchPathString = "cxpipeline-runs";
+  std::string translationCacheString;
+  std::string wthCacheString;
+  std::string contamxString;
+  std::string simreadxString;
+  std::string configString;
+  std::string profileString;
+  std::string speedsString = "4.4704,8.9408";
+  std::string stackString = "10,20";
+  double flow=27.1;
+  double adaptiveTolerance=0.02;
+  int ndirs=4;
+  int jobs=0;
+  int ioJobs=2;
+  int simJobs=1;
+  bool setLevel = true;
+  bool verbose = true;
+  boost::program_options::options_description desc("Allowed options");
+
+  desc.add_options()
+    ("adaptive", "run only as many directions as it takes for the direction averages to converge")
+    ("adaptive-tol", boost::program_options::value<double>(&adaptiveTolerance), "relative tolerance of the adaptive direction sampling (default: 0.02)")
+    ("batch,b", boost::program_options::value<std::string>(&batchString), "process every model listed in a manifest file")
+    ("config", boost::program_options::value<std::string>(&configString), "config file naming the ContamX and SimReadX executables (default: $CONTAM_CONFIG)")
+    ("contamx", boost::program_options::value<std::string>(&contamxString), "ContamX executable (default: $CONTAM_CONTAMX, the config file, or contamx3 on the PATH)")
+    ("flow,f", boost::program_options::value<double>(&flow), "leakage flow rate per envelope area [m^3/h/m^2]")
+    ("help,h", "print help message and exit")
+    ("hvac", "translate the HVAC systems too (default: off, like the infiltration tools)")
+    ("input-path,i", boost::program_options::value<std::vector<std::string> >(&inputPathStrings), "path to input OSM file")
+    ("io-jobs", boost::program_options::value<int>(&ioJobs), "number of file writes and weather conversions to run at once (default: 2)")
+    ("jobs,j", boost::program_options::value<int>(&jobs), "number of models to work on at once (default: number of cores)")
+    ("level,l", boost::program_options::value<std::string>(&leakageDescriptorString), "airtightness: Leaky|Average|Tight (default: Average)")
+    ("ndirs,n", boost::program_options::value<int>(&ndirs), "number of directions to use in the fit (default: 4)")
+    ("output-dir,o", boost::program_options::value<std::string>(&outputDirString), "directory for the PRJ and OSM output (default: next to each input)")
+    ("profile", boost::program_options::value<std::string>(&profileString), "write a JSON report of time and memory use by phase to this file (- for the console)")
+    ("quiet,q", "suppress progress output")
+    ("scratch-dir,s", boost::program_options::value<std::string>(&scratchPathString), "directory for simulation files (default: cxpipeline-runs)")
+    ("sim-jobs", boost::program_options::value<int>(&simJobs), "number of simulations to run at once for each model (default: 1)")
+    ("simreadx", boost::program_options::value<std::string>(&simreadxString), "SimReadX executable (default: $CONTAM_SIMREADX, the config file, or simreadx on the PATH)")
+    ("solver", boost::program_options::value<std::string>(&solverString), "airflow solver for the fit: builtin|contamx (default: contamx)")
+    ("speeds", boost::program_options::value<std::string>(&speedsString), "comma-separated wind speeds to fit at [m/s] (default: 4.4704,8.9408)")
+    ("stack-dt", boost::program_options::value<std::string>(&stackString), "comma-separated temperature differences of the calm stack cases [K], or none (default: 10,20)")
+    ("stages", boost::program_options::value<std::string>(&stagesString), "what to do after translating, any of prj,fit,osm (default: prj,fit,osm)")
+    ("translation-cache", boost::program_options::value<std::string>(&translationCacheString), "directory of translated models shared between runs (default: $CONTAM_TRANSLATION_CACHE)")
+    ("wth-cache,w", boost::program_options::value<std::string>(&wthCacheString), "directory of converted WTH files shared between runs (default: $CONTAM_WTH_CACHE)");
+
+  boost::program_options::positional_options_description pos;
+  pos.add("input-path", -1);
+
+  boost::program_options::variables_map vm;
+  // The following try/catch block is necessary to avoid uncaught
+  // exceptions when the program is executed with more than one
+  // "positional" argument - there's got to be a better way.
+  try
+  {
+    boost::program_options::store(boost::program_options::command_line_parser(argc,
+      argv).options(desc).positional(pos).run(), vm);
+    boost::program_options::notify(vm);
+  }
+
+  catch(std::exception&)
+  {
+    std::cout << "Execution failed: check arguments and retry."<< std::endl << std::endl;
+    usage(desc);
+    return EXIT_FAILURE;
+  }
+
+  if(vm.count("help"))
+  {
+    usage(desc);
+    return EXIT_SUCCESS;
+  }
+
+  if(!vm.count("input-path") && !vm.count("batch"))
+  {
+    std::cout << "No input path given." << std::endl << std::endl;
+    usage(desc);
+    return EXIT_FAILURE;
+  }
+
+  if(vm.count("flow"))
+  {
+    // Probably should do a sanity check of input - but maybe later
+    setLevel = false;
+  }
+
+  if(vm.count("quiet"))
+  {
+    verbose = false;
+  }
+
+  if(setLevel)
+  {
+    QVector<std::string> known;
+    known << "Tight" << "Average" << "Leaky";
+    if(!known.contains(leakageDescriptorString))
+    {
+      std::cout << "Unknown airtightness level '" << leakageDescriptorString << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  if(!profileString.empty())
+  {
+    profiler.setOutput(profileString);
+    profiler.setInput(vm.count("batch") ? batchString : (inputPathStrings.empty() ? std::string() : inputPathStrings[0]));
+  }
+
+  PipelineSettings settings;
+  if(!parseStages(stagesString,settings.stages))
+  {
+    std::cout << "Bad stage list '" << stagesString << "'" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  settings.solver = contamutils::WindSweep::ContamX;
+  if(solverString == "builtin")
+  {
+    settings.solver = contamutils::WindSweep::Builtin;
+  }
+  else if(solverString != "contamx")
+  {
+    std::cout << "Unknown solver '" << solverString << "'" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if(ndirs < 1)
+  {
+    if(verbose)
+    {
+      std::cout << "Bad ndirs value '" << ndirs << "', using ndirs=4" << std::endl;
+    }
+    ndirs = 4;
+  }
+
+  contamutils::SimulationRunner runner;
+  if(!runner.configure(contamxString,simreadxString,configString))
+  {
+    std::cout << runner.errorMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  settings.translator.setLevel = setLevel;
+  settings.translator.level = leakageDescriptorString;
+  settings.translator.flow = flow;
+  settings.translator.translateHVAC = vm.count("hvac") > 0;
+  if(!translationCacheString.empty())
+  {
+    settings.translationCacheDir = openstudio::toPath(translationCacheString);
+  }
+  else
+  {
+    settings.translationCacheDir = contamutils::TranslationCache::defaultDirectory();
+  }
+  if(!wthCacheString.empty())
+  {
+    settings.wthCacheDir = openstudio::toPath(wthCacheString);
+  }
+  else
+  {
+    settings.wthCacheDir = contamutils::WthCache::defaultDirectory();
+  }
+  settings.scratchDir = openstudio::toPath(scratchPathString);
+  settings.ndirs = ndirs;
+  if(!contamutils::parseFitValues(speedsString,settings.speeds) || settings.speeds.empty()
+    || *std::min_element(settings.speeds.begin(),settings.speeds.end()) < 0.0)
+  {
+    std::cout << "Bad speed list '" << speedsString << "'" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if(stackString != "none" && !contamutils::parseFitValues(stackString,settings.stackDifferences))
+  {
+    std::cout << "Bad stack temperature difference list '" << stackString << "'" << std::endl;
+    return EXIT_FAILURE;
+  }
+  settings.simJobs = simJobs < 1 ? 1 : simJobs;
+  settings.adaptive = vm.count("adaptive") > 0;
+  settings.adaptiveTolerance = adaptiveTolerance;
+  if(adaptiveTolerance <= 0.0)
+  {
+    std::cout << "Bad adaptive-tol value '" << adaptiveTolerance << "'" << std::endl;
+    return EXIT_FAILURE;
+  }
+  settings.density = 1.2041;
+  settings.verbose = verbose;
+
+  // Gather up the models
+  openstudio::path outputDir;
+  if(!outputDirString.empty())
+  {
+    outputDir = openstudio::toPath(outputDirString);
+  }
+  std::vector<PipelineJob> modelJobs;
+  for(unsigned i=0;i<inputPathStrings.size();i++)
+  {
+    modelJobs.push_back(makeJob(openstudio::toPath(inputPathStrings[i]),outputDir));
+  }
+  if(vm.count("batch") && !readManifest(batchString,outputDir,modelJobs))
+  {
+    std::cout << "Failed to read manifest '" << batchString << "'." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if(modelJobs.empty())
+  {
+    std::cout << "No models to process." << std::endl;
+    return EXIT_FAILURE;
+  }
+  for(unsigned i=0;i<modelJobs.size();i++)
+  {
+    // Number the scratch directories, two models in different places can have the same name
+    std::stringstream name;
+    name << i << "-" << openstudio::toString(modelJobs[i].inputPath.stem());
+    modelJobs[i].scratchDir = settings.scratchDir / openstudio::toPath(name.str());
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(modelJobs[i].outputDir,ec);
+  }
+
+  Pipeline pipeline(settings,runner,profiler,ioJobs < 1 ? 1 : ioJobs);
+  contamutils::JobQueue models(jobs);
+  boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  for(unsigned i=0;i<modelJobs.size();i++)
+  {
+    modelJobs[i].pending = 1;
+    models.add(boost::bind(processModel,&pipeline,&modelJobs[i]));
+  }
+  pipeline.io.start();
+  models.run();
+  pipeline.io.wait();
+  double seconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+
+  unsigned nfailed = 0;
+  for(unsigned i=0;i<modelJobs.size();i++)
+  {
+    if(!modelJobs[i].success)
+    {
+      nfailed++;
+    }
+  }
+  std::cout << "Processed " << modelJobs.size()-nfailed << " of " << modelJobs.size() << " models on "
+    << models.threadCount() << " model worker(s) and " << pipeline.io.threadCount() << " I/O worker(s) in "
+    << seconds << " s" << std::endl;
+  if(nfailed > 0)
+  {
+    std::cout << std::endl << "Failures:" << std::endl;
+    for(unsigned i=0;i<modelJobs.size();i++)
+    {
+      if(!modelJobs[i].success)
+      {
+        std::cout << openstudio::toString(modelJobs[i].inputPath) << std::endl << modelJobs[i].log;
+      }
+    }
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
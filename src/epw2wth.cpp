@@ -17,6 +17,10 @@
  *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  **********************************************************************/
 
+#include "EpwToWth.hpp"
+#include "JobQueue.hpp"
+#include "Profiler.hpp"
+
 #include <contam/ForwardTranslator.hpp>
 #include <model/Model.hpp>
 #include <osversion/VersionTranslator.hpp>
@@ -25,26 +29,288 @@
 #include <utilities/sql/SqlFile.hpp>
 #include <utilities/filetypes/EpwFile.hpp>
 
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <algorithm>
+#include <fstream>
 #include <string>
 #include <iostream>
+#include <map>
+#include <vector>
 
 void usage( boost::program_options::options_description desc)
 {
   std::cout << "Usage: epw2wth --input-path=./path/to/input.epw" << std::endl;
   std::cout << "   or: epw2wth input.epw" << std::endl;
+  std::cout << "   or: epw2wth --batch=<directory|glob|list file> [--jobs=N]" << std::endl;
   std::cout << desc << std::endl;
 }
 
+struct BatchJob
+{
+  openstudio::path epwPath;
+  openstudio::path wthPath;
+  bool skipped;
+  bool failed;
+  unsigned long records;
+  std::string error;
+};
+
+static bool isEpw(const openstudio::path &path)
+{
+  std::string extension = path.extension().string();
+  std::transform(extension.begin(),extension.end(),extension.begin(),::tolower);
+  return extension == ".epw";
+}
+
+// Match a file name against a pattern with * and ? wildcards
+static bool globMatch(const char *pattern, const char *name)
+{
+  if(*pattern == '\0')
+  {
+    return *name == '\0';
+  }
+  if(*pattern == '*')
+  {
+    return globMatch(pattern+1,name) || (*name != '\0' && globMatch(pattern,name+1));
+  }
+  if(*name != '\0' && (*pattern == '?' || *pattern == *name))
+  {
+    return globMatch(pattern+1,name+1);
+  }
+  return false;
+}
+
+// Figure out the list of EPW files from a directory (searched recursively),
+// a glob pattern on the file name, or a file listing one path per line
+static bool findBatchInputs(const std::string &spec, std::vector<openstudio::path> &inputs, std::string &error)
+{
+  openstudio::path path = openstudio::toPath(spec);
+  boost::system::error_code ec;
+  if(boost::filesystem::is_directory(path,ec))
+  {
+    // Going on from a subdirectory enters it, so that's the one that failed
+    openstudio::path current = path;
+    boost::filesystem::recursive_directory_iterator iter(path,ec);
+    boost::filesystem::recursive_directory_iterator end;
+    while(!ec && iter!=end)
+    {
+      current = iter->path();
+      if(boost::filesystem::is_regular_file(current,ec) && isEpw(current))
+      {
+        inputs.push_back(current);
+      }
+      iter.increment(ec);
+    }
+    if(ec)
+    {
+      error = "Unable to read '" + openstudio::toString(current) + "': " + ec.message();
+      return false;
+    }
+  }
+  else if(spec.find_first_of("*?") != std::string::npos)
+  {
+    openstudio::path dir = path.parent_path();
+    if(dir.empty())
+    {
+      dir = openstudio::toPath(".");
+    }
+    std::string pattern = path.filename().string();
+    if(!boost::filesystem::is_directory(dir,ec))
+    {
+      error = "Unable to find the directory '" + openstudio::toString(dir) + "' for '" + pattern + "'";
+      return false;
+    }
+    boost::filesystem::directory_iterator iter(dir,ec);
+    boost::filesystem::directory_iterator end;
+    while(!ec && iter!=end)
+    {
+      if(boost::filesystem::is_regular_file(iter->path(),ec)
+        && globMatch(pattern.c_str(),iter->path().filename().string().c_str()))
+      {
+        inputs.push_back(iter->path());
+      }
+      iter.increment(ec);
+    }
+    if(ec)
+    {
+      error = "Unable to read '" + openstudio::toString(dir) + "': " + ec.message();
+      return false;
+    }
+  }
+  else if(boost::filesystem::is_regular_file(path,ec))
+  {
+    std::ifstream list(spec.c_str());
+    std::string line;
+    while(std::getline(list,line))
+    {
+      std::string::size_type start = line.find_first_not_of(" \t\r");
+      if(start == std::string::npos || line[start] == '#')
+      {
+        continue;
+      }
+      std::string::size_type end = line.find_last_not_of(" \t\r");
+      inputs.push_back(openstudio::toPath(line.substr(start,end-start+1)));
+    }
+  }
+  else
+  {
+    error = "Unable to find batch inputs from '" + spec + "'";
+    return false;
+  }
+  std::sort(inputs.begin(),inputs.end());
+  return true;
+}
+
+static void convertBatchJob(BatchJob *job, bool verbose, boost::mutex *outputMutex, contamutils::Profiler *profiler)
+{
+  // Incremental: leave alone anything that has already been converted since the EPW last changed
+  if(boost::filesystem::exists(job->wthPath) && boost::filesystem::exists(job->epwPath)
+    && boost::filesystem::last_write_time(job->wthPath) >= boost::filesystem::last_write_time(job->epwPath))
+  {
+    job->skipped = true;
+    return;
+  }
+  contamutils::ProfilePhase phase(profiler,"epw_to_wth");
+  contamutils::EpwToWthConverter converter;
+  if(!converter.convert(openstudio::toString(job->epwPath),openstudio::toString(job->wthPath)))
+  {
+    job->failed = true;
+    job->error = converter.errorMessage();
+    boost::system::error_code ec;
+    boost::filesystem::remove(job->wthPath,ec);
+  }
+  job->records = converter.records();
+  phase.stop();
+  if(verbose)
+  {
+    boost::mutex::scoped_lock lock(*outputMutex);
+    std::cout << (job->failed ? "Failed: " : "Converted: ") << openstudio::toString(job->epwPath) << std::endl;
+  }
+}
+
+static int runBatch(const std::string &spec, const std::string &outputDirString, int jobs, bool verbose,
+  contamutils::Profiler *profiler)
+{
+  std::vector<openstudio::path> inputs;
+  std::string error;
+  if(!findBatchInputs(spec,inputs,error))
+  {
+    std::cout << error << std::endl;
+    return EXIT_FAILURE;
+  }
+  if(inputs.empty())
+  {
+    std::cout << "No EPW files found in '" << spec << "'" << std::endl;
+    return EXIT_FAILURE;
+  }
+  openstudio::path outputDir;
+  if(!outputDirString.empty())
+  {
+    outputDir = openstudio::toPath(outputDirString);
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(outputDir,ec);
+    if(ec)
+    {
+      std::cout << "Failed to create output directory '" << outputDirString << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  std::vector<BatchJob> batch(inputs.size());
+  for(unsigned i=0;i<inputs.size();i++)
+  {
+    batch[i].epwPath = inputs[i];
+    batch[i].wthPath = inputs[i];
+    batch[i].wthPath.replace_extension(openstudio::toPath("wth").string());
+    if(!outputDir.empty())
+    {
+      batch[i].wthPath = outputDir / batch[i].wthPath.filename();
+    }
+    batch[i].skipped = false;
+    batch[i].failed = false;
+    batch[i].records = 0;
+  }
+  // Inputs with the same name in different directories would all be written to the same WTH
+  std::map<openstudio::path,openstudio::path> targets;
+  for(unsigned i=0;i<batch.size();i++)
+  {
+    std::pair<std::map<openstudio::path,openstudio::path>::iterator,bool> result
+      = targets.insert(std::make_pair(batch[i].wthPath,batch[i].epwPath));
+    if(!result.second)
+    {
+      std::cout << "Both '" << openstudio::toString(result.first->second) << "' and '"
+        << openstudio::toString(batch[i].epwPath) << "' would be written to '"
+        << openstudio::toString(batch[i].wthPath) << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  boost::mutex outputMutex;
+  contamutils::JobQueue queue(jobs);
+  for(unsigned i=0;i<batch.size();i++)
+  {
+    queue.add(boost::bind(convertBatchJob,&batch[i],verbose,&outputMutex,profiler));
+  }
+  boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  queue.run();
+  double seconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+
+  unsigned converted = 0;
+  unsigned skipped = 0;
+  unsigned long records = 0;
+  std::vector<BatchJob*> failures;
+  for(unsigned i=0;i<batch.size();i++)
+  {
+    if(batch[i].skipped)
+    {
+      skipped++;
+    }
+    else if(batch[i].failed)
+    {
+      failures.push_back(&batch[i]);
+    }
+    else
+    {
+      converted++;
+      records += batch[i].records;
+    }
+  }
+  std::cout << "Converted " << converted << " of " << batch.size() << " files (" << skipped << " up to date, "
+    << failures.size() << " failed) on " << queue.threadCount() << " worker(s) in " << seconds << " s" << std::endl;
+  if(seconds > 0.0)
+  {
+    std::cout << "Throughput: " << records/seconds << " rows/s" << std::endl;
+  }
+  for(unsigned i=0;i<failures.size();i++)
+  {
+    std::cout << "Failed: " << openstudio::toString(failures[i]->epwPath) << ": " << failures[i]->error << std::endl;
+  }
+  return failures.empty() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 int main(int argc, char *argv[])
 {
+  contamutils::Profiler profiler("epw2wth");
   std::string inputPathString;
   std::string outputPathString;
+  std::string batchString;
+  std::string profileString;
+  int jobs = 0;
+  bool verbose = true;
   boost::program_options::options_description desc("Allowed options");
 
   desc.add_options()
+    ("batch,b", boost::program_options::value<std::string>(&batchString), "convert every EPW in a directory, glob or list file")
+    ("full-parse", "load the whole EPW file with OpenStudio before translating (slow)")
     ("help,h", "print help message")
     ("input-path,i", boost::program_options::value<std::string>(&inputPathString), "path to input EPW file")
-    ("output-path,o", boost::program_options::value<std::string>(&outputPathString), "path to output WTH file")
+    ("jobs,j", boost::program_options::value<int>(&jobs), "number of batch conversions to run at once (default: number of cores)")
+    ("output-path,o", boost::program_options::value<std::string>(&outputPathString), "path to output WTH file (output directory in batch mode)")
+    ("profile", boost::program_options::value<std::string>(&profileString), "write a JSON report of time and memory use by phase to this file (- for the console)")
     ("quiet,q", "suppress progress output");
 
   boost::program_options::positional_options_description pos;
@@ -74,16 +340,56 @@ int main(int argc, char *argv[])
     return EXIT_SUCCESS;
   }
 
+  if(vm.count("quiet"))
+  {
+    verbose = false;
+  }
+
+  if(!profileString.empty())
+  {
+    profiler.setOutput(profileString);
+    profiler.setInput(vm.count("batch") ? batchString : inputPathString);
+  }
+
+  if(vm.count("batch"))
+  {
+    return runBatch(batchString,outputPathString,jobs,verbose,&profiler);
+  }
+
   if(!vm.count("input-path"))
   {
     std::cout << "No input path given." << std::endl << std::endl;
     usage(desc);
     return EXIT_FAILURE;
   }
-  
-  // Open the EPW file
+
   openstudio::path inputPath = openstudio::toPath(inputPathString);
+  openstudio::path outPath = inputPath;
+  outPath.replace_extension(openstudio::toPath("wth").string());
+  if(!outputPathString.empty())
+  {
+    outPath = openstudio::toPath(outputPathString);
+  }
+
+  if(!vm.count("full-parse"))
+  {
+    // Stream the records straight through, only parsing what the WTH file needs
+    contamutils::ProfilePhase phase(profiler,"epw_to_wth");
+    contamutils::EpwToWthConverter converter;
+    if(!converter.convert(openstudio::toString(inputPath),openstudio::toString(outPath)))
+    {
+      std::cout << "Translation to WTH file failed: " << converter.errorMessage() << std::endl;
+      return EXIT_FAILURE;
+    }
+    if(verbose)
+    {
+      std::cout << "Wrote " << converter.records() << " records to '" << openstudio::toString(outPath) << "'" << std::endl;
+    }
+    return EXIT_SUCCESS;
+  }
 
+  // Open the EPW file
+  contamutils::ProfilePhase phase(profiler,"epw_to_wth");
   boost::optional<openstudio::EpwFile> epwFile;
   try
   {
@@ -96,12 +402,6 @@ int main(int argc, char *argv[])
     return EXIT_FAILURE;
   }
 
-  openstudio::path outPath = inputPath.replace_extension(openstudio::toPath("wth").string());
-  if(!outputPathString.empty())
-  {
-    outPath = openstudio::toPath(outputPathString);
-  }
-
   if(!epwFile->translateToWth(outPath))
   {
     std::cout << "Translation to WTH file failed, check for errors and warnings and try again" << std::endl;
@@ -0,0 +1,227 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+// Compare the throughput of the streaming EPW to WTH conversion with the
+// OpenStudio EpwFile path that epw2wth used to use, then check that the two
+// WTH files agree field by field.
+
+#include "EpwToWth.hpp"
+
+#include <utilities/core/CommandLine.hpp>
+#include <utilities/core/Path.hpp>
+#include <utilities/filetypes/EpwFile.hpp>
+
+#include <boost/chrono.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Split a WTH line into its fields
+static std::vector<std::string> fields(const std::string &line)
+{
+  std::vector<std::string> result;
+  std::istringstream stream(line);
+  std::string field;
+  while(stream >> field)
+  {
+    result.push_back(field);
+  }
+  return result;
+}
+
+// The number of decimals in a number as written, -1 if it isn't a number
+static int decimals(const std::string &field)
+{
+  char *end;
+  std::strtod(field.c_str(),&end);
+  if(field.empty() || *end != '\0')
+  {
+    return -1;
+  }
+  std::string::size_type point = field.find('.');
+  return point == std::string::npos ? 0 : (int)(field.size()-point-1);
+}
+
+// Compare two WTH files field by field. Numbers match if they are within one
+// unit in the last place of the less precise of the two, anything else (dates,
+// times and comments) has to match exactly. The description line is skipped.
+static unsigned long compareWth(const std::string &streamPath, const std::string &fullPath, unsigned long &lines)
+{
+  std::ifstream stream(streamPath.c_str());
+  std::ifstream full(fullPath.c_str());
+  unsigned long mismatches = 0;
+  std::string streamLine;
+  std::string fullLine;
+  lines = 0;
+  while(true)
+  {
+    bool haveStream = std::getline(stream,streamLine).good();
+    bool haveFull = std::getline(full,fullLine).good();
+    if(!haveStream && !haveFull)
+    {
+      break;
+    }
+    lines++;
+    if(haveStream != haveFull)
+    {
+      std::cout << "Line " << lines << ": only in the " << (haveStream ? "streaming" : "EpwFile") << " output" << std::endl;
+      mismatches++;
+      continue;
+    }
+    if(lines == 2)
+    {
+      continue;
+    }
+    std::vector<std::string> a = fields(streamLine);
+    std::vector<std::string> b = fields(fullLine);
+    bool same = a.size() == b.size();
+    for(unsigned i=0;same && i<a.size();i++)
+    {
+      int da = decimals(a[i]);
+      int db = decimals(b[i]);
+      if(da < 0 || db < 0)
+      {
+        same = a[i] == b[i];
+      }
+      else
+      {
+        double tolerance = std::pow(10.0,-std::min(da,db))*(1.0+1.0e-9);
+        same = std::fabs(std::strtod(a[i].c_str(),0) - std::strtod(b[i].c_str(),0)) <= tolerance;
+      }
+    }
+    if(!same)
+    {
+      if(mismatches < 20)
+      {
+        std::cout << "Line " << lines << " differs:" << std::endl;
+        std::cout << "  streaming: " << streamLine << std::endl;
+        std::cout << "  EpwFile:   " << fullLine << std::endl;
+      }
+      mismatches++;
+    }
+  }
+  return mismatches;
+}
+
+void usage( boost::program_options::options_description desc)
+{
+  std::cout << "Usage: epw2wthbench --input-path=./path/to/input.epw" << std::endl;
+  std::cout << "   or: epw2wthbench input.epw" << std::endl;
+  std::cout << desc << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+  std::string inputPathString;
+  int repeat = 10;
+  boost::program_options::options_description desc("Allowed options");
+
+  desc.add_options()
+    ("help,h", "print help message")
+    ("input-path,i", boost::program_options::value<std::string>(&inputPathString), "path to input EPW file")
+    ("repeat,r", boost::program_options::value<int>(&repeat), "number of conversions to time (default: 10)");
+
+  boost::program_options::positional_options_description pos;
+  pos.add("input-path", -1);
+
+  boost::program_options::variables_map vm;
+  try
+  {
+    boost::program_options::store(boost::program_options::command_line_parser(argc,
+      argv).options(desc).positional(pos).run(), vm);
+    boost::program_options::notify(vm);
+  }
+  catch(std::exception&)
+  {
+    std::cout << "Execution failed: check arguments and retry."<< std::endl << std::endl;
+    usage(desc);
+    return EXIT_FAILURE;
+  }
+
+  if(vm.count("help"))
+  {
+    usage(desc);
+    return EXIT_SUCCESS;
+  }
+
+  if(!vm.count("input-path") || repeat < 1)
+  {
+    usage(desc);
+    return EXIT_FAILURE;
+  }
+
+  openstudio::path inputPath = openstudio::toPath(inputPathString);
+  openstudio::path streamPath = openstudio::toPath("epw2wthbench-stream.wth");
+  openstudio::path fullPath = openstudio::toPath("epw2wthbench-full.wth");
+
+  unsigned long records = 0;
+  boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  for(int i=0;i<repeat;i++)
+  {
+    contamutils::EpwToWthConverter converter;
+    if(!converter.convert(openstudio::toString(inputPath),openstudio::toString(streamPath)))
+    {
+      std::cout << "Streaming conversion failed: " << converter.errorMessage() << std::endl;
+      return EXIT_FAILURE;
+    }
+    records = converter.records();
+  }
+  double streamSeconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+
+  start = boost::chrono::steady_clock::now();
+  for(int i=0;i<repeat;i++)
+  {
+    try
+    {
+      openstudio::EpwFile epwFile(inputPath,true);
+      if(!epwFile.translateToWth(fullPath))
+      {
+        std::cout << "EpwFile conversion failed" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    catch(std::exception&)
+    {
+      std::cout << "Could not open EPW file '" << inputPathString << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  double fullSeconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+
+  std::cout << "Records per file: " << records << std::endl;
+  std::cout << "Streaming: " << streamSeconds/repeat << " s/file, " << records*repeat/streamSeconds << " records/s" << std::endl;
+  std::cout << "EpwFile:   " << fullSeconds/repeat << " s/file, " << records*repeat/fullSeconds << " records/s" << std::endl;
+  std::cout << "Speedup:   " << fullSeconds/streamSeconds << std::endl;
+
+  unsigned long lines;
+  unsigned long mismatches = compareWth(openstudio::toString(streamPath),openstudio::toString(fullPath),lines);
+  if(mismatches > 0)
+  {
+    std::cout << mismatches << " of " << lines << " WTH lines differ" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "All " << lines << " WTH lines match" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,269 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+// A stand-in for ContamX and SimReadX, so that compinf, surfinf and
+// simplefitinf can be run (and timed, and their output compared between
+// versions) on machines without CONTAM. It reads just enough of the PRJ to
+// know the zone and path counts and the reporting times, and writes made up
+// but repeatable path flows for them:
+//
+//   fakecontamx model.prj     writes an empty model.sim, where ContamX
+//                             would write its results
+//   fakecontamx -a model.prj  writes the link flows to model.lfr, like
+//                             SimReadX
+//
+// Point the tools at it with --contamx and --simreadx (or CONTAM_CONTAMX and
+// CONTAM_SIMREADX). The flows depend only on the path number and the time, so
+// the same PRJ always gives the same results.
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static const double PI = 3.14159265358979323846;
+
+struct Run
+{
+  Run() : zones(0), paths(0), steady(false), start(0), end(365*86400), step(3600)
+  {}
+  int zones;
+  int paths;
+  bool steady;
+  long start; // Seconds from midnight January 1st
+  long end;
+  long step;
+};
+
+// Day of the year (from 0) for a CONTAM date like "Jan01", -1 if it isn't one
+static int dayOfYear(const std::string &date)
+{
+  static const char *months[] = {"Jan","Feb","Mar","Apr","May","Jun","Jul","Aug","Sep","Oct","Nov","Dec"};
+  static const int daysBefore[] = {0,31,59,90,120,151,181,212,243,273,304,334};
+  for(int i=0;i<12;i++)
+  {
+    if(date.size() == 5 && !date.compare(0,3,months[i]))
+    {
+      return daysBefore[i] + std::atoi(date.c_str()+3) - 1;
+    }
+  }
+  return -1;
+}
+
+static long seconds(const std::string &time)
+{
+  int h, m, s;
+  if(std::sscanf(time.c_str(),"%d:%d:%d",&h,&m,&s) != 3)
+  {
+    return -1;
+  }
+  return 3600L*h + 60L*m + s;
+}
+
+// The count in front of a section heading like "12 ! zones:", -1 if the line isn't that heading
+static int sectionCount(const std::string &line, const char *heading)
+{
+  std::string::size_type pos = line.find(heading);
+  if(pos == std::string::npos || line.find('!') > pos)
+  {
+    return -1;
+  }
+  return std::atoi(line.c_str());
+}
+
+static bool readPrj(const std::string &path, Run &run)
+{
+  std::ifstream file(path.c_str());
+  if(!file.good())
+  {
+    return false;
+  }
+  std::string line;
+  std::string previous;
+  while(std::getline(file,line))
+  {
+    int count;
+    if((count = sectionCount(line,"! zones:")) >= 0)
+    {
+      run.zones = count;
+    }
+    else if((count = sectionCount(line,"! flow paths:")) >= 0)
+    {
+      run.paths = count;
+    }
+    else if(previous.find("sim_af") != std::string::npos && previous[0] == '!')
+    {
+      run.steady = std::atoi(line.c_str()) == 0;
+    }
+    else if(previous.find("date_0") != std::string::npos && previous[0] == '!')
+    {
+      // date_st time_st date_0 time_0 date_1 time_1 t_step t_list t_scrn
+      std::istringstream fields(line);
+      std::string f[8];
+      for(int i=0;i<8;i++)
+      {
+        fields >> f[i];
+      }
+      int day0 = dayOfYear(f[2]);
+      int day1 = dayOfYear(f[4]);
+      long time0 = seconds(f[3]);
+      long time1 = seconds(f[5]);
+      long list = seconds(f[7]);
+      if(day0 >= 0 && day1 >= 0 && time0 >= 0 && time1 >= 0 && list > 0)
+      {
+        run.start = 86400L*day0 + time0;
+        run.end = 86400L*day1 + time1;
+        run.step = list;
+      }
+    }
+    if(!line.empty() && line[0] == '!')
+    {
+      previous = line;
+    }
+    else
+    {
+      previous.clear();
+    }
+  }
+  return true;
+}
+
+static void flows(int nr, long t, double &F0, double &F1)
+{
+  double day = t/86400.0;
+  double sign = nr%2 ? 1.0 : -1.0;
+  F0 = sign*0.001*(1 + nr%7)*(1.0 + 0.5*std::sin(2.0*PI*day) + 0.25*std::sin(2.0*PI*day/365.0));
+  F1 = -0.0001*(nr%3)*sign;
+}
+
+// The day and time to report a time as, midnight is 24:00:00 of the day before
+static void reportTime(long t, bool first, int &day, long &time)
+{
+  day = t/86400;
+  time = t%86400;
+  if(time == 0 && !first && day > 0)
+  {
+    day--;
+    time = 86400;
+  }
+}
+
+static std::vector<long> reportTimes(const Run &run)
+{
+  std::vector<long> times;
+  if(run.steady)
+  {
+    times.push_back(run.start);
+    return times;
+  }
+  for(long t=run.start+run.step;t<=run.end;t+=run.step)
+  {
+    times.push_back(t);
+  }
+  return times;
+}
+
+// The real .sim layout hasn't been checked against ContamX output, so nothing
+// reads it and this only leaves an empty file where ContamX would put one
+static bool writeSim(const std::string &path)
+{
+  std::ofstream out(path.c_str(),std::ios::out|std::ios::binary);
+  return out.good();
+}
+
+static bool writeLfr(const std::string &path, const Run &run)
+{
+  static const char *months[] = {"Jan","Feb","Mar","Apr","May","Jun","Jul","Aug","Sep","Oct","Nov","Dec"};
+  static const int daysBefore[] = {0,31,59,90,120,151,181,212,243,273,304,334,365};
+  std::ofstream out(path.c_str());
+  if(!out.good())
+  {
+    return false;
+  }
+  std::vector<long> times = reportTimes(run);
+  out << "day\ttime\tdT\tp#\tdP\tF0\tF1" << std::endl;
+  char buffer[128];
+  for(unsigned i=0;i<times.size();i++)
+  {
+    int day;
+    long time;
+    reportTime(times[i],i==0,day,time);
+    int month = 0;
+    while(month < 11 && day >= daysBefore[month+1])
+    {
+      month++;
+    }
+    for(int nr=1;nr<=run.paths;nr++)
+    {
+      double F0, F1;
+      flows(nr,times[i],F0,F1);
+      // Round through float, ContamX keeps its results in single precision
+      std::sprintf(buffer,"%s%02d\t%02ld:%02ld:%02ld\t0\t%d\t1\t%.9g\t%.9g",months[month],day-daysBefore[month]+1,
+        time/3600,time/60%60,time%60,nr,(double)(float)F0,(double)(float)F1);
+      out << buffer << '\n';
+    }
+  }
+  return out.good();
+}
+
+int main(int argc, char *argv[])
+{
+  bool simread = false;
+  std::string prjPath;
+  for(int i=1;i<argc;i++)
+  {
+    if(!std::strcmp(argv[i],"-a"))
+    {
+      simread = true;
+    }
+    else
+    {
+      prjPath = argv[i];
+    }
+  }
+  if(prjPath.empty())
+  {
+    std::cout << "Usage: fakecontamx [-a] model.prj" << std::endl;
+    return EXIT_FAILURE;
+  }
+  Run run;
+  if(!readPrj(prjPath,run))
+  {
+    std::cout << "Failed to read '" << prjPath << "'" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string base = prjPath;
+  std::string::size_type dot = base.rfind('.');
+  if(dot != std::string::npos && base.find_first_of("/\\",dot) == std::string::npos)
+  {
+    base.erase(dot);
+  }
+  std::string outPath = base + (simread ? ".lfr" : ".sim");
+  if(!(simread ? writeLfr(outPath,run) : writeSim(outPath)))
+  {
+    std::cout << "Failed to write '" << outPath << "'" << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+// Compare the per-space, per-hour TimeSeries lookups that compinf used to do
+// with sampling everything onto the schedule grid once and converting all of
+// the zones in a single pass.
+
+#include "FlowConversion.hpp"
+#include "ScheduleGrid.hpp"
+
+#include <utilities/core/CommandLine.hpp>
+#include <utilities/data/TimeSeries.hpp>
+#include <utilities/data/Vector.hpp>
+#include <utilities/time/Date.hpp>
+#include <utilities/time/DateTime.hpp>
+#include <utilities/time/Time.hpp>
+
+#include <boost/chrono.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+void usage( boost::program_options::options_description desc)
+{
+  std::cout << "Usage: infconvbench [options]" << std::endl;
+  std::cout << desc << std::endl;
+}
+
+static openstudio::TimeSeries makeSeries(const openstudio::Date &start, unsigned hours, double base, double amplitude)
+{
+  std::vector<double> values(hours);
+  for(unsigned i=0;i<hours;i++)
+  {
+    values[i] = base + amplitude*std::sin(0.2618*i + base);
+  }
+  return openstudio::TimeSeries(start,openstudio::Time(0,1),openstudio::createVector(values),"");
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned zones = 500;
+  unsigned hours = 8760;
+  boost::program_options::options_description desc("Allowed options");
+
+  desc.add_options()
+    ("help,h", "print help message")
+    ("hours,t", boost::program_options::value<unsigned>(&hours), "number of hourly values (default: 8760)")
+    ("zones,z", boost::program_options::value<unsigned>(&zones), "number of zones (default: 500)");
+
+  boost::program_options::variables_map vm;
+  try
+  {
+    boost::program_options::store(boost::program_options::command_line_parser(argc,
+      argv).options(desc).run(), vm);
+    boost::program_options::notify(vm);
+  }
+  catch(std::exception&)
+  {
+    std::cout << "Execution failed: check arguments and retry."<< std::endl << std::endl;
+    usage(desc);
+    return EXIT_FAILURE;
+  }
+
+  if(vm.count("help"))
+  {
+    usage(desc);
+    return EXIT_SUCCESS;
+  }
+
+  if(!zones || !hours)
+  {
+    usage(desc);
+    return EXIT_FAILURE;
+  }
+
+  openstudio::Date startDate(openstudio::MonthOfYear::Jan,1);
+  openstudio::DateTime startDateTime(startDate);
+  openstudio::Time delta(0,1);
+  openstudio::DateTime endDateTime = startDateTime + openstudio::Time(0,hours);
+  openstudio::TimeSeries seriesP = makeSeries(startDate,hours,101325.0,500.0);
+  openstudio::TimeSeries seriesT = makeSeries(startDate,hours,10.0,15.0);
+  std::vector<openstudio::TimeSeries> infiltration;
+  for(unsigned i=0;i<zones;i++)
+  {
+    infiltration.push_back(makeSeries(startDate,hours,0.01*(i%7+1),0.005));
+  }
+
+  // The old way: three lookups per hour per zone
+  boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  std::vector<std::vector<double> > oldValues;
+  for(unsigned z=0;z<zones;z++)
+  {
+    std::vector<double> values;
+    for(openstudio::DateTime current=startDateTime+delta; current <= endDateTime; current += delta)
+    {
+      double inf = infiltration[z].value(current);
+      double P = seriesP.value(current);
+      double T = seriesT.value(current) + 273.15;
+      values.push_back(inf*287.058*T/P);
+    }
+    oldValues.push_back(values);
+  }
+  double oldSeconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+
+  // The new way: sample once, then convert everything in one pass
+  start = boost::chrono::steady_clock::now();
+  double step = delta.totalDays();
+  std::size_t steps = hours;
+  std::vector<double> P(steps);
+  std::vector<double> T(steps);
+  contamutils::sampleOntoGrid(seriesP,startDateTime,step,steps,&P[0]);
+  contamutils::sampleOntoGrid(seriesT,startDateTime,step,steps,&T[0]);
+  for(std::size_t i=0;i<steps;i++)
+  {
+    T[i] += 273.15;
+  }
+  std::vector<double> factor(steps);
+  contamutils::volumeFlowFactors(&P[0],&T[0],steps,&factor[0]);
+  std::vector<double> flow(zones*steps);
+  for(unsigned z=0;z<zones;z++)
+  {
+    contamutils::sampleOntoGrid(infiltration[z],startDateTime,step,steps,&flow[z*steps]);
+  }
+  double sampleSeconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+  contamutils::massToVolumeFlow(&flow[0],zones,steps,&factor[0],&flow[0]);
+  double newSeconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+
+  double maxDifference = 0.0;
+  for(unsigned z=0;z<zones;z++)
+  {
+    if(oldValues[z].size() != steps)
+    {
+      std::cout << "Step count mismatch: " << oldValues[z].size() << " vs. " << steps << std::endl;
+      return EXIT_FAILURE;
+    }
+    for(std::size_t i=0;i<steps;i++)
+    {
+      maxDifference = std::max(maxDifference,std::abs(oldValues[z][i]-flow[z*steps+i]));
+    }
+  }
+
+  std::cout << "Zones x steps:   " << zones << " x " << steps << std::endl;
+  std::cout << "TimeSeries loop: " << oldSeconds << " s" << std::endl;
+  std::cout << "Grid conversion: " << newSeconds << " s (" << sampleSeconds << " s sampling, "
+    << newSeconds-sampleSeconds << " s converting)" << std::endl;
+  std::cout << "Speedup:         " << oldSeconds/newSeconds << std::endl;
+  std::cout << "Max difference:  " << maxDifference << " m^3/s" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,268 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+// Time loading OSM files the old way, through the VersionTranslator, against
+// parsing current files straight into a model, serially and with the objects
+// split over --jobs threads, and with the airflow view that compinf, surfinf
+// and simplefitinf use. It runs on every OSM in --models-dir (default:
+// models) or the files given on the command line, and on scalable demo models
+// (see DemoModel.hpp) of --zones zones, saved to the scratch directory first.
+// Each load is repeated --repeat times and the best time is kept. The results
+// are CSV, one row per file and method.
+
+#include "AirflowView.hpp"
+#include "DemoModel.hpp"
+#include "JobQueue.hpp"
+#include "ModelLoader.hpp"
+
+#include <model/Model.hpp>
+#include <utilities/core/CommandLine.hpp>
+#include <utilities/core/Path.hpp>
+
+#include <boost/chrono.hpp>
+#include <boost/filesystem.hpp>
+
+#include <QString>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+void usage( boost::program_options::options_description desc)
+{
+  std::cout << "Usage: loadbench [options] [OSM files]" << std::endl;
+  std::cout << desc << std::endl;
+}
+
+enum Method {Translated, Direct, DirectParallel, View};
+
+static const char *methodName(Method method)
+{
+  static const char *names[] = {"version_translator","direct","direct_parallel","airflow_view"};
+  return names[method];
+}
+
+// Best time of repeat loads [s], negative if the load failed
+static double timeLoad(const openstudio::path &path, Method method, int jobs, int repeat, std::size_t &objects)
+{
+  double best = -1.0;
+  for(int i=0;i<repeat;i++)
+  {
+    boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+    boost::optional<openstudio::model::Model> model;
+    contamutils::AirflowView view;
+    if(method == Translated)
+    {
+      model = contamutils::loadModelTranslated(path);
+    }
+    else if(method == View)
+    {
+      if(view.load(path))
+      {
+        model = view.model();
+      }
+    }
+    else
+    {
+      model = contamutils::loadModelDirect(path,method == Direct ? 1 : jobs);
+    }
+    double seconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+    if(!model)
+    {
+      return -1.0;
+    }
+    objects = model->objects().size();
+    if(best < 0.0 || seconds < best)
+    {
+      best = seconds;
+    }
+  }
+  return best;
+}
+
+int main(int argc, char *argv[])
+{
+  std::string modelsDirString = "models";
+  std::string outputPathString = "-";
+  std::string scratchDirString = "loadbench";
+  std::string templatePathString;
+  std::vector<std::string> inputPathStrings;
+  std::vector<int> sizes;
+  int jobs = 0;
+  int repeat = 3;
+  boost::program_options::options_description desc("Allowed options");
+
+  desc.add_options()
+    ("help,h", "print help message")
+    ("input-path,i", boost::program_options::value<std::vector<std::string> >(&inputPathStrings), "OSM file to load, instead of everything in the models directory")
+    ("jobs,j", boost::program_options::value<int>(&jobs), "threads for the parallel parse (default: all cores)")
+    ("models-dir", boost::program_options::value<std::string>(&modelsDirString), "directory of OSM files to load (default: models)")
+    ("output-path,o", boost::program_options::value<std::string>(&outputPathString), "CSV file to write the results to (default: - for the console)")
+    ("repeat,r", boost::program_options::value<int>(&repeat), "loads of each file per method, the best counts (default: 3)")
+    ("scratch-dir", boost::program_options::value<std::string>(&scratchDirString), "directory for the synthetic models (default: loadbench)")
+    ("template", boost::program_options::value<std::string>(&templatePathString), "template OSM for the synthetic models")
+    ("zones,z", boost::program_options::value<std::vector<int> >(&sizes)->multitoken(), "zone counts of the synthetic models (default: 1024 4096 10000, 0 for none)");
+
+  boost::program_options::positional_options_description pos;
+  pos.add("input-path", -1);
+
+  boost::program_options::variables_map vm;
+  try
+  {
+    boost::program_options::store(boost::program_options::command_line_parser(argc,
+      argv).options(desc).positional(pos).run(), vm);
+    boost::program_options::notify(vm);
+  }
+  catch(std::exception&)
+  {
+    std::cout << "Execution failed: check arguments and retry."<< std::endl << std::endl;
+    usage(desc);
+    return EXIT_FAILURE;
+  }
+
+  if(vm.count("help"))
+  {
+    usage(desc);
+    return EXIT_SUCCESS;
+  }
+
+  if(repeat < 1)
+  {
+    repeat = 1;
+  }
+  if(jobs <= 0)
+  {
+    jobs = contamutils::JobQueue::defaultThreadCount();
+  }
+  if(sizes.empty())
+  {
+    int defaults[] = {1024,4096,10000};
+    sizes.assign(defaults,defaults+3);
+  }
+
+  std::vector<openstudio::path> paths;
+  for(unsigned i=0;i<inputPathStrings.size();i++)
+  {
+    paths.push_back(openstudio::toPath(inputPathStrings[i]));
+  }
+  if(paths.empty())
+  {
+    boost::system::error_code ec;
+    for(boost::filesystem::directory_iterator iter(openstudio::toPath(modelsDirString),ec), end;!ec && iter!=end;++iter)
+    {
+      if(iter->path().extension() == ".osm")
+      {
+        paths.push_back(iter->path());
+      }
+    }
+    std::sort(paths.begin(),paths.end());
+  }
+
+  // Make the synthetic models
+  std::sort(sizes.begin(),sizes.end());
+  if(sizes.back() > 0)
+  {
+    openstudio::path scratch = openstudio::toPath(scratchDirString);
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(scratch,ec);
+    if(ec)
+    {
+      std::cout << "Failed to create scratch directory '" << scratchDirString << "'." << std::endl;
+      return EXIT_FAILURE;
+    }
+    boost::optional<openstudio::model::Model> base = contamutils::loadDemoTemplate(templatePathString.empty()
+      ? openstudio::path() : openstudio::toPath(templatePathString));
+    if(!base)
+    {
+      return EXIT_FAILURE;
+    }
+    for(unsigned i=0;i<sizes.size();i++)
+    {
+      if(sizes[i] < 1)
+      {
+        continue;
+      }
+      openstudio::path path = scratch / openstudio::toPath(QString("synthetic-%1.osm").arg(sizes[i]).toStdString());
+      openstudio::model::Model model = base->clone().cast<openstudio::model::Model>();
+      if(!contamutils::buildScalableModel(model,contamutils::scaledDemoModel(sizes[i],contamutils::Grid))
+        || !model.save(path,true))
+      {
+        std::cout << "Failed to make the " << sizes[i] << " zone model." << std::endl;
+        return EXIT_FAILURE;
+      }
+      paths.push_back(path);
+    }
+  }
+
+  if(paths.empty())
+  {
+    std::cout << "No models to load." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::ofstream file;
+  if(outputPathString != "-")
+  {
+    file.open(outputPathString.c_str());
+    if(!file.good())
+    {
+      std::cout << "Failed to open '" << outputPathString << "'." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostream &out = outputPathString == "-" ? std::cout : file;
+  out << "model,size_mib,version,objects,method,jobs,seconds,speedup" << std::endl;
+
+  std::string current = contamutils::currentOsmVersion();
+  for(unsigned i=0;i<paths.size();i++)
+  {
+    boost::system::error_code ec;
+    double size = boost::filesystem::file_size(paths[i],ec)/1048576.0;
+    boost::optional<std::string> version = contamutils::osmVersion(paths[i]);
+    std::string name = openstudio::toString(paths[i].filename());
+    double translated = 0.0;
+    for(int m=Translated;m<=View;m++)
+    {
+      Method method = (Method)m;
+      if(method != Translated && (!version || *version != current))
+      {
+        // Not current, so the tools would go through the VersionTranslator anyway
+        continue;
+      }
+      std::size_t objects = 0;
+      double seconds = timeLoad(paths[i],method,jobs,repeat,objects);
+      if(seconds < 0.0)
+      {
+        std::cout << "Failed to load '" << openstudio::toString(paths[i]) << "' (" << methodName(method) << ")." << std::endl;
+        continue;
+      }
+      if(method == Translated)
+      {
+        translated = seconds;
+      }
+      out << name << ',' << size << ',' << (version ? *version : "") << ',' << objects << ',' << methodName(method)
+        << ',' << (method == DirectParallel ? jobs : 1) << ',' << seconds << ','
+        << (translated > 0.0 ? translated/seconds : 0.0) << std::endl;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,332 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+// Time each stage of the tools on scalable demo models (see DemoModel.hpp) of
+// increasing size, 4 to 10000 zones by default, and write the scaling curves
+// as CSV: one row per size and stage with the wall time, CPU time, child CPU
+// time (the simulation) and the process peak memory at the end of the stage.
+// The stages are building the model, translation, writing the PRJ, running
+// the simulation, converting the results with SimReadX, reading the path
+// flows and building compinf's infiltration schedules.
+//
+// The sizes run smallest first. Peak memory only goes up, so each row's peak
+// is that of the biggest model so far, which is the one being timed. There's
+// no need for CONTAM, point --contamx and --simreadx at fakecontamx to get
+// repeatable results for every size.
+
+#include "ContamResults.hpp"
+#include "DemoModel.hpp"
+#include "FlowConversion.hpp"
+#include "PrjWriter.hpp"
+#include "Profiler.hpp"
+#include "ScheduleGrid.hpp"
+#include "SimulationRunner.hpp"
+#include "TranslationCache.hpp"
+
+#include <airflow/contam/ForwardTranslator.hpp>
+#include <model/Model.hpp>
+#include <model/RunPeriod.hpp>
+#include <model/ScheduleFixedInterval.hpp>
+#include <model/Space.hpp>
+#include <model/SpaceInfiltrationDesignFlowRate.hpp>
+#include <model/ThermalZone.hpp>
+#include <utilities/core/CommandLine.hpp>
+#include <utilities/core/Path.hpp>
+#include <utilities/data/Vector.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/foreach.hpp>
+
+#include <QString>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+void usage( boost::program_options::options_description desc)
+{
+  std::cout << "Usage: modelbench [options]" << std::endl;
+  std::cout << desc << std::endl;
+}
+
+static void writeRow(std::ostream &out, const contamutils::DemoModelSettings &settings, const std::string &phase,
+  const contamutils::ProcessTimes &start, const contamutils::ProcessTimes &end)
+{
+  out << settings.stories*settings.zonesPerStory << ',' << settings.stories << ',' << settings.zonesPerStory << ','
+    << phase << ',' << boost::chrono::duration<double>(end.wall - start.wall).count() << ','
+    << end.cpu - start.cpu << ',' << end.childCpu - start.childCpu << ',' << contamutils::peakMemory() << std::endl;
+}
+
+// Build, translate, write, simulate and read back one model, writing a row for each stage
+static bool runSize(const openstudio::model::Model &base, const contamutils::DemoModelSettings &settings, int days,
+  const contamutils::SimulationRunner &runner, const openstudio::path &scratch, std::ostream &out)
+{
+  contamutils::ProcessTimes start = contamutils::ProcessTimes::now();
+  openstudio::model::Model model = base.clone().cast<openstudio::model::Model>();
+  openstudio::model::RunPeriod runPeriod = model.getUniqueModelObject<openstudio::model::RunPeriod>();
+  runPeriod.setBeginMonth(1);
+  runPeriod.setBeginDayOfMonth(1);
+  runPeriod.setEndMonth(1);
+  runPeriod.setEndDayOfMonth(days);
+  boost::optional<openstudio::model::Model> built = contamutils::buildScalableModel(model,settings);
+  if(!built)
+  {
+    std::cout << "Failed to build OpenStudio model." << std::endl;
+    return false;
+  }
+  contamutils::ProcessTimes end = contamutils::ProcessTimes::now();
+  writeRow(out,settings,"model_build",start,end);
+
+  start = end;
+  contamutils::Translation translation;
+  std::string error;
+  if(!contamutils::translateModel(model,contamutils::TranslatorSettings(),openstudio::path(),translation,error))
+  {
+    std::cout << error << std::endl;
+    return false;
+  }
+  openstudio::contam::IndexModel cx = translation.model.get();
+  end = contamutils::ProcessTimes::now();
+  writeRow(out,settings,"translation",start,end);
+
+  if(contamutils::setOutputTimestep(cx,3600) < 0)
+  {
+    std::cout << "Failed to set the output timestep." << std::endl;
+    return false;
+  }
+  openstudio::path prjPath = scratch / openstudio::toPath(QString("model-%1.prj")
+    .arg(settings.stories*settings.zonesPerStory).toStdString());
+  start = contamutils::ProcessTimes::now();
+  if(!contamutils::writePrj(cx,prjPath))
+  {
+    std::cout << "Failed to write file '" << openstudio::toString(prjPath) << "'." << std::endl;
+    return false;
+  }
+  end = contamutils::ProcessTimes::now();
+  writeRow(out,settings,"prj_write",start,end);
+
+  start = end;
+  if(!runner.runContamX(prjPath,error))
+  {
+    std::cout << error << std::endl;
+    return false;
+  }
+  end = contamutils::ProcessTimes::now();
+  writeRow(out,settings,"contamx",start,end);
+
+  start = end;
+  if(!runner.runSimReadX(prjPath,error))
+  {
+    std::cout << error << std::endl;
+    return false;
+  }
+  end = contamutils::ProcessTimes::now();
+  writeRow(out,settings,"simreadx",start,end);
+
+  start = end;
+  std::vector<std::vector<int> > pathIds = cx.zoneExteriorFlowPaths();
+  std::vector<int> pathNrs;
+  std::vector<int> pathZone;
+  for(unsigned i=0;i<pathIds.size();i++)
+  {
+    for(unsigned j=0;j<pathIds[i].size();j++)
+    {
+      pathNrs.push_back(pathIds[i][j]);
+      pathZone.push_back(i);
+    }
+  }
+  openstudio::path lfrPath = prjPath;
+  lfrPath.replace_extension(openstudio::toPath("lfr").string());
+  contamutils::PathFlowMatrix pathFlows;
+  if(!contamutils::readPathInfiltration(cx,lfrPath,pathNrs,pathFlows))
+  {
+    std::cout << pathFlows.errorMessage() << std::endl;
+    return false;
+  }
+  end = contamutils::ProcessTimes::now();
+  writeRow(out,settings,"sim_parse",start,end);
+
+  if(!translation.startDateTime || !translation.endDateTime)
+  {
+    std::cout << "The translated model is a steady-state model, skipping the schedules" << std::endl;
+    return true;
+  }
+  // The same steps as compinf, with the steady-state weather
+  start = end;
+  openstudio::DateTime startDateTime = translation.startDateTime.get();
+  openstudio::Time delta(0,1);
+  double step = delta.totalDays();
+  std::size_t steps = contamutils::gridSteps(startDateTime,translation.endDateTime.get(),delta);
+  std::vector<double> P(steps,cx.ssWeather().barpres());
+  std::vector<double> T(steps,cx.ssWeather().Tambt());
+  std::vector<double> factor(steps);
+  std::vector<double> massFlow(pathIds.size()*steps,0.0);
+  std::vector<double> volumeFlow(pathIds.size()*steps);
+  if(steps)
+  {
+    contamutils::volumeFlowFactors(&P[0],&T[0],steps,&factor[0]);
+    contamutils::accumulateOntoGrid(pathFlows,pathZone.empty() ? 0 : &pathZone[0],pathIds.size(),startDateTime,step,
+      steps,&massFlow[0]);
+    contamutils::massToVolumeFlow(&massFlow[0],pathIds.size(),steps,&factor[0],&volumeFlow[0]);
+  }
+  openstudio::Vector values(steps);
+  BOOST_FOREACH(openstudio::model::Space space, model.getConcreteModelObjects<openstudio::model::Space>())
+  {
+    boost::optional<openstudio::model::ThermalZone> zone = space.thermalZone();
+    if(!zone || translation.zoneMap.count(zone->handle()) == 0)
+    {
+      continue;
+    }
+    std::size_t offset = (translation.zoneMap[zone->handle()]-1)*steps;
+    std::copy(volumeFlow.begin()+offset,volumeFlow.begin()+offset+steps,values.begin());
+    openstudio::TimeSeries infiltrationTimeSeries(startDateTime.date(),delta,values,"");
+    openstudio::model::ScheduleFixedInterval schedule(model);
+    schedule.setTimeSeries(infiltrationTimeSeries);
+    openstudio::model::SpaceInfiltrationDesignFlowRate infObj(model);
+    infObj.setDesignFlowRate(1.0);
+    infObj.setConstantTermCoefficient(1.0);
+    infObj.setSpace(space);
+    infObj.setSchedule(schedule);
+  }
+  end = contamutils::ProcessTimes::now();
+  writeRow(out,settings,"schedule_build",start,end);
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  std::string inputPathString;
+  std::string outputPathString = "-";
+  std::string scratchDirString = "modelbench";
+  std::string floorPlateString = "grid";
+  std::string contamxString;
+  std::string simreadxString;
+  std::string configString;
+  std::vector<int> sizes;
+  int days = 7;
+  boost::program_options::options_description desc("Allowed options");
+
+  desc.add_options()
+    ("config", boost::program_options::value<std::string>(&configString), "config file naming the CONTAM programs")
+    ("contamx", boost::program_options::value<std::string>(&contamxString), "path to ContamX (or fakecontamx)")
+    ("days,d", boost::program_options::value<int>(&days), "length of the simulation in days, up to 31 (default: 7)")
+    ("floor-plate,f", boost::program_options::value<std::string>(&floorPlateString), "layout of each story: bar|grid|corridor (default: grid)")
+    ("help,h", "print help message")
+    ("input-path,i", boost::program_options::value<std::string>(&inputPathString), "path to template OSM file")
+    ("no-hvac", "leave out the air systems")
+    ("output-path,o", boost::program_options::value<std::string>(&outputPathString), "CSV file to write the results to (default: - for the console)")
+    ("scratch-dir", boost::program_options::value<std::string>(&scratchDirString), "directory for the PRJ and results files (default: modelbench)")
+    ("simreadx", boost::program_options::value<std::string>(&simreadxString), "path to SimReadX (or fakecontamx)")
+    ("zones,z", boost::program_options::value<std::vector<int> >(&sizes)->multitoken(), "zone counts to run (default: 4 16 64 256 1024 4096 10000)");
+
+  boost::program_options::variables_map vm;
+  try
+  {
+    boost::program_options::store(boost::program_options::command_line_parser(argc,
+      argv).options(desc).run(), vm);
+    boost::program_options::notify(vm);
+  }
+  catch(std::exception&)
+  {
+    std::cout << "Execution failed: check arguments and retry."<< std::endl << std::endl;
+    usage(desc);
+    return EXIT_FAILURE;
+  }
+
+  if(vm.count("help"))
+  {
+    usage(desc);
+    return EXIT_SUCCESS;
+  }
+
+  contamutils::FloorPlate floorPlate;
+  if(!contamutils::parseFloorPlate(floorPlateString,floorPlate))
+  {
+    std::cout << "Unknown floor plate '" << floorPlateString << "'." << std::endl << std::endl;
+    usage(desc);
+    return EXIT_FAILURE;
+  }
+  if(days < 1 || days > 31)
+  {
+    std::cout << "The simulation has to be 1 to 31 days long." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if(sizes.empty())
+  {
+    int defaults[] = {4,16,64,256,1024,4096,10000};
+    sizes.assign(defaults,defaults+7);
+  }
+  std::sort(sizes.begin(),sizes.end());
+  if(sizes[0] < 1)
+  {
+    std::cout << "The zone counts must be at least 1." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  contamutils::SimulationRunner runner;
+  if(!runner.configure(contamxString,simreadxString,configString))
+  {
+    std::cout << runner.errorMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  openstudio::path scratch = openstudio::toPath(scratchDirString);
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(scratch,ec);
+  if(ec)
+  {
+    std::cout << "Failed to create scratch directory '" << scratchDirString << "'." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  boost::optional<openstudio::model::Model> base = contamutils::loadDemoTemplate(inputPathString.empty()
+    ? openstudio::path() : openstudio::toPath(inputPathString));
+  if(!base)
+  {
+    return EXIT_FAILURE;
+  }
+
+  std::ofstream file;
+  if(outputPathString != "-")
+  {
+    file.open(outputPathString.c_str());
+    if(!file.good())
+    {
+      std::cout << "Failed to open '" << outputPathString << "'." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostream &out = outputPathString == "-" ? std::cout : file;
+  out << "zones,stories,zones_per_story,phase,wall_s,cpu_s,child_cpu_s,process_peak_memory_mib_at_end" << std::endl;
+
+  for(unsigned i=0;i<sizes.size();i++)
+  {
+    contamutils::DemoModelSettings settings = contamutils::scaledDemoModel(sizes[i],floorPlate);
+    settings.hvac = !vm.count("no-hvac");
+    if(!runSize(*base,settings,days,runner,scratch,out))
+    {
+      std::cout << "Failed at " << sizes[i] << " zones." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
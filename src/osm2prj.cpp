@@ -18,47 +18,67 @@
  *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  **********************************************************************/
 
+#include "EpwToWth.hpp"
+#include "JobQueue.hpp"
+#include "ModelLoader.hpp"
+#include "PrjWriter.hpp"
+#include "Profiler.hpp"
+#include "TranslationCache.hpp"
+#include "WthCache.hpp"
+
 #include <airflow/contam/ForwardTranslator.hpp>
 #include <model/Model.hpp>
-#include <model/WeatherFile.hpp>
-#include <osversion/VersionTranslator.hpp>
 #include <utilities/core/CommandLine.hpp>
 #include <utilities/core/Path.hpp>
 #include <utilities/sql/SqlFile.hpp>
 
+#include <boost/bind.hpp>
+#include <boost/chrono.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <fstream>
+#include <sstream>
 #include <string>
 #include <iostream>
+#include <vector>
 
 void usage( boost::program_options::options_description desc)
 {
   std::cout << "Usage: osm2prj --input-path=./path/to/input.osm" << std::endl;
   std::cout << "   or: osm2prj input.osm" << std::endl;
+  std::cout << "   or: osm2prj --batch=manifest.txt [--jobs=N]" << std::endl;
   std::cout << desc << std::endl;
 }
 
-boost::optional<openstudio::EpwFile> translateEpw(openstudio::path epwpath, openstudio::path outpath)
+// Everything needed to set up a translator, checked once and shared by all the models
+struct TranslationSettings
 {
-  boost::optional<openstudio::EpwFile> epw;
-  try
-  {
-    openstudio::EpwFile epwFile(epwpath,true);
-    try
-    {
-      epwFile.translateToWth(outpath);
-    }
-    catch(...) // Is this going to work?
-    {
-      std::cout << "Translation of EPW file failed, weather will be steady state" << std::endl;
-      return false;
-    }
-    epw = boost::optional<openstudio::EpwFile>(epwFile);
-  }
-  catch(...)
+  contamutils::TranslatorSettings translator;
+  boost::optional<openstudio::path> translationCacheDir;
+  boost::optional<openstudio::path> wthCacheDir;
+  contamutils::Profiler *profiler;
+};
+
+struct BatchJob
+{
+  openstudio::path inputPath;
+  openstudio::path prjPath;
+  bool success;
+  double seconds;
+  std::string log;
+};
+
+// Use the same converter as the WTH cache, so the WTH is the same with or without a cache
+bool translateEpw(openstudio::path epwpath, openstudio::path outpath, std::ostream &out=std::cout)
+{
+  contamutils::EpwToWthConverter converter;
+  if(!converter.convert(openstudio::toString(epwpath),openstudio::toString(outpath)))
   {
-    std::cout << "Failed to correctly load EPW file, weather will be steady state" << std::endl;
+    out << "Translation of EPW file failed (" << converter.errorMessage() << "), weather will be steady state" << std::endl;
     return false;
   }
-  return epw;
+  return true;
 }
 /*
 static boost::optional<openstudio::path> findFile(openstudio::path base, std::string filename)
@@ -91,21 +111,288 @@ static boost::optional<openstudio::path> findFile(openstudio::path base, std::st
 }
 */
 
+// Translate one model and write out the PRJ (plus WTH and CVF files when possible). Progress and error
+// messages go to the given stream so that batch runs can keep the output from each model together.
+static bool translateOne(openstudio::path inputPath, openstudio::path prjPath, const TranslationSettings &settings,
+  std::ostream &out)
+{
+  openstudio::path cvfPath = prjPath;
+  cvfPath.replace_extension(openstudio::toPath("cvf").string());
+  openstudio::path wthPath = prjPath;
+  wthPath.replace_extension(openstudio::toPath("wth").string());
+
+  // A cached translation doesn't need the model at all, so look there before loading it
+  boost::optional<contamutils::TranslationCache> translationCache;
+  std::string translationKey;
+  if(settings.translationCacheDir)
+  {
+    translationCache = contamutils::TranslationCache(*settings.translationCacheDir);
+    translationKey = contamutils::TranslationCache::key(inputPath,boost::none,settings.translator);
+  }
+  contamutils::Translation translation;
+  contamutils::ProfilePhase cachePhase(settings.profiler,"translation");
+  bool cached = !translationKey.empty() && translationCache->load(translationKey,cvfPath,translation);
+  cachePhase.stop();
+  if(cached)
+  {
+    out << "Using cached translation" << std::endl;
+  }
+  else
+  {
+    // Open the model
+    contamutils::ProfilePhase loadPhase(settings.profiler,"osm_load");
+    boost::optional<openstudio::model::Model> model = contamutils::loadModel(inputPath);
+    loadPhase.stop();
+
+    if(!model)
+    {
+      out << "Unable to load file '"<< openstudio::toString(inputPath) << "' as an OpenStudio model." << std::endl;
+      return false;
+    }
+
+    // Try to find and connect a results file - this really should be done using the RunManager database,
+    // but I don't know how to do that and it can be done right at a later date by someone who knows how
+    openstudio::path dir = inputPath.parent_path() / inputPath.stem();
+    //boost::optional<openstudio::path> sqlpath = findFile(dir,"eplusout.sql");
+    //if(sqlpath) {
+      //std::cout<<"Found results file, attaching it to the model."<<std::endl;
+      //model->setSqlFile(openstudio::SqlFile(*sqlpath));
+    //}
+
+    std::string error;
+    contamutils::ProfilePhase translatePhase(settings.profiler,"translation");
+    if(!contamutils::translateModel(*model,settings.translator,cvfPath,translation,error))
+    {
+      out << error << std::endl;
+      return false;
+    }
+    if(!translationKey.empty() && !translationCache->store(translationKey,translation))
+    {
+      out << "Translation cache failed (" << translationCache->errorMessage() << ")" << std::endl;
+    }
+  }
+  boost::optional<openstudio::contam::IndexModel> cx = translation.model;
+
+  std::ofstream file(openstudio::toString(prjPath).c_str(),std::ios::out|std::ios::binary);
+  if(file.good())
+  {
+    // Attempt to translate weather, the path comes from the OSM's weather file object (or the cache)
+    contamutils::ProfilePhase weatherPhase(settings.profiler,"epw_to_wth");
+    boost::optional<openstudio::path> path = translation.weatherPath;
+    if(path)
+    {
+      boost::optional<openstudio::path> epwPath;// = findFile(dir, openstudio::toString(path->string()));
+      if(boost::filesystem::exists(*path))
+      {
+        epwPath = *path;
+      }
+      else if(boost::filesystem::exists(inputPath.parent_path() / *path))
+      {
+        epwPath = inputPath.parent_path() / *path;
+      }
+      if(epwPath && settings.wthCacheDir)
+      {
+        // Convert once into the shared cache, then link the result in next to the PRJ
+        contamutils::WthCache cache(*settings.wthCacheDir);
+        boost::optional<openstudio::path> cachedPath = cache.wthPath(*epwPath);
+        if(cachedPath && cache.linkTo(*cachedPath,wthPath))
+        {
+          cx->setWTHpath(openstudio::toString(wthPath));
+        }
+        else
+        {
+          out << "WTH cache failed (" << cache.errorMessage() << "), WTH file will not be used in simulation" << std::endl;
+        }
+      }
+      else if(epwPath)
+      {
+        if(translateEpw(*epwPath,wthPath,out))
+        {
+          cx->setWTHpath(openstudio::toString(wthPath));
+        }
+        else
+        {
+          out << "EPW translation to WTH failed, WTH file will not be used in simulation" << std::endl;
+        }
+      }
+      else
+      {
+        out << "Failed to find EPW file, WTH file will not be written" << std::endl;
+      }
+    }
+    else
+    {
+      out << "No weather file path, WTH file will not be written" << std::endl;
+    }
+    weatherPhase.stop();
+
+    // Use the CVF if the translation wrote one
+    if(translation.cvfPath) {
+      // Need to set the CVF file in the PRJ, this path may need to be made relative. Not too sure
+      cx->setCVFpath(openstudio::toString(cvfPath));
+    }
+    contamutils::ProfilePhase writePhase(settings.profiler,"prj_write");
+    if(!contamutils::writePrj(*cx,file))
+    {
+      out << "Failed to write file '" << openstudio::toString(prjPath) << "'." << std::endl;
+      return false;
+    }
+  }
+  else {
+    out << "Failed to open file '"<< openstudio::toString(prjPath) << "'." << std::endl;
+    out << "Check that this file location is accessible and may be written." << std::endl;
+    return false;
+  }
+  file.close();
+
+  return true;
+}
+
+static void runBatchJob(BatchJob *job, const TranslationSettings *settings, bool verbose, boost::mutex *outputMutex)
+{
+  std::stringstream log;
+  boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  job->success = false;
+  try
+  {
+    job->success = translateOne(job->inputPath,job->prjPath,*settings,log);
+  }
+  catch(std::exception &e)
+  {
+    log << "Translation threw an exception: " << e.what() << std::endl;
+  }
+  catch(...)
+  {
+    log << "Translation threw an unknown exception" << std::endl;
+  }
+  job->seconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+  job->log = log.str();
+  if(verbose)
+  {
+    boost::mutex::scoped_lock lock(*outputMutex);
+    std::cout << (job->success ? "Translated " : "Failed to translate ") << openstudio::toString(job->inputPath)
+      << " in " << job->seconds << " s" << std::endl;
+  }
+}
+
+// The manifest has one model per line: the input OSM path, optionally followed by a tab or comma and the
+// output PRJ path. Blank lines and lines starting with '#' are ignored.
+static bool readManifest(const std::string &manifestPath, std::vector<BatchJob> &jobs)
+{
+  std::ifstream manifest(manifestPath.c_str());
+  if(!manifest.good())
+  {
+    return false;
+  }
+  std::string line;
+  while(std::getline(manifest,line))
+  {
+    std::string::size_type start = line.find_first_not_of(" \t\r");
+    if(start == std::string::npos || line[start] == '#')
+    {
+      continue;
+    }
+    std::string::size_type end = line.find_last_not_of(" \t\r");
+    line = line.substr(start,end-start+1);
+    BatchJob job;
+    std::string::size_type split = line.find_first_of("\t,");
+    std::string input = line.substr(0,split);
+    input = input.substr(0,input.find_last_not_of(" \t")+1);
+    job.inputPath = openstudio::toPath(input);
+    job.prjPath = job.inputPath;
+    job.prjPath.replace_extension(openstudio::toPath("prj").string());
+    if(split != std::string::npos)
+    {
+      std::string output = line.substr(split+1);
+      std::string::size_type first = output.find_first_not_of(" \t");
+      if(first != std::string::npos)
+      {
+        job.prjPath = openstudio::toPath(output.substr(first));
+      }
+    }
+    job.success = false;
+    job.seconds = 0.0;
+    jobs.push_back(job);
+  }
+  return true;
+}
+
+static int runBatch(const std::string &manifestPath, const TranslationSettings &settings, int nthreads, bool verbose)
+{
+  std::vector<BatchJob> jobs;
+  if(!readManifest(manifestPath,jobs))
+  {
+    std::cout << "Failed to read manifest '" << manifestPath << "'." << std::endl;
+    return EXIT_FAILURE;
+  }
+  if(jobs.empty())
+  {
+    std::cout << "No models listed in manifest '" << manifestPath << "'." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  boost::mutex outputMutex;
+  contamutils::JobQueue queue(nthreads);
+  for(unsigned i=0;i<jobs.size();i++)
+  {
+    queue.add(boost::bind(runBatchJob,&jobs[i],&settings,verbose,&outputMutex));
+  }
+  boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  queue.run();
+  double seconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+
+  unsigned nfailed = 0;
+  for(unsigned i=0;i<jobs.size();i++)
+  {
+    if(!jobs[i].success)
+    {
+      nfailed++;
+    }
+  }
+  std::cout << "Translated " << jobs.size()-nfailed << " of " << jobs.size() << " models on " << queue.threadCount()
+    << " worker(s) in " << seconds << " s" << std::endl;
+  if(nfailed > 0)
+  {
+    std::cout << std::endl << "Failures:" << std::endl;
+    for(unsigned i=0;i<jobs.size();i++)
+    {
+      if(!jobs[i].success)
+      {
+        std::cout << openstudio::toString(jobs[i].inputPath) << std::endl << jobs[i].log;
+      }
+    }
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
+
 int main(int argc, char *argv[])
 {
+  contamutils::Profiler profiler("osm2prj");
   std::string inputPathString;
+  std::string batchString;
   std::string leakageDescriptorString="Average";
+  std::string translationCacheString;
+  std::string wthCacheString;
+  std::string profileString;
   double flow=27.1;
   double returnSupplyRatio=1.0;
+  int jobs=0;
   bool setLevel = true;
+  bool verbose = true;
   boost::program_options::options_description desc("Allowed options");
 
   desc.add_options()
+    ("batch,b", boost::program_options::value<std::string>(&batchString), "translate every model listed in a manifest file")
     ("flow,f", boost::program_options::value<double>(&flow), "leakage flow rate per envelope area [m^3/h/m^2]")
     ("help,h", "print help message and exit")
     ("input-path,i", boost::program_options::value<std::string>(&inputPathString), "path to input OSM file")
+    ("jobs,j", boost::program_options::value<int>(&jobs), "number of batch translations to run at once (default: number of cores)")
     ("level,l", boost::program_options::value<std::string>(&leakageDescriptorString), "airtightness: Leaky|Average|Tight (default: Average)")
-    ("quiet,q", "suppress progress output");
+    ("profile", boost::program_options::value<std::string>(&profileString), "write a JSON report of time and memory use by phase to this file (- for the console)")
+    ("quiet,q", "suppress progress output")
+    ("translation-cache", boost::program_options::value<std::string>(&translationCacheString), "directory of translated models shared between runs (default: $CONTAM_TRANSLATION_CACHE)")
+    ("wth-cache,w", boost::program_options::value<std::string>(&wthCacheString), "directory of converted WTH files shared between runs (default: $CONTAM_WTH_CACHE)");
 
   boost::program_options::positional_options_description pos;
   pos.add("input-path", -1);
@@ -134,7 +421,7 @@ int main(int argc, char *argv[])
     return EXIT_SUCCESS;
   }
 
-  if(!vm.count("input-path"))
+  if(!vm.count("input-path") && !vm.count("batch"))
   {
     std::cout << "No input path given." << std::endl << std::endl;
     usage(desc);
@@ -146,32 +433,12 @@ int main(int argc, char *argv[])
     // Probably should do a sanity check of input - but maybe later
     setLevel = false;
   }
-  
-  // Open the model
-  openstudio::path inputPath = openstudio::toPath(inputPathString);
-  openstudio::osversion::VersionTranslator vt;
-  boost::optional<openstudio::model::Model> model = vt.loadModel(inputPath);
 
-  if(!model)
+  if(vm.count("quiet"))
   {
-    std::cout << "Unable to load file '"<< inputPathString << "' as an OpenStudio model." << std::endl;
-    return EXIT_FAILURE;
+    verbose = false;
   }
 
-  // Try to find and connect a results file - this really should be done using the RunManager database,
-  // but I don't know how to do that and it can be done right at a later date by someone who knows how
-  openstudio::path dir = inputPath.parent_path() / inputPath.stem();
-  //boost::optional<openstudio::path> sqlpath = findFile(dir,"eplusout.sql");
-  //if(sqlpath) {
-    //std::cout<<"Found results file, attaching it to the model."<<std::endl;
-    //model->setSqlFile(openstudio::SqlFile(*sqlpath));
-  //}
-
-  openstudio::path prjPath = inputPath.replace_extension(openstudio::toPath("prj").string());
-  openstudio::path cvfPath = inputPath.replace_extension(openstudio::toPath("cvf").string());
-  openstudio::path wthPath = inputPath.replace_extension(openstudio::toPath("wth").string());
-
-  openstudio::contam::ForwardTranslator translator;
   if(setLevel)
   {
     QVector<std::string> known;
@@ -181,76 +448,49 @@ int main(int argc, char *argv[])
       std::cout << "Unknown airtightness level '" << leakageDescriptorString << "'" << std::endl;
       return EXIT_FAILURE;
     }
-    translator.setAirtightnessLevel(leakageDescriptorString);
+  }
+
+  if(!profileString.empty())
+  {
+    profiler.setOutput(profileString);
+    profiler.setInput(vm.count("batch") ? batchString : inputPathString);
+  }
+
+  TranslationSettings settings;
+  settings.profiler = &profiler;
+  settings.translator.setLevel = setLevel;
+  settings.translator.level = leakageDescriptorString;
+  settings.translator.flow = flow;
+  settings.translator.returnSupplyRatio = returnSupplyRatio;
+  if(!translationCacheString.empty())
+  {
+    settings.translationCacheDir = openstudio::toPath(translationCacheString);
   }
   else
   {
-    translator.setExteriorFlowRate(flow,0.65,75.0);
+    settings.translationCacheDir = contamutils::TranslationCache::defaultDirectory();
   }
-  translator.setReturnSupplyRatio(returnSupplyRatio);
-  boost::optional<openstudio::contam::IndexModel> cx = translator.translateModel(model.get());
-  if(!cx)
+  if(!wthCacheString.empty())
   {
-     std::cout << "Translation failed, check errors and warnings for more information." << std::endl;
-     return EXIT_FAILURE;
+    settings.wthCacheDir = openstudio::toPath(wthCacheString);
   }
-  if(!cx->valid())
+  else
   {
-     std::cout << "Translation returned an invalid model, check errors and warnings for more information." << std::endl;
-     return EXIT_FAILURE;
+    settings.wthCacheDir = contamutils::WthCache::defaultDirectory();
   }
 
-  QFile file(openstudio::toQString(prjPath));
-  if(file.open(QFile::WriteOnly))
+  if(vm.count("batch"))
   {
-    QTextStream textStream(&file);
-    // Attempt to translate weather
-    boost::optional<openstudio::model::WeatherFile> weatherFile = model->weatherFile();
-    if(weatherFile)
-    {
-      boost::optional<openstudio::path> path = weatherFile->path();
-      if(path)
-      {
-          boost::optional<openstudio::path> epwPath;// = findFile(dir, openstudio::toString(path->string()));
-        if(epwPath)
-        {
-          if(translateEpw(*epwPath,wthPath))
-          {
-            cx->setWTHpath(openstudio::toString(wthPath));
-          }
-          else
-          {
-            std::cout << "EPW translation to WTH failed, WTH file will not be used in simulation" << std::endl;
-          }
-        }
-        else
-        {
-          std::cout << "Failed to find EPW file, WTH file will not be written" << std::endl;
-        }
-      }
-      else
-      {
-        std::cout << "No path to EPW file, WTH file will not be written" << std::endl;
-      }
-    }
-    else
-    {
-      std::cout << "No weather file object to process, WTH file will not be written" << std::endl;
-    }
-
-    // Write out a CVF if needed
-    if(translator.writeCvFile(cvfPath)) {
-      // Need to set the CVF file in the PRJ, this path may need to be made relative. Not too sure
-      cx->setCVFpath(openstudio::toString(cvfPath));
-    }
-    textStream << openstudio::toQString(cx->toString());
+    return runBatch(batchString,settings,jobs,verbose);
   }
-  else {
-    std::cout << "Failed to open file '"<< openstudio::toString(prjPath) << "'." << std::endl;
-    std::cout << "Check that this file location is accessible and may be written." << std::endl;
+
+  openstudio::path inputPath = openstudio::toPath(inputPathString);
+  openstudio::path prjPath = inputPath;
+  prjPath.replace_extension(openstudio::toPath("prj").string());
+  if(!translateOne(inputPath,prjPath,settings,std::cout))
+  {
     return EXIT_FAILURE;
   }
-  file.close();
-  
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,154 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+// Compare writing a PRJ the way the tools used to, converting the rendered
+// text to a QString and writing it with a QTextStream, with writing the bytes
+// directly. The PRJ text is read from a file (--input) or made up (--size MB).
+// The direct write runs first: peak memory only goes up, so whatever the Qt
+// write adds on top of the direct write's peak is its extra cost.
+
+#include "PrjWriter.hpp"
+#include "Profiler.hpp"
+
+#include <utilities/core/CommandLine.hpp>
+#include <utilities/core/String.hpp>
+
+#include <boost/chrono.hpp>
+#include <boost/filesystem.hpp>
+
+#include <QFile>
+#include <QString>
+#include <QTextStream>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+void usage( boost::program_options::options_description desc)
+{
+  std::cout << "Usage: prjwritebench [options]" << std::endl;
+  std::cout << desc << std::endl;
+}
+
+// Something shaped like the path section of a big PRJ
+static std::string madeUpPrj(unsigned megabytes)
+{
+  std::string prj;
+  std::size_t size = (std::size_t)megabytes*1048576;
+  prj.reserve(size + 256);
+  char line[256];
+  for(unsigned nr=1;prj.size()<size;nr++)
+  {
+    std::sprintf(line,"%6u   0 %4u %4u %4u %4u  0  0  0  0 %6.3f %8.3f  1  0  0  0  0  0  0  0\n",nr,nr%97+1,
+      nr%389,nr%41,nr%13+1,0.5*(nr%7),1.0+0.01*(nr%1000));
+    prj += line;
+  }
+  return prj;
+}
+
+int main(int argc, char *argv[])
+{
+  std::string inputPathString;
+  std::string outputPathString = "prjwritebench.prj";
+  unsigned megabytes = 30;
+  boost::program_options::options_description desc("Allowed options");
+
+  desc.add_options()
+    ("help,h", "print help message")
+    ("input-path,i", boost::program_options::value<std::string>(&inputPathString), "PRJ file to write copies of")
+    ("output-path,o", boost::program_options::value<std::string>(&outputPathString), "file to write (default: prjwritebench.prj)")
+    ("size,s", boost::program_options::value<unsigned>(&megabytes), "size of the made up PRJ in MB, if no input (default: 30)");
+
+  boost::program_options::variables_map vm;
+  try
+  {
+    boost::program_options::store(boost::program_options::command_line_parser(argc,
+      argv).options(desc).run(), vm);
+    boost::program_options::notify(vm);
+  }
+  catch(std::exception&)
+  {
+    std::cout << "Execution failed: check arguments and retry."<< std::endl << std::endl;
+    usage(desc);
+    return EXIT_FAILURE;
+  }
+
+  if(vm.count("help"))
+  {
+    usage(desc);
+    return EXIT_SUCCESS;
+  }
+
+  std::string prj;
+  if(!inputPathString.empty())
+  {
+    std::ifstream input(inputPathString.c_str(),std::ios::in|std::ios::binary);
+    if(!input.good())
+    {
+      std::cout << "Failed to open '" << inputPathString << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+    std::stringstream buffer;
+    buffer << input.rdbuf();
+    prj = buffer.str();
+  }
+  else
+  {
+    prj = madeUpPrj(megabytes);
+  }
+  double basePeak = contamutils::peakMemory();
+
+  // The new way: the bytes as they are
+  boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  {
+    std::ofstream file(outputPathString.c_str(),std::ios::out|std::ios::binary);
+    if(!contamutils::writePrj(prj,file))
+    {
+      std::cout << "Failed to write '" << outputPathString << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  double directSeconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+  double directPeak = contamutils::peakMemory();
+
+  // The old way: QString copy, then QTextStream encodes it again
+  start = boost::chrono::steady_clock::now();
+  {
+    QFile file(QString::fromStdString(outputPathString));
+    if(!file.open(QFile::WriteOnly))
+    {
+      std::cout << "Failed to write '" << outputPathString << "'" << std::endl;
+      return EXIT_FAILURE;
+    }
+    QTextStream textStream(&file);
+    textStream << openstudio::toQString(prj);
+  }
+  double qtSeconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+  double qtPeak = contamutils::peakMemory();
+  boost::filesystem::remove(outputPathString);
+
+  std::cout << "PRJ size:        " << prj.size()/1048576.0 << " MiB" << std::endl;
+  std::cout << "Direct write:    " << directSeconds << " s, peak +" << directPeak-basePeak << " MiB" << std::endl;
+  std::cout << "QTextStream:     " << qtSeconds << " s, peak +" << qtPeak-basePeak << " MiB" << std::endl;
+  std::cout << "Speedup:         " << qtSeconds/directSeconds << std::endl;
+
+  return EXIT_SUCCESS;
+}
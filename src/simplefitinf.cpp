@@ -17,22 +17,23 @@
  *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  **********************************************************************/
 
-#include <contam/ForwardTranslator.hpp>
-#include <contam/SimFile.hpp>
+#include "AdaptiveSweep.hpp"
+#include "AirflowView.hpp"
+#include "Profiler.hpp"
+#include "SimpleFit.hpp"
+#include "TranslationCache.hpp"
+#include "WindRose.hpp"
+#include "WindSweep.hpp"
+
+#include <airflow/contam/ForwardTranslator.hpp>
 #include <model/Model.hpp>
 #include <model/Space.hpp>
-#include <model/Space_Impl.hpp>
-#include <model/ThermalZone.hpp>
-#include <model/SpaceInfiltrationDesignFlowRate.hpp>
-#include <model/SpaceInfiltrationDesignFlowRate_Impl.hpp>
-#include <model/SpaceInfiltrationEffectiveLeakageArea.hpp>
-#include <model/SpaceInfiltrationEffectiveLeakageArea_Impl.hpp>
-#include <osversion/VersionTranslator.hpp>
 #include <utilities/core/CommandLine.hpp>
 #include <utilities/core/Path.hpp>
 
-#include <QProcess>
+#include <boost/filesystem.hpp>
 
+#include <algorithm>
 #include <map>
 
 void usage( boost::program_options::options_description desc)
@@ -44,26 +45,54 @@ void usage( boost::program_options::options_description desc)
 
 int main(int argc, char *argv[])
 {
+  contamutils::Profiler profiler("simplefitinf");
   std::string inputPathString;
   std::string outputPathString = "simple-fit-infiltration.osm";
   std::string leakageDescriptorString="Average";
+  std::string solverString="contamx";
+  std::string contamxString;
+  std::string simreadxString;
+  std::string configString;
+  std::string profileString;
+  std::string translationCacheString;
+  std::string speedsString = "4.4704,8.9408";
+  std::string stackString = "10,20";
   int ndirs=4;
+  int jobs=0;
+  std::string scratchPathString = "simplefitinf-runs";
   double flow=27.1;
   double returnSupplyRatio=1.0;
   double density = 1.2041;
+  double roseThreshold = 0.02;
+  double adaptiveTolerance = 0.02;
   bool setLevel = true;
   bool verbose = true;
   boost::program_options::options_description desc("Allowed options");
 
   desc.add_options()
+    ("adaptive", "run only as many directions as it takes for the direction averages to converge")
+    ("adaptive-tol", boost::program_options::value<double>(&adaptiveTolerance), "relative tolerance of the adaptive direction sampling (default: 0.02)")
+    ("config", boost::program_options::value<std::string>(&configString), "config file naming the ContamX and SimReadX executables (default: $CONTAM_CONFIG)")
+    ("contamx", boost::program_options::value<std::string>(&contamxString), "ContamX executable (default: $CONTAM_CONTAMX, the config file, or contamx3 on the PATH)")
     ("flow,f", boost::program_options::value<double>(&flow), "leakage flow rate per envelope area [m^3/h/m^2]")
+    ("full-load", "load every object in the OSM, not just the ones the airflow translation needs")
     ("ndirs,n", boost::program_options::value<int>(&ndirs), "number of directions to use (default: 4)")
     ("help,h", "print help message and exit")
     ("input-path,i", boost::program_options::value<std::string>(&inputPathString), "path to input OSM file")
+    ("jobs,j", boost::program_options::value<int>(&jobs), "number of simulations to run at once (default: number of cores)")
     ("level,l", boost::program_options::value<std::string>(&leakageDescriptorString), "airtightness: Leaky|Average|Tight (default: Average)")
     ("output-path,o", boost::program_options::value<std::string>(&outputPathString), "path to output OSM file")
     ("no-osm", "suppress output of OSM file")
-    ("quiet,q", "suppress progress output");
+    ("profile", boost::program_options::value<std::string>(&profileString), "write a JSON report of time and memory use by phase to this file (- for the console)")
+    ("quiet,q", "suppress progress output")
+    ("rose-threshold", boost::program_options::value<double>(&roseThreshold), "share of a wind rose speed bin a direction needs to be simulated, and of all hours a bin needs to be used when there are no --speeds (default: 0.02)")
+    ("scratch-dir,s", boost::program_options::value<std::string>(&scratchPathString), "directory for simulation files (default: simplefitinf-runs)")
+    ("simreadx", boost::program_options::value<std::string>(&simreadxString), "SimReadX executable (default: $CONTAM_SIMREADX, the config file, or simreadx on the PATH)")
+    ("solver", boost::program_options::value<std::string>(&solverString), "airflow solver: builtin|contamx (default: contamx)")
+    ("speeds", boost::program_options::value<std::string>(&speedsString), "comma-separated wind speeds to fit at [m/s] (default: 4.4704,8.9408)")
+    ("stack-dt", boost::program_options::value<std::string>(&stackString), "comma-separated temperature differences of the calm stack cases [K], or none (default: 10,20)")
+    ("translation-cache", boost::program_options::value<std::string>(&translationCacheString), "directory of translated models shared between runs (default: $CONTAM_TRANSLATION_CACHE)")
+    ("wind-rose", "weight the directions by the wind rose of the model's weather file instead of equally");
 
   boost::program_options::positional_options_description pos;
   pos.add("input-path", -1);
@@ -86,10 +115,6 @@ int main(int argc, char *argv[])
     return EXIT_FAILURE;
   }
 
-  // The usual ugly hard coded locations of the executables
-  openstudio::path contamExe = openstudio::toPath("C:\\Program Files (x86)\\NIST\\CONTAM 3.1\\ContamX3.exe");
-  openstudio::path simreadxExe = openstudio::toPath("C:\\Users\\jwd131\\Software\\CONTAM\\simreadx.exe");
-
   if(vm.count("help"))
   {
     usage(desc);
@@ -101,6 +126,19 @@ int main(int argc, char *argv[])
     verbose = false;
   }
 
+  if(!profileString.empty())
+  {
+    profiler.setOutput(profileString);
+    profiler.setInput(inputPathString);
+  }
+
+  contamutils::SimulationRunner runner;
+  if(!runner.configure(contamxString,simreadxString,configString))
+  {
+    std::cout << runner.errorMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+
   if(!vm.count("input-path"))
   {
     std::cout << "No input path given." << std::endl << std::endl;
@@ -114,7 +152,7 @@ int main(int argc, char *argv[])
     setLevel = false;
   }
 
-  if(ndirs < 0)
+  if(ndirs < 1)
   {
     if(verbose)
     {
@@ -123,50 +161,73 @@ int main(int argc, char *argv[])
     ndirs = 4;
   }
 
-  // Open the model
-  openstudio::path inputPath = openstudio::toPath(inputPathString);
-  openstudio::osversion::VersionTranslator vt;
-  boost::optional<openstudio::model::Model> model = vt.loadModel(inputPath);
+  std::vector<double> speeds;
+  if(!contamutils::parseFitValues(speedsString,speeds) || speeds.empty()
+    || *std::min_element(speeds.begin(),speeds.end()) < 0.0)
+  {
+    std::cout << "Bad speed list '" << speedsString << "'" << std::endl;
+    return EXIT_FAILURE;
+  }
 
-  if(!model)
+  std::vector<double> stackDifferences;
+  if(stackString != "none" && !contamutils::parseFitValues(stackString,stackDifferences))
   {
-    std::cout << "Unable to load file '"<< inputPathString << "' as an OpenStudio model." << std::endl;
+    std::cout << "Bad stack temperature difference list '" << stackString << "'" << std::endl;
     return EXIT_FAILURE;
   }
 
-  // Create a vector of the directions we'll need
-  double delta = 360.0/(double)ndirs;
-  QVector<double> direction;
-  if(verbose)
+  if(adaptiveTolerance <= 0.0)
   {
-    std::cout << "Simulation conditions:" << std::endl;
+    std::cout << "Bad adaptive-tol value '" << adaptiveTolerance << "'" << std::endl;
+    return EXIT_FAILURE;
   }
-  for(double angle=0.0;angle<360.0;angle+=delta)
+
+  if(roseThreshold < 0.0 || roseThreshold >= 1.0)
   {
-    direction << angle;
-    if(verbose)
-    {
-      std::cout << "\tDirection: " << angle << std::endl;
-    }
+    std::cout << "Bad rose-threshold value '" << roseThreshold << "'" << std::endl;
+    return EXIT_FAILURE;
   }
 
-  // Now the speeds
-  QVector<double> speed;
-  speed << 4.4704 << 8.9408;
-  if(verbose)
+  if(jobs < 0)
+  {
+    jobs = 0;
+  }
+
+  contamutils::WindSweep::Solver solver = contamutils::WindSweep::ContamX;
+  if(solverString == "builtin")
+  {
+    solver = contamutils::WindSweep::Builtin;
+  }
+  else if(solverString != "contamx")
+  {
+    std::cout << "Unknown solver '" << solverString << "'" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Open the model
+  openstudio::path inputPath = openstudio::toPath(inputPathString);
+  contamutils::ProfilePhase loadPhase(profiler,"osm_load");
+  contamutils::AirflowView view;
+  boost::optional<openstudio::model::Model> model;
+  if(view.load(inputPath,vm.count("full-load") > 0))
+  {
+    model = view.model();
+  }
+  loadPhase.stop();
+
+  if(!model)
   {
-    std::cout << "\tSpeed: " << 4.4704 << std::endl;
-    std::cout << "\tSpeed: " << 8.9408 << std::endl;
+    std::cout << "Unable to load file '"<< inputPathString << "' as an OpenStudio model." << std::endl;
+    return EXIT_FAILURE;
   }
 
   // Create a storage vector
-  QVector<QVector<double> > results;
+  std::vector<std::vector<double> > results;
   // Note we are assuming one space per zone! (maybe relax this later)
   unsigned int nzones = model->getConcreteModelObjects<openstudio::model::Space>().size();
-  results << QVector<double>(nzones,0.0) << QVector<double>(nzones,0.0);
 
   // Translate the model
-  openstudio::contam::ForwardTranslator translator;
+  contamutils::TranslatorSettings settings;
   if(setLevel)
   {
     QVector<std::string> known;
@@ -176,222 +237,202 @@ int main(int argc, char *argv[])
       std::cout << "Unknown airtightness level '" << leakageDescriptorString << "'" << std::endl;
       return EXIT_FAILURE;
     }
-    translator.setAirtightnessLevel(leakageDescriptorString);
+    settings.level = leakageDescriptorString;
   }
   else
   {
-    translator.setExteriorFlowRate(flow,0.65,75.0);
+    settings.setLevel = false;
+    settings.flow = flow;
+  }
+  settings.translateHVAC = false;
+
+  // Use an earlier translation of the same model if there is one, the wind cases are all
+  // steady so there is no CVF to keep
+  boost::optional<contamutils::TranslationCache> translationCache;
+  if(!translationCacheString.empty())
+  {
+    translationCache = contamutils::TranslationCache(openstudio::toPath(translationCacheString));
   }
-  translator.setTranslateHVAC(false);
-  boost::optional<openstudio::contam::IndexModel> cx = translator.translateModel(model.get());
-  if(!cx)
+  else if(boost::optional<openstudio::path> cacheDir = contamutils::TranslationCache::defaultDirectory())
   {
-     std::cout << "Translation failed, check errors and warnings for more information." << std::endl;
-     return EXIT_FAILURE;
+    translationCache = contamutils::TranslationCache(*cacheDir);
   }
-  if(!cx->valid())
+  std::string translationKey;
+  if(translationCache)
   {
-     std::cout << "Translation returned an invalid model, check errors and warnings for more information." << std::endl;
-     return EXIT_FAILURE;
+    translationKey = contamutils::TranslationCache::key(openstudio::toPath(inputPathString),boost::none,settings);
   }
-
-  // Set the model for steady-state simulation
-  cx->rc().setSim_af(0);
-
-  // If we have made it this far, we should be good to go - loop over the cases and run ContamX
-  for(int i=0;i<speed.size();i++)
+  contamutils::ProfilePhase translatePhase(profiler,"translation");
+  contamutils::Translation translation;
+  if(!translationKey.empty() && translationCache->load(translationKey,openstudio::path(),translation))
   {
-    for(int j=0;j<direction.size();j++)
+    if(verbose)
+    {
+      std::cout << "Using cached translation" << std::endl;
+    }
+  }
+  else
+  {
+    std::string error;
+    if(!contamutils::translateModel(*model,settings,openstudio::path(),translation,error))
     {
-      // Set the wind speed and direction
-      cx->ssWeather().setWindspd(speed[i]);
-      cx->ssWeather().setWinddir(direction[j]);
-      QString fileName = QString("temporary-%1-%2.prj").arg(speed[i]).arg(direction[j]);
+      std::cout << error << std::endl;
+      return EXIT_FAILURE;
+    }
+    if(!translationKey.empty() && !translationCache->store(translationKey,translation))
+    {
+      std::cout << "Translation cache failed (" << translationCache->errorMessage() << ")" << std::endl;
+    }
+  }
+  translatePhase.stop();
+  boost::optional<openstudio::contam::IndexModel> cx = translation.model;
 
-      QFile file(fileName);
-      if(!file.open(QFile::WriteOnly))
-      {
-        std::cout << "Failed to open file '"<< fileName.toStdString() << "'." << std::endl;
-        std::cout << "Check that this file location is accessible and may be written." << std::endl;
-        return EXIT_FAILURE;
-      }
-      QTextStream textStream(&file);
-      if(verbose)
-      {
-        std::cout << "Writing file " << fileName.toStdString() << std::endl;
-      }
-      boost::optional<std::string> output = cx->toString();
-      textStream << openstudio::toQString(*output);
-      file.close();
-      //
-      // Run ContamX
-      //
-      QProcess contamProcess;
-      contamProcess.start(openstudio::toQString(contamExe), QStringList() << fileName);
-      if(!contamProcess.waitForStarted(-1))
-      {
-        std::cout << "Failed to start ContamX process." << std::endl;
-        return EXIT_FAILURE;
-      }
-      if(!contamProcess.waitForFinished(-1))
-      {
-        std::cout << "Failed to complete ContamX process." << std::endl;
-        return EXIT_FAILURE;
-      }
-      if(verbose)
-      {
-        std::cout << "Successfully ran ContamX" << std::endl;
-      }
-      //
-      // Run SimRead - this will hopefully go away at some point
-      //
-      QProcess simreadProcess;
-      simreadProcess.start(openstudio::toQString(simreadxExe), QStringList() << "-a" << fileName);
-      if(!simreadProcess.waitForStarted(-1))
-      {
-        std::cout << "Failed to start SimReadX process." << std::endl;
-        return EXIT_FAILURE;
-      }
-      if(!simreadProcess.waitForFinished(-1))
+  // Every direction at each speed (or just the ones the wind rose says matter), then the stack cases
+  double Tambt = cx->ssWeather().Tambt();
+  std::vector<contamutils::SweepCase> cases;
+  if(vm.count("wind-rose"))
+  {
+    boost::optional<openstudio::path> epwPath;
+    if(translation.weatherPath)
+    {
+      if(boost::filesystem::exists(*translation.weatherPath))
       {
-        std::cout << "Failed to complete SimReadX process." << std::endl;
-        return EXIT_FAILURE;
+        epwPath = *translation.weatherPath;
       }
-      if(verbose)
+      else if(boost::filesystem::exists(inputPath.parent_path() / *translation.weatherPath))
       {
-        std::cout << "Successfully ran SimReadX" << std::endl;
+        epwPath = inputPath.parent_path() / *translation.weatherPath;
       }
-      // Get the results
-      openstudio::path simPath = openstudio::toPath(fileName.replace(".prj",".sim"));
-      openstudio::contam::SimFile sim(simPath);
-      // Use the convenience routine to figure out what is what
-      std::vector<openstudio::TimeSeries> infiltration = cx->zoneInfiltration(&sim);
-      if(infiltration.size() != nzones)
+    }
+    if(!epwPath)
+    {
+      std::cout << "Failed to find EPW file, can't make a wind rose" << std::endl;
+      return EXIT_FAILURE;
+    }
+    contamutils::ProfilePhase rosePhase(profiler,"wind_rose");
+    contamutils::WindRose rose;
+    if(!rose.load(*epwPath))
+    {
+      std::cout << rose.errorMessage() << std::endl;
+      return EXIT_FAILURE;
+    }
+    if(!vm.count("speeds"))
+    {
+      speeds = contamutils::windRoseSpeeds(rose,roseThreshold);
+      if(speeds.empty())
       {
-        std::cout << "Failed to complete SimReadX process." << std::endl;
+        std::cout << "No wind speeds in the wind rose above the threshold" << std::endl;
         return EXIT_FAILURE;
       }
-      for(unsigned int k=0;k<infiltration.size();k++)
+    }
+    cases = contamutils::windRoseFitCases(rose,ndirs,speeds,roseThreshold,stackDifferences,Tambt);
+    rosePhase.stop();
+    if(verbose)
+    {
+      std::cout << "Simulating " << cases.size()-stackDifferences.size() << " of " << ndirs*speeds.size()
+        << " wind cases, the rest have too little of the wind rose" << std::endl;
+    }
+  }
+  else
+  {
+    cases = contamutils::simpleFitCases(ndirs,speeds,stackDifferences,Tambt);
+  }
+  if(verbose)
+  {
+    std::cout << "Simulation conditions:" << std::endl;
+    for(unsigned i=0;i<speeds.size();i++)
+    {
+      std::cout << "\tSpeed: " << speeds[i] << std::endl;
+      for(unsigned j=0;j<cases.size();j++)
       {
-        // Check to make sure the values vector has 1 entry
-        if(infiltration[k].values().size() != 1)
+        if(cases[j].row == (int)i)
         {
-          std::cout << "Unexpected time series data." << std::endl;
-          return EXIT_FAILURE;
+          std::cout << "\t\tDirection: " << cases[j].direction << " (weight " << cases[j].weight << ")" << std::endl;
         }
-        results[i][k] += infiltration[k].value(0);
       }
     }
+    for(unsigned i=0;i<stackDifferences.size();i++)
+    {
+      std::cout << "\tStack temperature difference: " << stackDifferences[i] << std::endl;
+    }
   }
 
-  // Average over the various directions
-  for(int i=0;i<speed.size();i++)
+  // If we have made it this far, we should be good to go - run the cases. The direction average
+  // is done by weighting each case as it is accumulated.
+  contamutils::WindSweep sweep(*cx,runner);
+  sweep.setSolver(solver);
+  sweep.setJobs(jobs);
+  sweep.setScratchDirectory(openstudio::toPath(scratchPathString));
+  sweep.setVerbose(verbose);
+  sweep.setProfiler(&profiler);
+  contamutils::ProfilePhase sweepPhase(profiler,"wind_sweep");
+  if(vm.count("adaptive"))
   {
-    for(int j=0;j<results[i].size();j++)
+    contamutils::AdaptiveSweep adaptive(sweep);
+    adaptive.setTolerance(adaptiveTolerance);
+    adaptive.setScratchDirectory(openstudio::toPath(scratchPathString));
+    if(!adaptive.run(cases,nzones,results))
     {
-      results[i][j] /= (double)ndirs;
+      std::cout << adaptive.errorMessage() << std::endl;
+      return EXIT_FAILURE;
     }
-  }
-  if(verbose)
-  {
-    for(int j=0;j<results[0].size();j++)
+    if(verbose)
     {
-      std::cout << j << " " << results[0][j] << " " << results[1][j] << std::endl;
+      std::cout << "Adaptive sampling ran " << adaptive.simulatedCases() << " of " << cases.size()
+        << " cases, saving " << cases.size()-adaptive.simulatedCases() << " simulations" << std::endl;
     }
   }
-  QVector<double> C;
-  QVector<double> D;
-  for(int j=0;j<results[0].size();j++)
+  else if(!sweep.run(cases,nzones,results))
   {
-    // Use Cramer's rule to get the coefficients we want
-    double denom = 4.4704*8.9408*8.9408 - 8.9408*4.4704*4.4704;
-    C << (8.9408*8.9408 - 4.4704*4.4704*results[1][j]/results[0][j])/denom;
-    D << (4.4704*results[1][j]/results[0][j] - 8.9408)/denom;
+    std::cout << sweep.errorMessage() << std::endl;
+    return EXIT_FAILURE;
   }
+  sweepPhase.stop();
   if(verbose)
   {
-    for(int j=0;j<results[0].size();j++)
+    for(unsigned j=0;j<nzones;j++)
     {
-      std::cout << j << " " << C[j] << " " << D[j] << std::endl;
+      std::cout << j;
+      for(unsigned i=0;i<results.size();i++)
+      {
+        std::cout << " " << results[i][j];
+      }
+      std::cout << std::endl;
     }
   }
-
+  contamutils::ProfilePhase fitPhase(profiler,"fit");
+  std::vector<contamutils::DesignFlowRateFit> fits = contamutils::fitDesignFlowRates(cases,results,
+    contamutils::zoneTemperatures(*cx),Tambt);
   if(verbose)
   {
-    for(int j=0;j<results[0].size();j++)
+    for(unsigned j=0;j<fits.size();j++)
     {
-      double calcQ10 = results[0][j]*(C[j]*4.4704 + D[j]*4.4704*4.4704);
-      double calcQ20 = results[0][j]*(C[j]*8.9408 + D[j]*8.9408*8.9408);
-      //std::cout<<openstudio::toString(spaces[i].handle())<<", 10 mph error: "<<results[0][j]-calcQ10<<std::endl;
-      //std::cout<<openstudio::toString(spaces[i].handle())<<", 20 mph error: "<<results[1][j]-calcQ20<<std::endl;
-      std::cout<<j<<", 10 mph error: "<<results[0][j]-calcQ10<<std::endl;
-      std::cout<<j<<", 20 mph error: "<<results[1][j]-calcQ20<<std::endl;
+      std::cout << j << " " << fits[j].B << " " << fits[j].C << " " << fits[j].D << std::endl;
     }
-  }
-
-  // Remove previous infiltration objects
-  std::vector<openstudio::model::SpaceInfiltrationDesignFlowRate> dfrInf = model->getConcreteModelObjects<openstudio::model::SpaceInfiltrationDesignFlowRate>();
-  BOOST_FOREACH(openstudio::model::SpaceInfiltrationDesignFlowRate inf, dfrInf)
-  {
-    inf.remove();
-  }
-  std::vector<openstudio::model::SpaceInfiltrationEffectiveLeakageArea> elaInf = model->getConcreteModelObjects<openstudio::model::SpaceInfiltrationEffectiveLeakageArea>();
-  BOOST_FOREACH(openstudio::model::SpaceInfiltrationEffectiveLeakageArea inf, elaInf)
-  {
-    inf.remove();
-  }
-
-  // Build a map to the index - this will need to be changed significantly if we want more than one
-  // space per zone.
-  std::map <openstudio::Handle, int> zoneMap = translator.zoneMap();
-  std::vector<openstudio::model::Space> spaces = model->getConcreteModelObjects<openstudio::model::Space>();
-  std::map<openstudio::Handle,int> spaceMap;
-  BOOST_FOREACH(openstudio::model::Space space, spaces)
-  {
-    boost::optional<openstudio::model::ThermalZone> thermalZone = space.thermalZone();
-    if(!thermalZone)
+    for(unsigned j=0;j<fits.size();j++)
     {
-      std::cout << "Warning: Unattached space '" << openstudio::toString(space.handle()) << "'" << std::endl;
-    }
-    else
-    {
-      if(zoneMap.count(thermalZone->handle()) > 0)
-      {
-        spaceMap[space.handle()] = zoneMap[thermalZone->handle()];
-      }
-      else
+      std::cout << j << ", RMS error: " << fits[j].residual;
+      if(fits[j].flow > 0.0)
       {
-        std::cout << "Warning: lookup failed for zone '" << openstudio::toString(thermalZone->handle()) << "'" << std::endl;
+        std::cout << " (" << 100.0*fits[j].residual/fits[j].flow << "% of the design flow)";
       }
+      std::cout << std::endl;
     }
   }
 
-  // Generate infiltration objects and attach to spaces
-  std::pair <openstudio::Handle,int> handleInt;
-  BOOST_FOREACH(handleInt, spaceMap)
+  // Replace the infiltration objects with the fitted ones
+  if(!contamutils::setDesignFlowRates(*model,translation.zoneMap,fits,density,std::cout))
   {
-    //std::cout << openstudio::toString(handleInt.first) << " " << handleInt.second << std::endl;
-    boost::optional<openstudio::model::Space> space = model->getModelObject<openstudio::model::Space>(handleInt.first);
-    if(!space)
-    {
-      std::cout << "Failed to find space " << openstudio::toString(handleInt.first)<< std::endl;
-      return EXIT_FAILURE;
-    }
-    int index = handleInt.second-1;
-    openstudio::model::SpaceInfiltrationDesignFlowRate infObj(*model);
-    infObj.setDesignFlowRate(density*results[0][index]);
-    infObj.setConstantTermCoefficient(0.0);
-    infObj.setTemperatureTermCoefficient(0.0);
-    infObj.setVelocityTermCoefficient(C[index]);
-    infObj.setVelocitySquaredTermCoefficient(D[index]);
-    infObj.setSpace(*space);
+    return EXIT_FAILURE;
   }
+  fitPhase.stop();
 
   // Write out new OSM
   if(!vm.count("no-osm"))
   {
+    contamutils::ProfilePhase savePhase(profiler,"osm_save");
     openstudio::path outPath = openstudio::toPath(outputPathString);
-    if(!model->save(outPath,true))
+    if(!view.save(outPath))
     {
       std::cout << "Failed to write OSM file." << std::endl;
       return EXIT_FAILURE;
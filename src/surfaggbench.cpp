@@ -0,0 +1,183 @@
+/**********************************************************************
+ *  Copyright (c) 2013, The Pennsylvania State University.
+ *  All rights reserved.
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ **********************************************************************/
+
+// Compare the surface to space summation that surfinf used to do, adding one
+// TimeSeries per surface, with summing into a preallocated space by time
+// matrix. Allocations are counted by replacing the global operator new.
+
+#include "FlowConversion.hpp"
+#include "ScheduleGrid.hpp"
+
+#include <utilities/core/CommandLine.hpp>
+#include <utilities/data/TimeSeries.hpp>
+#include <utilities/data/Vector.hpp>
+#include <utilities/time/Date.hpp>
+#include <utilities/time/DateTime.hpp>
+#include <utilities/time/Time.hpp>
+
+#include <boost/chrono.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+static unsigned long long allocations = 0;
+static unsigned long long allocatedBytes = 0;
+
+void *operator new(std::size_t size)
+{
+  allocations++;
+  allocatedBytes += size;
+  void *ptr = std::malloc(size ? size : 1);
+  if(!ptr)
+  {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void *ptr) throw()
+{
+  std::free(ptr);
+}
+
+void usage( boost::program_options::options_description desc)
+{
+  std::cout << "Usage: surfaggbench [options]" << std::endl;
+  std::cout << desc << std::endl;
+}
+
+static void report(const std::string &label, double seconds, unsigned long long count, unsigned long long bytes)
+{
+  std::cout << label << seconds << " s, " << count << " allocations, " << bytes/1048576.0 << " MiB allocated" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned surfaces = 2000;
+  unsigned spaces = 100;
+  unsigned hours = 8760;
+  boost::program_options::options_description desc("Allowed options");
+
+  desc.add_options()
+    ("help,h", "print help message")
+    ("hours,t", boost::program_options::value<unsigned>(&hours), "number of hourly values (default: 8760)")
+    ("spaces,n", boost::program_options::value<unsigned>(&spaces), "number of spaces (default: 100)")
+    ("surfaces,s", boost::program_options::value<unsigned>(&surfaces), "number of exterior surfaces (default: 2000)");
+
+  boost::program_options::variables_map vm;
+  try
+  {
+    boost::program_options::store(boost::program_options::command_line_parser(argc,
+      argv).options(desc).run(), vm);
+    boost::program_options::notify(vm);
+  }
+  catch(std::exception&)
+  {
+    std::cout << "Execution failed: check arguments and retry."<< std::endl << std::endl;
+    usage(desc);
+    return EXIT_FAILURE;
+  }
+
+  if(vm.count("help"))
+  {
+    usage(desc);
+    return EXIT_SUCCESS;
+  }
+
+  if(!surfaces || !spaces || !hours)
+  {
+    usage(desc);
+    return EXIT_FAILURE;
+  }
+
+  openstudio::Date startDate(openstudio::MonthOfYear::Jan,1);
+  openstudio::DateTime startDateTime(startDate);
+  openstudio::Time delta(0,1);
+  std::vector<openstudio::TimeSeries> infiltration;
+  std::vector<int> surfaceSpace(surfaces);
+  for(unsigned i=0;i<surfaces;i++)
+  {
+    std::vector<double> values(hours);
+    for(unsigned k=0;k<hours;k++)
+    {
+      values[k] = 0.001*(i%11+1)*(1.0 + 0.5*std::sin(0.2618*k));
+    }
+    infiltration.push_back(openstudio::TimeSeries(startDate,delta,openstudio::createVector(values),"kg/s"));
+    surfaceSpace[i] = i%spaces;
+  }
+
+  // The old way: one TimeSeries per space and a TimeSeries sum per surface
+  unsigned long long count = allocations;
+  unsigned long long bytes = allocatedBytes;
+  boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+  std::vector<openstudio::TimeSeries> ts;
+  for(unsigned i=0;i<spaces;i++)
+  {
+    ts.push_back(openstudio::TimeSeries(startDate,delta,openstudio::Vector(hours,0.0),"kg/s"));
+  }
+  for(unsigned i=0;i<surfaces;i++)
+  {
+    ts[surfaceSpace[i]] = ts[surfaceSpace[i]] + infiltration[i];
+  }
+  double oldSeconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+  unsigned long long oldCount = allocations - count;
+  unsigned long long oldBytes = allocatedBytes - bytes;
+
+  // The new way: sample into one scratch row and add it into the matrix. What allocations are
+  // left are the copies that TimeSeries makes when handing out its times and values.
+  count = allocations;
+  bytes = allocatedBytes;
+  start = boost::chrono::steady_clock::now();
+  double step = delta.totalDays();
+  std::size_t steps = hours;
+  std::vector<double> spaceFlow(spaces*steps,0.0);
+  std::vector<double> surfaceFlow(steps);
+  for(unsigned i=0;i<surfaces;i++)
+  {
+    contamutils::sampleOntoGrid(infiltration[i],startDateTime,step,steps,&surfaceFlow[0]);
+    contamutils::accumulateRows(&surfaceFlow[0],1,steps,&surfaceSpace[i],spaces,&spaceFlow[0]);
+  }
+  double newSeconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+  unsigned long long newCount = allocations - count;
+  unsigned long long newBytes = allocatedBytes - bytes;
+
+  double maxDifference = 0.0;
+  for(unsigned i=0;i<spaces;i++)
+  {
+    openstudio::DateTime current = startDateTime;
+    for(std::size_t k=0;k<steps;k++)
+    {
+      current += delta;
+      maxDifference = std::max(maxDifference,std::abs(ts[i].value(current)-spaceFlow[i*steps+k]));
+    }
+  }
+
+  std::cout << "Surfaces, spaces, steps: " << surfaces << ", " << spaces << ", " << steps << std::endl;
+  report("TimeSeries sums: ",oldSeconds,oldCount,oldBytes);
+  report("Matrix sums:     ",newSeconds,newCount,newBytes);
+  std::cout << "Speedup:         " << oldSeconds/newSeconds << std::endl;
+  std::cout << "Max difference:  " << maxDifference << " kg/s" << std::endl;
+
+  return EXIT_SUCCESS;
+}
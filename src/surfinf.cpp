@@ -18,8 +18,18 @@
  *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
  **********************************************************************/
 
-#include <contam/ForwardTranslator.hpp>
-#include <contam/SimFile.hpp>
+#include "AirflowView.hpp"
+#include "ContamResults.hpp"
+#include "FileLocator.hpp"
+#include "FlowConversion.hpp"
+#include "InfiltrationFile.hpp"
+#include "PrjWriter.hpp"
+#include "Profiler.hpp"
+#include "ScheduleGrid.hpp"
+#include "SimulationRunner.hpp"
+#include "TranslationCache.hpp"
+
+#include <airflow/contam/ForwardTranslator.hpp>
 
 #include <model/Model.hpp>
 #include <model/Space.hpp>
@@ -29,10 +39,10 @@
 #include <model/ThermalZone.hpp>
 #include <model/WeatherFile.hpp>
 #include <model/ScheduleFixedInterval.hpp>
-#include <osversion/VersionTranslator.hpp>
 
 #include <utilities/core/CommandLine.hpp>
 #include <utilities/core/Path.hpp>
+#include <utilities/data/Vector.hpp>
 #include <utilities/sql/SqlFile.hpp>
 
 #include <model/SpaceInfiltrationDesignFlowRate.hpp>
@@ -44,8 +54,8 @@
 //#include <utilities/idf/Workspace.hpp>
 //#include <utilities/idf/IdfFile.hpp>
 
-#include <QProcess>
-
+#include <algorithm>
+#include <fstream>
 #include <string>
 #include <iostream>
 
@@ -116,54 +126,43 @@ boost::optional<openstudio::EpwFile> translateEpw(openstudio::path epwpath, open
   return epw;
 }
 
-static boost::optional<openstudio::path> findFile(openstudio::path base, std::string filename, bool verbose=false)
-{
-  if(boost::filesystem::is_directory(base))
-  {
-    openstudio::path filepath = base / openstudio::toPath(filename);
-    if(verbose)
-    {
-      std::cout<<"Looking for "<<openstudio::toString(filepath)<<std::endl;
-    }
-    if(boost::filesystem::exists(filepath))
-    {
-      return boost::optional<openstudio::path>(filepath);
-    }
-    // WHY!?!?!
-    boost::filesystem2::path basepath(openstudio::toString(base));
-    boost::filesystem::directory_iterator iter(basepath);
-    boost::filesystem::directory_iterator end;
-    for(;iter!=end;++iter)
-    {
-      boost::optional<openstudio::path> optional = findFile(openstudio::toPath(iter->path().string()),filename,verbose);
-      if(optional)
-      {
-        return optional;
-      }
-    }
-  }
-  return false;
-}
-
 int main(int argc, char *argv[])
 {
+  contamutils::Profiler profiler("surfinf");
   std::string inputPathString;
   std::string outputPathString = "surface-infiltration.osm";
   std::string leakageDescriptorString="Average";
+  std::string translationCacheString;
+  std::string contamxString;
+  std::string simreadxString;
+  std::string configString;
+  std::string profileString;
+  int searchDepth=-1;
+  int timestep=60;
   double flow=27.1;
   double returnSupplyRatio=1.0;
   bool setLevel = true;
   bool writeCsv = false;
+  bool writeBinary = false;
   bool verbose = true;
   boost::program_options::options_description desc("Allowed options");
 
   desc.add_options()
+    ("binary,b", "write out a memory-mappable binary results file")
+    ("config", boost::program_options::value<std::string>(&configString), "config file naming the ContamX and SimReadX executables (default: $CONTAM_CONFIG)")
+    ("contamx", boost::program_options::value<std::string>(&contamxString), "ContamX executable (default: $CONTAM_CONTAMX, the config file, or contamx3 on the PATH)")
     ("csv,c", "write out descriptive csv files")
     ("flow,f", boost::program_options::value<double>(&flow), "leakage flow rate per envelope area [m^3/h/m^2]")
+    ("full-load", "load every object in the OSM, not just the ones the airflow translation needs")
     ("help,h", "print help message and exit")
     ("input-path,i", boost::program_options::value<std::string>(&inputPathString), "path to input OSM file")
     ("level,l", boost::program_options::value<std::string>(&leakageDescriptorString), "airtightness: Leaky|Average|Tight (default: Average)")
-    ("quiet,q", "suppress progress output");
+    ("profile", boost::program_options::value<std::string>(&profileString), "write a JSON report of time and memory use by phase to this file (- for the console)")
+    ("quiet,q", "suppress progress output")
+    ("search-depth,d", boost::program_options::value<int>(&searchDepth), "how many directory levels to search for results and weather files (default: no limit)")
+    ("simreadx", boost::program_options::value<std::string>(&simreadxString), "SimReadX executable (default: $CONTAM_SIMREADX, the config file, or simreadx on the PATH)")
+    ("timestep,t", boost::program_options::value<int>(&timestep), "schedule timestep in minutes, must divide an hour (default: 60, 0: use the CONTAM output interval)")
+    ("translation-cache", boost::program_options::value<std::string>(&translationCacheString), "directory of translated models shared between runs (default: $CONTAM_TRANSLATION_CACHE)");
 
   boost::program_options::positional_options_description pos;
   pos.add("input-path", -1);
@@ -210,6 +209,24 @@ int main(int argc, char *argv[])
     writeCsv = true;
   }
 
+  if(vm.count("binary"))
+  {
+    writeBinary = true;
+  }
+
+  if(!profileString.empty())
+  {
+    profiler.setOutput(profileString);
+    profiler.setInput(inputPathString);
+  }
+
+  contamutils::SimulationRunner runner;
+  if(!runner.configure(contamxString,simreadxString,configString))
+  {
+    std::cout << runner.errorMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+
   if(vm.count("quiet"))
   {
     verbose = false;
@@ -217,8 +234,14 @@ int main(int argc, char *argv[])
   
   // Open the model
   openstudio::path inputPath = openstudio::toPath(inputPathString);
-  openstudio::osversion::VersionTranslator vt;
-  boost::optional<openstudio::model::Model> model = vt.loadModel(inputPath);
+  contamutils::ProfilePhase loadPhase(profiler,"osm_load");
+  contamutils::AirflowView view;
+  boost::optional<openstudio::model::Model> model;
+  if(view.load(inputPath,vm.count("full-load") > 0))
+  {
+    model = view.model();
+  }
+  loadPhase.stop();
 
   if(!model)
   {
@@ -229,7 +252,10 @@ int main(int argc, char *argv[])
   // Try to find and connect a results file - this really should be done using the RunManager database,
   // but I don't know how to do that and it can be done right at a later date by someone who knows how
   openstudio::path dir = inputPath.parent_path() / inputPath.stem();
-  boost::optional<openstudio::path> sqlpath = findFile(dir,"eplusout.sql",verbose);
+  contamutils::FileLocator locator(dir,searchDepth);
+  locator.addPreferredDirectory("run");
+  locator.setVerbose(verbose);
+  boost::optional<openstudio::path> sqlpath = locator.find("eplusout.sql");
   if(sqlpath)
   {
     if(verbose)
@@ -242,7 +268,7 @@ int main(int argc, char *argv[])
   openstudio::path prjPath = inputPath.replace_extension(openstudio::toPath("prj").string());
   openstudio::path cvfPath = inputPath.replace_extension(openstudio::toPath("cvf").string());
   openstudio::path wthPath = inputPath.replace_extension(openstudio::toPath("wth").string());
-  openstudio::path simPath = inputPath.replace_extension(openstudio::toPath("sim").string());
+  openstudio::path lfrPath = inputPath.replace_extension(openstudio::toPath("lfr").string());
 
   bool needWth = true;
   if(boost::filesystem::exists(wthPath))
@@ -250,7 +276,7 @@ int main(int argc, char *argv[])
     needWth = false;
   }
 
-  openstudio::contam::ForwardTranslator translator;
+  contamutils::TranslatorSettings settings;
   if(setLevel)
   {
     QVector<std::string> known;
@@ -260,44 +286,81 @@ int main(int argc, char *argv[])
       std::cout << "Unknown airtightness level '" << leakageDescriptorString << "'" << std::endl;
       return EXIT_FAILURE;
     }
-    translator.setAirtightnessLevel(leakageDescriptorString);
+    settings.level = leakageDescriptorString;
   }
   else
   {
-    translator.setExteriorFlowRate(flow,0.65,75.0);
+    settings.setLevel = false;
+    settings.flow = flow;
+  }
+  settings.translateHVAC = false;
+
+  // Use an earlier translation of the same model if there is one
+  boost::optional<contamutils::TranslationCache> translationCache;
+  if(!translationCacheString.empty())
+  {
+    translationCache = contamutils::TranslationCache(openstudio::toPath(translationCacheString));
   }
-  translator.setTranslateHVAC(false);
-  boost::optional<openstudio::contam::IndexModel> cx = translator.translateModel(model.get());
-  if(!cx)
+  else if(boost::optional<openstudio::path> cacheDir = contamutils::TranslationCache::defaultDirectory())
   {
-     std::cout << "Translation failed, check errors and warnings for more information." << std::endl;
-     return EXIT_FAILURE;
+    translationCache = contamutils::TranslationCache(*cacheDir);
   }
-  if(!cx->valid())
+  std::string translationKey;
+  if(translationCache)
   {
-     std::cout << "Translation returned an invalid model, check errors and warnings for more information." << std::endl;
-     return EXIT_FAILURE;
+    translationKey = contamutils::TranslationCache::key(openstudio::toPath(inputPathString),sqlpath,settings);
+  }
+  contamutils::ProfilePhase translatePhase(profiler,"translation");
+  contamutils::Translation translation;
+  if(!translationKey.empty() && translationCache->load(translationKey,cvfPath,translation))
+  {
+    if(verbose)
+    {
+      std::cout << "Using cached translation" << std::endl;
+    }
+  }
+  else
+  {
+    std::string error;
+    if(!contamutils::translateModel(*model,settings,cvfPath,translation,error))
+    {
+      std::cout << error << std::endl;
+      return EXIT_FAILURE;
+    }
+    if(!translationKey.empty() && !translationCache->store(translationKey,translation))
+    {
+      std::cout << "Translation cache failed (" << translationCache->errorMessage() << ")" << std::endl;
+    }
   }
+  translatePhase.stop();
+  boost::optional<openstudio::contam::IndexModel> cx = translation.model;
   
   // Since we really need this to be a transient case, bail out now if it is not
-  if(!translator.startDateTime() || !translator.endDateTime())
+  if(!translation.startDateTime || !translation.endDateTime)
   {
     std::cout << "The translated model is a steady-state model, bailing out" << std::endl;
     return EXIT_FAILURE;
   }
+  // Have ContamX report at the schedule timestep
+  int timestepSeconds = contamutils::setOutputTimestep(*cx,60*timestep);
+  if(timestepSeconds < 0)
+  {
+    std::cout << "The schedule timestep must divide an hour into whole minutes" << std::endl;
+    return EXIT_FAILURE;
+  }
   boost::optional<openstudio::EpwFile> epwFile;
-  QFile file(openstudio::toQString(prjPath));
-  if(file.open(QFile::WriteOnly))
+  std::ofstream file(openstudio::toString(prjPath).c_str(),std::ios::out|std::ios::binary);
+  if(file.good())
   {
-    QTextStream textStream(&file);
     // Attempt to translate weather
+    contamutils::ProfilePhase weatherPhase(profiler,"epw_to_wth");
     boost::optional<openstudio::model::WeatherFile> weatherFile = model->weatherFile();
     if(weatherFile)
     {
       boost::optional<openstudio::path> path = weatherFile->path();
       if(path)
       {
-        boost::optional<openstudio::path> epwPath = findFile(dir,openstudio::toString(path->string()),verbose);
+        boost::optional<openstudio::path> epwPath = locator.find(openstudio::toString(path->string()));
         if(epwPath)
         {
           if(!needWth)
@@ -335,14 +398,21 @@ int main(int argc, char *argv[])
     {
       std::cout << "No weather file object to process, WTH file will not be written" << std::endl;
     }
+    weatherPhase.stop();
 
-    // Write out a CVF if needed
-    if(translator.writeCvFile(cvfPath))
+    // Use the CVF if the translation wrote one
+    if(translation.cvfPath)
     {
       // Need to set the CVF file in the PRJ, this path may need to be made relative. Not too sure
       cx->setCVFpath(openstudio::toString(cvfPath));
     }
-    textStream << openstudio::toQString(cx->toString());
+    contamutils::ProfilePhase writePhase(profiler,"prj_write");
+    if(!contamutils::writePrj(*cx,file))
+    {
+      std::cout << "Failed to write file '" << openstudio::toString(prjPath) << "'." << std::endl;
+      return EXIT_FAILURE;
+    }
+    file.close();
   }
   else
   {
@@ -350,7 +420,6 @@ int main(int argc, char *argv[])
     std::cout << "Check that this file location is accessible and may be written." << std::endl;
     return EXIT_FAILURE;
   }
-  file.close();
 
   // Now we should have a CONTAM model file. There will need to be some steps taken if parts of the 
   // process have not been successful (e.g. the creation of a WTH file), but for now just assume that
@@ -362,51 +431,18 @@ int main(int argc, char *argv[])
   {
     std::cout << "Running CONTAM simulation" << std::endl;
   }
-  // Ugly hard code
-  openstudio::path contamExe = openstudio::toPath("C:\\Program Files (x86)\\NIST\\CONTAM 3.1\\ContamX3.exe");
-  openstudio::path simreadxExe = openstudio::toPath("C:\\Users\\jwd131\\Software\\CONTAM\\simreadx.exe");
-  //
-  // Run CONTAM
-  //
-  QProcess contamProcess;
-  contamProcess.start(openstudio::toQString(contamExe), QStringList() << openstudio::toQString(prjPath));
-  if(!contamProcess.waitForStarted(-1))
-  {
-    std::cout << "Failed to start ContamX process." << std::endl;
-    return EXIT_FAILURE;
-  }
-  if(!contamProcess.waitForFinished(-1))
+  std::string runError;
+  contamutils::ProfilePhase contamxPhase(profiler,"contamx");
+  if(!runner.runContamX(prjPath,runError))
   {
-    std::cout << "Failed to complete ContamX process." << std::endl;
+    std::cout << runError << std::endl;
     return EXIT_FAILURE;
   }
+  contamxPhase.stop();
   if(verbose)
   {
     std::cout << "Successfully ran ContamX" << std::endl;
   }
-  //
-  // Run SimRead - this will hopefully go away at some point
-  //
-  QProcess simreadProcess;
-  simreadProcess.start(openstudio::toQString(simreadxExe), QStringList() << "-a" << openstudio::toQString(prjPath));
-  if(!simreadProcess.waitForStarted(-1))
-  {
-    std::cout << "Failed to start SimReadX process." << std::endl;
-    return EXIT_FAILURE;
-  }
-  if(!simreadProcess.waitForFinished(-1))
-  {
-    std::cout << "Failed to complete SimReadX process." << std::endl;
-    return EXIT_FAILURE;
-  }
-  if(verbose)
-  {
-    std::cout << "Successfully ran SimReadX" << std::endl;
-  }
-  //
-  // Read in the results
-  //
-  openstudio::contam::SimFile sim(simPath);
   // Remove previous infiltration objects
   std::vector<openstudio::model::SpaceInfiltrationDesignFlowRate> dfrInf = model->getConcreteModelObjects<openstudio::model::SpaceInfiltrationDesignFlowRate>();
   BOOST_FOREACH(openstudio::model::SpaceInfiltrationDesignFlowRate inf, dfrInf)
@@ -419,10 +455,8 @@ int main(int argc, char *argv[])
     inf.remove();
   }
   // Set the default here in case the EpwFile route fails
-  openstudio::Time diff = translator.endDateTime().get()-translator.startDateTime().get();
-  //std::cout << diff.days()*24 << std::endl;
-  double ssP = cx->ssWeather().Tambt();
-  double ssT = cx->ssWeather().barpres(); // There's a better way to do this
+  double ssP = cx->ssWeather().barpres();
+  double ssT = cx->ssWeather().Tambt(); // There's a better way to do this
   // Try to get the outdoor conditions
   openstudio::TimeSeries seriesP;
   openstudio::TimeSeries seriesT;
@@ -446,7 +480,7 @@ int main(int argc, char *argv[])
   }
   // Create the vector of path numbers
   std::vector<int> pathNrs;
-  std::map<openstudio::Handle,int> map = translator.surfaceMap();
+  std::map<openstudio::Handle,int> map = translation.surfaceMap;
   BOOST_FOREACH(openstudio::model::Surface surface, extSurfaces)
   {
     std::map<openstudio::Handle,int>::const_iterator iter = map.find(surface.handle());
@@ -466,31 +500,72 @@ int main(int argc, char *argv[])
     return EXIT_FAILURE;
   }
 
-  std::vector<openstudio::TimeSeries> infiltration = cx->pathInfiltration(pathNrs,&sim); // These are in kg/s
+  // Read in the results for all of the exterior paths into one matrix
+  // Get the results as text from SimReadX
+  contamutils::ProfilePhase simreadxPhase(profiler,"simreadx");
+  if(!runner.runSimReadX(prjPath,runError))
+  {
+    std::cout << runError << std::endl;
+    return EXIT_FAILURE;
+  }
+  simreadxPhase.stop();
+  if(verbose)
+  {
+    std::cout << "Successfully ran SimReadX" << std::endl;
+  }
+  contamutils::PathFlowMatrix pathFlows;
+  contamutils::ProfilePhase parsePhase(profiler,"sim_parse");
+  if(!contamutils::readPathInfiltration(*cx,lfrPath,pathNrs,pathFlows)) // These are in kg/s
+  {
+    std::cout << pathFlows.errorMessage() << std::endl;
+    return EXIT_FAILURE;
+  }
+  parsePhase.stop();
+
+  // Put the outdoor conditions onto the schedule grid once
+  contamutils::ProfilePhase schedulePhase(profiler,"schedule_build");
+  openstudio::Time delta(0,0,0,timestepSeconds);
+  openstudio::DateTime startDateTime = translation.startDateTime.get();
+  double step = delta.totalDays();
+  std::size_t steps = contamutils::gridSteps(startDateTime,translation.endDateTime.get(),delta);
+  std::vector<double> P(steps,ssP);
+  std::vector<double> T(steps,ssT);
+  if(variableWeather && steps)
+  {
+    contamutils::sampleOntoGrid(seriesP,startDateTime,step,steps,&P[0]);
+    contamutils::sampleOntoGrid(seriesT,startDateTime,step,steps,&T[0]);
+    for(std::size_t k=0;k<steps;k++)
+    {
+      T[k] += 273.15;
+    }
+  }
+  std::vector<double> factor(steps);
+  if(steps)
+  {
+    contamutils::volumeFlowFactors(&P[0],&T[0],steps,&factor[0]);
+  }
 
-  // This is probably a mistake, but make an infiltration vector for each space
-  openstudio::Time delta(0,1); // Do an hourly schedule
-  std::vector<openstudio::TimeSeries> ts;
+  // Sum the surface flows into a single space by time matrix. Each surface is sampled into the
+  // same scratch row and added into its space's row in place.
   std::map<openstudio::Handle,int> spaceMap;
   std::vector<openstudio::model::Space> spaces = model->getConcreteModelObjects<openstudio::model::Space>();
-  int i=0;
-  BOOST_FOREACH(openstudio::model::Space space, spaces)
+  for(unsigned i=0;i<spaces.size();i++)
   {
-    ts.push_back(openstudio::TimeSeries(translator.startDateTime().get().date(),delta,
-      openstudio::createVector(std::vector<double>(8760,0.0)),"kg/s"));
-    spaceMap[space.handle()] = i;
-    i++;
+    spaceMap[spaces[i].handle()] = i;
   }
-
-  // The next part should work, provided that TimeSeries objects act like I think they should
-  // Step through the list of exterior surfaces and add in infiltration into each space
+  std::vector<int> surfaceSpace(extSurfaces.size());
   for(unsigned i=0;i<extSurfaces.size();i++)
   {
-    openstudio::model::Surface surface = extSurfaces[i];
-    boost::optional<openstudio::model::Space> space = surface.space();
     // Not going to do a check here - it should have a space if it made it through the filter
-    int spaceIndex = spaceMap[space.get().handle()];
-    ts[spaceIndex] = ts[spaceIndex] + infiltration[i];
+    surfaceSpace[i] = spaceMap[extSurfaces[i].space().get().handle()];
+  }
+  std::vector<double> spaceFlow(spaces.size()*steps,0.0);
+  if(steps)
+  {
+    contamutils::accumulateOntoGrid(pathFlows,surfaceSpace.empty() ? 0 : &surfaceSpace[0],spaces.size(),startDateTime,step,steps,
+      &spaceFlow[0]);
+    // Convert to m^3/s
+    contamutils::massToVolumeFlow(&spaceFlow[0],spaces.size(),steps,&factor[0],&spaceFlow[0]);
   }
 
   if(writeCsv)
@@ -499,25 +574,19 @@ int main(int argc, char *argv[])
     csv.open("surface-infiltration.csv",std::ofstream::out);
     if(csv.good())
     {
-      for(unsigned i=0;i<ts.size();i++)
+      for(unsigned i=0;i<spaces.size();i++)
       {
         csv << "," << spaces[i].name().get();
       }
       csv << std::endl;
-      for(openstudio::DateTime current=translator.startDateTime().get()+delta; current <= translator.endDateTime().get(); current += delta)
+      openstudio::DateTime current = startDateTime;
+      for(std::size_t k=0;k<steps;k++)
       {
-        double P = ssP;
-        double T = ssT;
-        if(variableWeather)
-        {
-          P = seriesP.value(current);
-          T = seriesT.value(current) + 273.15;
-        }
+        current += delta;
         csv << current.toString();
-        for(unsigned i=0;i<ts.size();i++)
+        for(unsigned i=0;i<spaces.size();i++)
         {
-          double inf = ts[i].value(current); // This will be in kg/s
-          csv << "," << inf*287.058*T/P; // Convert to m^3/s
+          csv << "," << spaceFlow[i*steps+k];
         }
         csv << std::endl;
       }
@@ -525,46 +594,51 @@ int main(int argc, char *argv[])
     }
   }
 
-  // Loop through the spaces and create schedules
-  BOOST_FOREACH(openstudio::model::Space space, spaces)
+  // The binary file is written a space at a time as the schedules are made
+  openstudio::DateTime first = startDateTime + delta;
+  contamutils::InfiltrationFileWriter binary(contamutils::InfiltrationStart(first.date().year(),
+    first.date().monthOfYear().value(),first.date().dayOfMonth(),first.time().hours(),first.time().minutes(),
+    first.time().seconds()),delta.totalSeconds());
+  if(writeBinary && !binary.open("surface-infiltration.cxinf"))
   {
-    std::map<openstudio::Handle,int>::const_iterator iter = spaceMap.find(space.handle());
-    if(iter != spaceMap.end())
-    {
-      // Do hourly values, but we won't assume 8760
-      std::vector<double> values;
-      for(openstudio::DateTime current=translator.startDateTime().get()+delta; current <= translator.endDateTime().get(); current += delta)
-      {
-        double inf = ts[iter->second].value(current); // This will be in kg/s
-        double P = ssP;
-        double T = ssT;
-        if(variableWeather)
-        {
-          P = seriesP.value(current);
-          T = seriesT.value(current) + 273.15;
-        }
-        values.push_back(inf*287.058*T/P); // Compute m^3/s.
-      }
+    std::cout << binary.errorMessage() << std::endl;
+  }
 
-      // Make a schedule
-      openstudio::model::ScheduleFixedInterval schedule(*model);
-      if(!schedule.setTimeSeries(openstudio::TimeSeries(translator.startDateTime()->date(),delta,openstudio::createVector(values),"")))
-      {
-        std::cout << "Failed to set time series for schedule." << std::endl;
-        continue;
-      }
-      // Make an infiltration object and attach it to the space
-      openstudio::model::SpaceInfiltrationDesignFlowRate infObj(*model);
-      infObj.setDesignFlowRate(1.0);
-      infObj.setConstantTermCoefficient(1.0);
-      infObj.setSpace(space);
-      infObj.setSchedule(schedule);
+  // Loop through the spaces and create schedules, all in one buffer
+  openstudio::Vector values(steps);
+  for(unsigned i=0;i<spaces.size();i++)
+  {
+    std::copy(spaceFlow.begin()+i*steps,spaceFlow.begin()+(i+1)*steps,values.begin());
+    if(binary.isOpen() && steps)
+    {
+      binary.addColumn(spaces[i].name().get(),&spaceFlow[i*steps],steps);
     }
+    // Make a schedule
+    openstudio::model::ScheduleFixedInterval schedule(*model);
+    if(!schedule.setTimeSeries(openstudio::TimeSeries(translation.startDateTime->date(),delta,values,"")))
+    {
+      std::cout << "Failed to set time series for schedule." << std::endl;
+      continue;
+    }
+    // Make an infiltration object and attach it to the space
+    openstudio::model::SpaceInfiltrationDesignFlowRate infObj(*model);
+    infObj.setDesignFlowRate(1.0);
+    infObj.setConstantTermCoefficient(1.0);
+    infObj.setSpace(spaces[i]);
+    infObj.setSchedule(schedule);
+  }
+
+  if(binary.isOpen() && !binary.close())
+  {
+    std::cout << binary.errorMessage() << std::endl;
   }
 
+  schedulePhase.stop();
+
   // Write out the model
+  contamutils::ProfilePhase savePhase(profiler,"osm_save");
   openstudio::path outPath = openstudio::toPath(outputPathString);
-  if(!model->save(outPath,true))
+  if(!view.save(outPath))
   {
     std::cout << "Failed to write OSM file." << std::endl;
     return EXIT_FAILURE;